@@ -0,0 +1,516 @@
+#ifndef KDTREE_GRAPHICS_MATH
+#define KDTREE_GRAPHICS_MATH
+
+/**
+ * @file kdtree.h
+ * @brief k-d tree over static vec3 clouds (k nearest / radius search)
+ *
+ * implicit layout: the tree is the point array itself, reordered. the
+ * node of range [b, e) is the median slot m = b + (e - b) / 2, its
+ * children are [b, m) and [m + 1, e), so there are no child pointers and
+ * a subtree is one contiguous block of memory. ranges of at most
+ * `CGM_KDTREE_LEAF` points are left unsorted and scanned linearly.
+ *
+ * every node splits on the widest axis of its range. the build partitions
+ * the upper levels in parallel node by node, then builds the remaining
+ * subtrees in parallel (jgm/job.h).
+ *
+ * queries compare squared distances only and skip a subtree when the
+ * squared distance to its splitting plane exceeds the current bound.
+ *
+ * memory is supplied by the caller (`gmKdTreeBytes`).
+ */
+
+#include "../core.h"
+#include "../ugm/ugm.h"
+#include "../vec3.h"
+#include "../jgm/job.h"
+#include <float.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef CGM_KDTREE_LEAF
+#define CGM_KDTREE_LEAF 8
+#endif
+
+#ifndef CGM_KDTREE_SPLIT_LEVELS
+#define CGM_KDTREE_SPLIT_LEVELS 6 /* levels partitioned node-parallel before subtrees go parallel */
+#endif
+
+#ifndef CGM_KDTREE_GRAIN
+#define CGM_KDTREE_GRAIN 64 /* queries per parallel chunk */
+#endif
+
+typedef struct
+{
+    uint32_t  count;
+    vec3     *points; /* points in tree order */
+    uint32_t *index;  /* original id of every slot */
+    uint8_t  *axis;   /* split axis of every node slot */
+} gmKdTree;
+
+/* -------------------------------------------------------------------------- */
+/* build                                                                       */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief bytes of memory needed for a tree of `n` points
+ */
+CGMINLINE size_t gmKdTreeBytes(size_t n)
+{
+    return n * (sizeof(vec3) + sizeof(uint32_t) + sizeof(uint8_t));
+}
+
+CGMINLINE float gmKdTreeCoord(vec3 p, int a)
+{
+    return (a == 0) ? p.x : (a == 1) ? p.y : p.z;
+}
+
+CGMINLINE void gmKdTreeSwap(gmKdTree *t, uint32_t i, uint32_t j)
+{
+    vec3 p = t->points[i];
+    uint32_t k = t->index[i];
+    t->points[i] = t->points[j];
+    t->index[i] = t->index[j];
+    t->points[j] = p;
+    t->index[j] = k;
+}
+
+/*
+ * @brief axis with the largest extent over [b, e)
+ */
+CGMINLINE int gmKdTreeWidestAxis(const gmKdTree *t, uint32_t b, uint32_t e)
+{
+    vec3 lo = t->points[b], hi = t->points[b];
+    for(uint32_t i = b + 1; i < e; i++)
+    {
+        vec3 p = t->points[i];
+        lo = gmVec3(GMMIN(lo.x, p.x), GMMIN(lo.y, p.y), GMMIN(lo.z, p.z));
+        hi = gmVec3(GMMAX(hi.x, p.x), GMMAX(hi.y, p.y), GMMAX(hi.z, p.z));
+    }
+
+    vec3 d = gmVec3sub(hi, lo);
+    return (d.x >= d.y && d.x >= d.z) ? 0 : (d.y >= d.z) ? 1 : 2;
+}
+
+/*
+ * @brief quickselect: slot `m` gets the median along `a`, smaller or equal
+ * coordinates to its left, greater or equal to its right
+ */
+CGMINLINE void gmKdTreeSelect(gmKdTree *t, uint32_t b, uint32_t e, uint32_t m, int a)
+{
+    int64_t lo = b, hi = (int64_t)e - 1;
+
+    while(hi > lo)
+    {
+        /* median of three pivot, also sentinels for the scans below */
+        uint32_t c = (uint32_t)(lo + (hi - lo) / 2);
+        if(gmKdTreeCoord(t->points[c], a) < gmKdTreeCoord(t->points[lo], a)) gmKdTreeSwap(t, c, (uint32_t)lo);
+        if(gmKdTreeCoord(t->points[hi], a) < gmKdTreeCoord(t->points[lo], a)) gmKdTreeSwap(t, (uint32_t)hi, (uint32_t)lo);
+        if(gmKdTreeCoord(t->points[hi], a) < gmKdTreeCoord(t->points[c], a)) gmKdTreeSwap(t, (uint32_t)hi, c);
+        float pv = gmKdTreeCoord(t->points[c], a);
+
+        int64_t i = lo, j = hi;
+        while(i <= j)
+        {
+            while(gmKdTreeCoord(t->points[i], a) < pv) i++;
+            while(gmKdTreeCoord(t->points[j], a) > pv) j--;
+            if(i <= j)
+            {
+                gmKdTreeSwap(t, (uint32_t)i++, (uint32_t)j--);
+            }
+        }
+
+        /* [lo, j] <= pv, (j, i) == pv, [i, hi] >= pv */
+        if((int64_t)m <= j)
+        {
+            hi = j;
+        }
+        else if((int64_t)m >= i)
+        {
+            lo = i;
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+CGMINLINE void gmKdTreeSplit(gmKdTree *t, uint32_t b, uint32_t e)
+{
+    uint32_t m = b + (e - b) / 2;
+    int a = gmKdTreeWidestAxis(t, b, e);
+    t->axis[m] = (uint8_t)a;
+    gmKdTreeSelect(t, b, e, m, a);
+}
+
+CGMINLINE void gmKdTreeBuildRange(gmKdTree *t, uint32_t b, uint32_t e)
+{
+    while(e - b > CGM_KDTREE_LEAF)
+    {
+        uint32_t m = b + (e - b) / 2;
+        gmKdTreeSplit(t, b, e);
+        gmKdTreeBuildRange(t, b, m);
+        b = m + 1;
+    }
+}
+
+/*
+ * @brief range of the `k`-th node at depth `level`, empty if the tree is
+ * not that deep on this path
+ */
+CGMINLINE int gmKdTreeNodeRange(const gmKdTree *t, int level, size_t k, uint32_t *b, uint32_t *e)
+{
+    *b = 0;
+    *e = t->count;
+    for(int l = level - 1; l >= 0; l--)
+    {
+        uint32_t m;
+        if(*e - *b <= CGM_KDTREE_LEAF)
+        {
+            return 0;
+        }
+        m = *b + (*e - *b) / 2;
+        if((k >> l) & 1)
+        {
+            *b = m + 1;
+        }
+        else
+        {
+            *e = m;
+        }
+    }
+    return *e - *b > CGM_KDTREE_LEAF;
+}
+
+typedef struct
+{
+    gmKdTree *t;
+    int level;
+} gmKdTreeBuildJob;
+
+CGMINLINE void gmKdTreeSplitTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmKdTreeBuildJob *j = (gmKdTreeBuildJob *)ctx;
+    (void)thread;
+
+    for(size_t k = b; k < e; k++)
+    {
+        uint32_t rb, re;
+        if(gmKdTreeNodeRange(j->t, j->level, k, &rb, &re))
+        {
+            gmKdTreeSplit(j->t, rb, re);
+        }
+    }
+}
+
+CGMINLINE void gmKdTreeSubtreeTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmKdTreeBuildJob *j = (gmKdTreeBuildJob *)ctx;
+    (void)thread;
+
+    for(size_t k = b; k < e; k++)
+    {
+        uint32_t rb, re;
+        if(gmKdTreeNodeRange(j->t, j->level, k, &rb, &re))
+        {
+            gmKdTreeBuildRange(j->t, rb, re);
+        }
+    }
+}
+
+/**
+ * @brief builds a tree over `n` points
+ *
+ * @param mem at least `gmKdTreeBytes(n)` bytes, 4-byte aligned
+ * @param p points (copied, may be freed afterwards)
+ */
+CGMINLINE gmKdTree gmKdTreeBuild(void *mem, const vec3 *p, size_t n)
+{
+    gmKdTree t;
+    gmKdTreeBuildJob j;
+
+    t.count = (uint32_t)n;
+    t.points = (vec3 *)mem;
+    t.index = (uint32_t *)(t.points + n);
+    t.axis = (uint8_t *)(t.index + n);
+    for(size_t i = 0; i < n; i++)
+    {
+        t.points[i] = p[i];
+        t.index[i] = (uint32_t)i;
+        t.axis[i] = 0;
+    }
+
+    j.t = &t;
+    for(j.level = 0; j.level < CGM_KDTREE_SPLIT_LEVELS; j.level++)
+    {
+        gmParallelFor((size_t)1 << j.level, 1, gmKdTreeSplitTask, &j);
+    }
+    gmParallelFor((size_t)1 << j.level, 1, gmKdTreeSubtreeTask, &j);
+
+    return t;
+}
+
+/* -------------------------------------------------------------------------- */
+/* queries                                                                     */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * k nearest so far, sorted by distance: `d2[k - 1]` is the pruning bound
+ * once `n == k`
+ */
+typedef struct
+{
+    uint32_t *id;
+    float    *d2;
+    int       k;
+    int       n;
+} gmKdTreeHeap;
+
+CGMINLINE void gmKdTreeHeapPush(gmKdTreeHeap *h, uint32_t id, float d2)
+{
+    int i;
+    if(h->n == h->k && d2 >= h->d2[h->k - 1])
+    {
+        return;
+    }
+
+    i = (h->n < h->k) ? h->n++ : h->k - 1;
+    for(; i > 0 && h->d2[i - 1] > d2; i--)
+    {
+        h->d2[i] = h->d2[i - 1];
+        h->id[i] = h->id[i - 1];
+    }
+    h->d2[i] = d2;
+    h->id[i] = id;
+}
+
+CGMINLINE float gmKdTreeHeapBound(const gmKdTreeHeap *h, float max2)
+{
+    return (h->n == h->k) ? GMMIN(h->d2[h->k - 1], max2) : max2;
+}
+
+CGMINLINE void gmKdTreeKnnRange(const gmKdTree *t, uint32_t b, uint32_t e, vec3 q, float max2, gmKdTreeHeap *h)
+{
+    while(e - b > CGM_KDTREE_LEAF)
+    {
+        uint32_t m = b + (e - b) / 2;
+        vec3 d = gmVec3sub(t->points[m], q);
+        float s = gmKdTreeCoord(q, t->axis[m]) - gmKdTreeCoord(t->points[m], t->axis[m]);
+        float d2 = gmVec3dot(d, d);
+
+        if(d2 < max2)
+        {
+            gmKdTreeHeapPush(h, t->index[m], d2);
+        }
+
+        /* near side first, far side only if the plane is within the bound */
+        if(s < 0.0f)
+        {
+            gmKdTreeKnnRange(t, b, m, q, max2, h);
+            if(s * s >= gmKdTreeHeapBound(h, max2))
+            {
+                return;
+            }
+            b = m + 1;
+        }
+        else
+        {
+            gmKdTreeKnnRange(t, m + 1, e, q, max2, h);
+            if(s * s >= gmKdTreeHeapBound(h, max2))
+            {
+                return;
+            }
+            e = m;
+        }
+    }
+
+    for(uint32_t i = b; i < e; i++)
+    {
+        vec3 d = gmVec3sub(t->points[i], q);
+        float d2 = gmVec3dot(d, d);
+        if(d2 < max2)
+        {
+            gmKdTreeHeapPush(h, t->index[i], d2);
+        }
+    }
+}
+
+/**
+ * @brief k nearest points to `q`
+ *
+ * @param k number of neighbors wanted
+ * @param id receives up to `k` point ids, nearest first
+ * @param d2 receives the squared distances (may be NULL when k <= 64)
+ * @return number of neighbors found (less than k only if the tree is smaller)
+ */
+CGMINLINE int gmKdTreeKnn(const gmKdTree *t, vec3 q, int k, uint32_t *id, float *d2)
+{
+    float buf[64];
+    gmKdTreeHeap h;
+
+    if(k <= 0)
+    {
+        return 0;
+    }
+
+    h.id = id;
+    h.d2 = d2 ? d2 : buf;
+    h.k = d2 ? k : GMMIN(k, 64);
+    h.n = 0;
+    gmKdTreeKnnRange(t, 0, t->count, q, FLT_MAX, &h);
+    return h.n;
+}
+
+/**
+ * @brief nearest point to `q`, UINT32_MAX for an empty tree
+ */
+CGMINLINE uint32_t gmKdTreeNearest(const gmKdTree *t, vec3 q, float *d2)
+{
+    uint32_t id = UINT32_MAX;
+    float dd = FLT_MAX;
+    gmKdTreeKnn(t, q, 1, &id, &dd);
+    if(d2)
+    {
+        *d2 = dd;
+    }
+    return id;
+}
+
+CGMINLINE size_t gmKdTreeRadiusRange(const gmKdTree *t, uint32_t b, uint32_t e, vec3 q, float r2,
+                                     uint32_t *out, size_t max, size_t found)
+{
+    while(e - b > CGM_KDTREE_LEAF)
+    {
+        uint32_t m = b + (e - b) / 2;
+        vec3 d = gmVec3sub(t->points[m], q);
+        float s = gmKdTreeCoord(q, t->axis[m]) - gmKdTreeCoord(t->points[m], t->axis[m]);
+
+        if(gmVec3dot(d, d) <= r2)
+        {
+            if(found < max)
+            {
+                out[found] = t->index[m];
+            }
+            found++;
+        }
+
+        if(s * s > r2)
+        {
+            /* only the side of `q` can be in range */
+            if(s < 0.0f)
+            {
+                e = m;
+            }
+            else
+            {
+                b = m + 1;
+            }
+        }
+        else
+        {
+            found = gmKdTreeRadiusRange(t, b, m, q, r2, out, max, found);
+            b = m + 1;
+        }
+    }
+
+    for(uint32_t i = b; i < e; i++)
+    {
+        vec3 d = gmVec3sub(t->points[i], q);
+        if(gmVec3dot(d, d) <= r2)
+        {
+            if(found < max)
+            {
+                out[found] = t->index[i];
+            }
+            found++;
+        }
+    }
+
+    return found;
+}
+
+/**
+ * @brief ids of all points within `r` of `q` (unordered)
+ *
+ * @param out receives up to `max` ids
+ * @return number of points in range, may be larger than `max`
+ */
+CGMINLINE size_t gmKdTreeRadius(const gmKdTree *t, vec3 q, float r, uint32_t *out, size_t max)
+{
+    return gmKdTreeRadiusRange(t, 0, t->count, q, r * r, out, max, 0);
+}
+
+/* -------------------------------------------------------------------------- */
+/* batch queries                                                               */
+/* -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    const gmKdTree *t;
+    const vec3 *q;
+    int k;
+    float r;
+    size_t max;
+    uint32_t *id;
+    float *d2;
+    uint32_t *count;
+} gmKdTreeBatchJob;
+
+CGMINLINE void gmKdTreeKnnTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmKdTreeBatchJob *j = (gmKdTreeBatchJob *)ctx;
+    (void)thread;
+
+    for(size_t i = b; i < e; i++)
+    {
+        size_t o = i * (size_t)j->k;
+        int n = gmKdTreeKnn(j->t, j->q[i], j->k, j->id + o, j->d2 ? j->d2 + o : NULL);
+        if(j->count)
+        {
+            j->count[i] = (uint32_t)n;
+        }
+    }
+}
+
+CGMINLINE void gmKdTreeRadiusTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmKdTreeBatchJob *j = (gmKdTreeBatchJob *)ctx;
+    (void)thread;
+
+    for(size_t i = b; i < e; i++)
+    {
+        size_t n = gmKdTreeRadius(j->t, j->q[i], j->r, j->id + i * j->max, j->max);
+        j->count[i] = (uint32_t)n;
+    }
+}
+
+/**
+ * @brief `gmKdTreeKnn` for `nq` query points, split across the job pool
+ *
+ * @param id `nq * k` ids, row i holds the neighbors of q[i]
+ * @param d2 `nq * k` squared distances (may be NULL)
+ * @param count neighbors found per query (may be NULL)
+ */
+CGMINLINE void gmKdTreeKnnBatch(const gmKdTree *t, const vec3 *q, size_t nq, int k,
+                                uint32_t *id, float *d2, uint32_t *count)
+{
+    gmKdTreeBatchJob j = {t, q, k, 0.0f, 0, id, d2, count};
+    gmParallelFor(nq, CGM_KDTREE_GRAIN, gmKdTreeKnnTask, &j);
+}
+
+/**
+ * @brief `gmKdTreeRadius` for `nq` query points, split across the job pool
+ *
+ * @param id `nq * max` ids, row i holds up to `max` ids in range of q[i]
+ * @param count points in range per query (may exceed `max`)
+ */
+CGMINLINE void gmKdTreeRadiusBatch(const gmKdTree *t, const vec3 *q, size_t nq, float r, size_t max,
+                                   uint32_t *id, uint32_t *count)
+{
+    gmKdTreeBatchJob j = {t, q, 0, r, max, id, NULL, count};
+    gmParallelFor(nq, CGM_KDTREE_GRAIN, gmKdTreeRadiusTask, &j);
+}
+
+#endif
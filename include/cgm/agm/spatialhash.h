@@ -0,0 +1,411 @@
+#ifndef SPATIALHASH_GRAPHICS_MATH
+#define SPATIALHASH_GRAPHICS_MATH
+
+/**
+ * @file spatialhash.h
+ * @brief uniform-grid spatial hash for broadphase / neighbor queries
+ *
+ * points are bucketed by the hash of their grid cell and counting-sorted
+ * by bucket in O(n): afterwards every bucket is one contiguous range of
+ * `index` (original point ids) and `sorted` (positions in bucket order),
+ * so a query streams through memory instead of chasing per-cell lists.
+ *
+ * different cells can share a bucket; queries check the cell of every
+ * candidate so each point is reported once.
+ *
+ * memory is supplied by the caller (`gmSpatialHashBytes`), nothing is
+ * allocated. rebuilding every frame only rewrites that block.
+ *
+ * pair queries run across cells with `gmParallelFor` (jgm/job.h).
+ */
+
+#include "../core.h"
+#include "../ugm/ugm.h"
+#include "../vec3.h"
+#include "../jgm/job.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef CGM_SPATIAL_GRAIN
+#define CGM_SPATIAL_GRAIN 4096 /* points per parallel chunk */
+#endif
+
+#ifndef CGM_SPATIAL_CHUNKS
+#define CGM_SPATIAL_CHUNKS 1024 /* max chunks of the buffered pair query */
+#endif
+
+typedef struct
+{
+    float     cell;    /* cell edge length */
+    float     inv;     /* 1 / cell */
+    uint32_t  buckets; /* power of two */
+    uint32_t  count;   /* number of points */
+    uint32_t *start;   /* buckets + 1 offsets into index / sorted */
+    uint32_t *index;   /* original point ids in bucket order */
+    uint32_t *key;     /* bucket of every original point */
+    vec3     *sorted;  /* positions in bucket order */
+} gmSpatialHash;
+
+typedef struct
+{
+    uint32_t a; /* a < b */
+    uint32_t b;
+} gmSpatialPair;
+
+/*
+ * @brief pair callback, called from worker threads
+ */
+typedef void (*gmSpatialPairFn)(void *ctx, uint32_t a, uint32_t b, int thread);
+
+/* -------------------------------------------------------------------------- */
+/* cells                                                                       */
+/* -------------------------------------------------------------------------- */
+
+CGMINLINE void gmSpatialCell(const gmSpatialHash *h, vec3 p, int32_t *c)
+{
+    c[0] = (int32_t)floorf(p.x * h->inv);
+    c[1] = (int32_t)floorf(p.y * h->inv);
+    c[2] = (int32_t)floorf(p.z * h->inv);
+}
+
+CGMINLINE uint32_t gmSpatialBucket(const gmSpatialHash *h, int32_t x, int32_t y, int32_t z)
+{
+    uint32_t k = ((uint32_t)x * 73856093u) ^ ((uint32_t)y * 19349663u) ^ ((uint32_t)z * 83492791u);
+    return k & (h->buckets - 1);
+}
+
+CGMINLINE int gmSpatialInCell(const gmSpatialHash *h, vec3 p, int32_t x, int32_t y, int32_t z)
+{
+    int32_t c[3];
+    gmSpatialCell(h, p, c);
+    return c[0] == x && c[1] == y && c[2] == z;
+}
+
+/* -------------------------------------------------------------------------- */
+/* build                                                                       */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief bytes of memory needed for `n` points and `buckets` buckets
+ */
+CGMINLINE size_t gmSpatialHashBytes(size_t n, uint32_t buckets)
+{
+    return ((size_t)buckets + 1) * sizeof(uint32_t) + n * (2 * sizeof(uint32_t) + sizeof(vec3));
+}
+
+/**
+ * @brief sets up the hash on caller memory
+ *
+ * @param mem at least `gmSpatialHashBytes(n, buckets)` bytes, 4-byte aligned
+ * @param n maximum number of points
+ * @param buckets hash table size, power of two (about n is a good start)
+ * @param cell cell edge length; pair queries need at least twice the
+ * largest radius
+ */
+CGMINLINE gmSpatialHash gmSpatialHashInit(void *mem, size_t n, uint32_t buckets, float cell)
+{
+    gmSpatialHash h;
+    h.cell = cell;
+    h.inv = 1.0f / cell;
+    h.buckets = buckets;
+    h.count = 0;
+    h.start = (uint32_t *)mem;
+    h.index = h.start + buckets + 1;
+    h.key = h.index + n;
+    h.sorted = (vec3 *)(h.key + n);
+    return h;
+}
+
+typedef struct
+{
+    gmSpatialHash *h;
+    const vec3 *p;
+} gmSpatialBuildJob;
+
+CGMINLINE void gmSpatialKeyTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmSpatialBuildJob *j = (gmSpatialBuildJob *)ctx;
+    int32_t c[3];
+    (void)thread;
+
+    for(size_t i = b; i < e; i++)
+    {
+        gmSpatialCell(j->h, j->p[i], c);
+        j->h->key[i] = gmSpatialBucket(j->h, c[0], c[1], c[2]);
+    }
+}
+
+CGMINLINE void gmSpatialGatherTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmSpatialBuildJob *j = (gmSpatialBuildJob *)ctx;
+    (void)thread;
+
+    for(size_t i = b; i < e; i++)
+    {
+        j->h->sorted[i] = j->p[j->h->index[i]];
+    }
+}
+
+/**
+ * @brief buckets `n` points (n must not exceed the size given to init)
+ *
+ * the cell keys and the final gather run in parallel, the counting sort
+ * in between is one serial O(n + buckets) pass. points keep their input
+ * order inside a bucket.
+ */
+CGMINLINE void gmSpatialHashBuild(gmSpatialHash *h, const vec3 *p, size_t n)
+{
+    gmSpatialBuildJob j = {h, p};
+    uint32_t *start = h->start;
+    uint32_t sum = 0;
+
+    h->count = (uint32_t)n;
+    gmParallelFor(n, CGM_SPATIAL_GRAIN, gmSpatialKeyTask, &j);
+
+    memset(start, 0, ((size_t)h->buckets + 1) * sizeof(uint32_t));
+    for(size_t i = 0; i < n; i++)
+    {
+        start[h->key[i]]++;
+    }
+
+    /* bucket ends, then scatter backwards so each end becomes its start */
+    for(uint32_t b = 0; b <= h->buckets; b++)
+    {
+        sum += start[b];
+        start[b] = sum;
+    }
+    for(size_t i = n; i-- > 0;)
+    {
+        h->index[--start[h->key[i]]] = (uint32_t)i;
+    }
+
+    gmParallelFor(n, CGM_SPATIAL_GRAIN, gmSpatialGatherTask, &j);
+}
+
+/* -------------------------------------------------------------------------- */
+/* queries                                                                     */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief ids of all points within `r` of `c`
+ *
+ * @param out receives up to `max` ids (bucket order)
+ * @return number of points in range, may be larger than `max`
+ */
+CGMINLINE size_t gmSpatialHashRadius(const gmSpatialHash *h, vec3 c, float r, uint32_t *out, size_t max)
+{
+    int32_t lo[3], hi[3];
+    float r2 = r * r;
+    size_t found = 0;
+
+    gmSpatialCell(h, gmVec3(c.x - r, c.y - r, c.z - r), lo);
+    gmSpatialCell(h, gmVec3(c.x + r, c.y + r, c.z + r), hi);
+
+    for(int32_t z = lo[2]; z <= hi[2]; z++)
+    {
+        for(int32_t y = lo[1]; y <= hi[1]; y++)
+        {
+            for(int32_t x = lo[0]; x <= hi[0]; x++)
+            {
+                uint32_t b = gmSpatialBucket(h, x, y, z);
+                for(uint32_t k = h->start[b]; k < h->start[b + 1]; k++)
+                {
+                    vec3 d = gmVec3sub(h->sorted[k], c);
+                    if(gmVec3dot(d, d) <= r2 && gmSpatialInCell(h, h->sorted[k], x, y, z))
+                    {
+                        if(found < max)
+                        {
+                            out[found] = h->index[k];
+                        }
+                        found++;
+                    }
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+/*
+ * @brief overlapping pairs of one point (sorted slot `k`) with its 27
+ * neighbor cells, each pair is reported from its lower id only
+ */
+CGMINLINE void gmSpatialPointPairs(const gmSpatialHash *h, uint32_t k, const float *radius, float r,
+                                   gmSpatialPairFn fn, void *ctx, int thread)
+{
+    vec3 p = h->sorted[k];
+    uint32_t a = h->index[k];
+    float ra = radius ? radius[a] : r;
+    int32_t c[3];
+
+    gmSpatialCell(h, p, c);
+    for(int32_t z = c[2] - 1; z <= c[2] + 1; z++)
+    {
+        for(int32_t y = c[1] - 1; y <= c[1] + 1; y++)
+        {
+            for(int32_t x = c[0] - 1; x <= c[0] + 1; x++)
+            {
+                uint32_t b = gmSpatialBucket(h, x, y, z);
+                for(uint32_t m = h->start[b]; m < h->start[b + 1]; m++)
+                {
+                    uint32_t o = h->index[m];
+                    float s;
+                    vec3 d;
+
+                    if(o <= a)
+                    {
+                        continue;
+                    }
+
+                    s = ra + (radius ? radius[o] : r);
+                    d = gmVec3sub(h->sorted[m], p);
+                    if(gmVec3dot(d, d) < s * s && gmSpatialInCell(h, h->sorted[m], x, y, z))
+                    {
+                        fn(ctx, a, o, thread);
+                    }
+                }
+            }
+        }
+    }
+}
+
+typedef struct
+{
+    const gmSpatialHash *h;
+    const float *radius;
+    float r;
+    gmSpatialPairFn fn;
+    void *ctx;
+} gmSpatialPairsJob;
+
+CGMINLINE void gmSpatialPairsTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmSpatialPairsJob *j = (gmSpatialPairsJob *)ctx;
+
+    for(size_t k = b; k < e; k++)
+    {
+        gmSpatialPointPairs(j->h, (uint32_t)k, j->radius, j->r, j->fn, j->ctx, thread);
+    }
+}
+
+/**
+ * @brief calls `fn` for every pair of overlapping spheres
+ *
+ * spheres a and b overlap when |p[a] - p[b]| < ra + rb. every pair is
+ * reported once, with a < b. work is split over the bucket-sorted points,
+ * so each chunk covers a run of neighboring cells; `fn` runs concurrently
+ * and gets the worker index for per-thread output.
+ *
+ * @param radius per-point radius indexed by point id, or NULL to use `r`
+ * @param r radius of every point when `radius` is NULL
+ */
+CGMINLINE void gmSpatialHashForEachPair(const gmSpatialHash *h, const float *radius, float r,
+                                        gmSpatialPairFn fn, void *ctx)
+{
+    gmSpatialPairsJob j = {h, radius, r, fn, ctx};
+    gmParallelFor(h->count, CGM_SPATIAL_GRAIN, gmSpatialPairsTask, &j);
+}
+
+typedef struct
+{
+    gmSpatialPairsJob q;
+    size_t grain;
+    size_t count[CGM_SPATIAL_CHUNKS];
+    gmSpatialPair *out;
+    size_t max;
+    size_t at;
+} gmSpatialOverlapJob;
+
+CGMINLINE void gmSpatialCountPair(void *ctx, uint32_t a, uint32_t b, int thread)
+{
+    (void)a;
+    (void)b;
+    (void)thread;
+    (*(size_t *)ctx)++;
+}
+
+typedef struct
+{
+    gmSpatialPair *out;
+    size_t max;
+    size_t at;
+} gmSpatialPairCursor;
+
+CGMINLINE void gmSpatialStorePair(void *ctx, uint32_t a, uint32_t b, int thread)
+{
+    gmSpatialPairCursor *w = (gmSpatialPairCursor *)ctx;
+    (void)thread;
+    if(w->at < w->max)
+    {
+        w->out[w->at] = (gmSpatialPair){a, b};
+    }
+    w->at++;
+}
+
+CGMINLINE void gmSpatialOverlapCountTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmSpatialOverlapJob *j = (gmSpatialOverlapJob *)ctx;
+    size_t *c = &j->count[b / j->grain];
+
+    *c = 0;
+    for(size_t k = b; k < e; k++)
+    {
+        gmSpatialPointPairs(j->q.h, (uint32_t)k, j->q.radius, j->q.r, gmSpatialCountPair, c, thread);
+    }
+}
+
+CGMINLINE void gmSpatialOverlapStoreTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmSpatialOverlapJob *j = (gmSpatialOverlapJob *)ctx;
+    gmSpatialPairCursor w = {j->out, j->max, j->count[b / j->grain]};
+
+    for(size_t k = b; k < e && w.at < w.max; k++)
+    {
+        gmSpatialPointPairs(j->q.h, (uint32_t)k, j->q.radius, j->q.r, gmSpatialStorePair, &w, thread);
+    }
+}
+
+/**
+ * @brief writes all overlapping pairs to `out`
+ *
+ * same test as `gmSpatialHashForEachPair`. pairs are counted per chunk
+ * first and then written at fixed offsets, so the output order is the
+ * same for any thread count.
+ *
+ * @param out receives up to `max` pairs
+ * @return total number of overlapping pairs, may be larger than `max`
+ */
+CGMINLINE size_t gmSpatialHashOverlaps(const gmSpatialHash *h, const float *radius, float r,
+                                       gmSpatialPair *out, size_t max)
+{
+    gmSpatialOverlapJob j;
+    size_t chunks, total = 0;
+
+    j.q.h = h;
+    j.q.radius = radius;
+    j.q.r = r;
+    j.grain = GMMAX((size_t)CGM_SPATIAL_GRAIN, ((size_t)h->count + CGM_SPATIAL_CHUNKS - 1) / CGM_SPATIAL_CHUNKS);
+    j.out = out;
+    j.max = max;
+    chunks = ((size_t)h->count + j.grain - 1) / j.grain;
+
+    gmParallelFor(h->count, j.grain, gmSpatialOverlapCountTask, &j);
+    for(size_t c = 0; c < chunks; c++)
+    {
+        size_t n = j.count[c];
+        j.count[c] = total;
+        total += n;
+    }
+
+    if(max > 0)
+    {
+        gmParallelFor(h->count, j.grain, gmSpatialOverlapStoreTask, &j);
+    }
+
+    return total;
+}
+
+#endif
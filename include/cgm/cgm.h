@@ -6,7 +6,9 @@
 #include "vec2.h"
 #include "vec3.h"
 #include "vec4.h"
+#include "mat3.h"
 #include "mat4.h"
 #include "quat.h"
+#include "unit.h"
 
 #endif
\ No newline at end of file
@@ -0,0 +1,847 @@
+#ifndef C_GRAPHICS_MATH_HPP
+#define C_GRAPHICS_MATH_HPP
+
+/**
+ * @file cgm.hpp
+ * @brief C++ layer over the cgm structs (C++14)
+ *
+ * operators on vec2/vec3/vec4 build expression templates instead of
+ * temporaries: `vec3 r = a * s + b * c;` is evaluated component by
+ * component in a single pass when it is assigned, with no intermediate
+ * vec3 even at -O0/-O1.
+ *
+ * the same expressions run over SoA arrays (`cgm::soa3` etc.): leaves that
+ * are single values are broadcast, the assignment loops over the array
+ * once per component.
+ *
+ * everything that does not need libm (sqrt, floor, ...) is `constexpr`.
+ * `cgm::ct` adds constexpr replacements for the libm parts needed by the
+ * transform builders and lookup tables, so constant matrices and LUTs can
+ * be baked into .rodata at compile time.
+ *
+ * expressions store single values and scalars by copy and SoA views by
+ * pointer, so `auto e = a + b;` is safe as long as the arrays outlive it.
+ */
+
+#include "cgm.h"
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <type_traits>
+
+namespace cgm
+{
+
+/* -------------------------------------------------------------------------- */
+/* traits                                                                      */
+/* -------------------------------------------------------------------------- */
+
+namespace detail
+{
+
+template<class T> struct dim { static constexpr int value = 0; };
+template<> struct dim<vec2> { static constexpr int value = 2; };
+template<> struct dim<vec3> { static constexpr int value = 3; };
+template<> struct dim<vec4> { static constexpr int value = 4; };
+
+template<int N> struct vecof;
+template<> struct vecof<2> { using type = vec2; };
+template<> struct vecof<3> { using type = vec3; };
+template<> struct vecof<4> { using type = vec4; };
+
+constexpr float comp(const vec2 &v, int c) { return c == 0 ? v.x : v.y; }
+constexpr float comp(const vec3 &v, int c) { return c == 0 ? v.x : c == 1 ? v.y : v.z; }
+constexpr float comp(const vec4 &v, int c) { return c == 0 ? v.x : c == 1 ? v.y : c == 2 ? v.z : v.w; }
+
+constexpr void set(vec2 &v, int c, float s) { if(c == 0) v.x = s; else v.y = s; }
+constexpr void set(vec3 &v, int c, float s) { if(c == 0) v.x = s; else if(c == 1) v.y = s; else v.z = s; }
+constexpr void set(vec4 &v, int c, float s) { if(c == 0) v.x = s; else if(c == 1) v.y = s; else if(c == 2) v.z = s; else v.w = s; }
+
+constexpr int maxdim(int a, int b) { return a > b ? a : b; }
+constexpr std::size_t maxsize(std::size_t a, std::size_t b) { return a > b ? a : b; }
+
+} // namespace detail
+
+template<int N>
+using vec_t = typename detail::vecof<N>::type;
+
+/* -------------------------------------------------------------------------- */
+/* expression nodes                                                            */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief CRTP base of every expression
+ *
+ * a node provides `N` (0 for scalars), `get(c, i)` for component c of
+ * element i and `size()` (0 unless the node reads an array).
+ */
+template<class E>
+struct expr
+{
+    constexpr const E &self() const { return static_cast<const E &>(*this); }
+
+    /**
+     * @brief evaluates a single-value expression
+     */
+    template<class S = E>
+    constexpr vec_t<S::N> eval() const
+    {
+        vec_t<S::N> r{};
+        for(int c = 0; c < S::N; c++)
+        {
+            detail::set(r, c, self().get(c, 0));
+        }
+        return r;
+    }
+
+    template<class V, class S = E, class = typename std::enable_if<detail::dim<V>::value == S::N>::type>
+    constexpr operator V() const { return eval(); }
+};
+
+/**
+ * @brief single vector leaf (stored by value)
+ */
+template<class V>
+struct val : expr<val<V>>
+{
+    static constexpr int N = detail::dim<V>::value;
+    V v;
+    constexpr explicit val(const V &x) : v(x) {}
+    constexpr float get(int c, std::size_t) const { return detail::comp(v, c); }
+    constexpr std::size_t size() const { return 0; }
+};
+
+/**
+ * @brief scalar leaf, broadcast to every component
+ */
+struct scal : expr<scal>
+{
+    static constexpr int N = 0;
+    float s;
+    constexpr explicit scal(float x) : s(x) {}
+    constexpr float get(int, std::size_t) const { return s; }
+    constexpr std::size_t size() const { return 0; }
+};
+
+/**
+ * @brief SoA array view with N component streams
+ *
+ * assigning an expression writes every element; element i of the result
+ * only reads element i of its inputs, so in-place updates are fine.
+ */
+template<int N_>
+struct soa : expr<soa<N_>>
+{
+    static constexpr int N = N_;
+    float *p[N_];
+    std::size_t n;
+
+    soa(float *const (&ptr)[N_], std::size_t count) : n(count)
+    {
+        for(int c = 0; c < N_; c++)
+        {
+            p[c] = ptr[c];
+        }
+    }
+
+    constexpr float get(int c, std::size_t i) const { return p[c][i]; }
+    constexpr std::size_t size() const { return n; }
+
+    template<class E>
+    soa &operator=(const expr<E> &e)
+    {
+        const E &x = e.self();
+        for(int c = 0; c < N_; c++)
+        {
+            float *d = p[c];
+            for(std::size_t i = 0; i < n; i++)
+            {
+                d[i] = x.get(c, i);
+            }
+        }
+        return *this;
+    }
+
+    soa &operator=(const vec_t<N_> &v) { return *this = val<vec_t<N_>>(v); }
+
+    /* copies the elements, it does not rebind the view */
+    soa &operator=(const soa &o) { return *this = static_cast<const expr<soa> &>(o); }
+    soa(const soa &) = default;
+};
+
+using soa2 = soa<2>;
+using soa3 = soa<3>;
+using soa4 = soa<4>;
+
+/**
+ * @brief SoA views over separate component arrays
+ */
+inline soa2 view(float *x, float *y, std::size_t n)
+{
+    float *p[2] = {x, y};
+    return soa2(p, n);
+}
+
+inline soa3 view(float *x, float *y, float *z, std::size_t n)
+{
+    float *p[3] = {x, y, z};
+    return soa3(p, n);
+}
+
+inline soa4 view(float *x, float *y, float *z, float *w, std::size_t n)
+{
+    float *p[4] = {x, y, z, w};
+    return soa4(p, n);
+}
+
+template<class Op, class E>
+struct unary : expr<unary<Op, E>>
+{
+    static constexpr int N = E::N;
+    E e;
+    constexpr explicit unary(const E &x) : e(x) {}
+    constexpr float get(int c, std::size_t i) const { return Op::apply(e.get(c, i)); }
+    constexpr std::size_t size() const { return e.size(); }
+};
+
+template<class Op, class L, class R>
+struct binary : expr<binary<Op, L, R>>
+{
+    static constexpr int N = detail::maxdim(L::N, R::N);
+    static_assert(L::N == R::N || L::N == 0 || R::N == 0, "cgm: dimension mismatch");
+    L l;
+    R r;
+    constexpr binary(const L &a, const R &b) : l(a), r(b) {}
+    constexpr float get(int c, std::size_t i) const { return Op::apply(l.get(c, i), r.get(c, i)); }
+    constexpr std::size_t size() const { return detail::maxsize(l.size(), r.size()); }
+};
+
+namespace op
+{
+struct add { static constexpr float apply(float a, float b) { return a + b; } };
+struct sub { static constexpr float apply(float a, float b) { return a - b; } };
+struct mul { static constexpr float apply(float a, float b) { return a * b; } };
+struct div { static constexpr float apply(float a, float b) { return a / b; } };
+struct min { static constexpr float apply(float a, float b) { return GMMIN(a, b); } };
+struct max { static constexpr float apply(float a, float b) { return GMMAX(a, b); } };
+struct neg { static constexpr float apply(float a) { return -a; } };
+struct abs { static constexpr float apply(float a) { return a < 0.0f ? -a : a; } };
+struct floor { static float apply(float a) { return std::floor(a); } };
+struct fract { static float apply(float a) { return a - std::floor(a); } };
+struct sqrt { static float apply(float a) { return std::sqrt(a); } };
+} // namespace op
+
+/* -------------------------------------------------------------------------- */
+/* operand lifting                                                             */
+/* -------------------------------------------------------------------------- */
+
+namespace detail
+{
+
+template<class T, class = void>
+struct lift { static constexpr bool ok = false; };
+
+template<class T>
+struct lift<T, typename std::enable_if<dim<T>::value != 0>::type>
+{
+    static constexpr bool ok = true;
+    static constexpr bool node = true;
+    using type = val<T>;
+    static constexpr type get(const T &v) { return type(v); }
+};
+
+template<class T>
+struct lift<T, typename std::enable_if<std::is_arithmetic<T>::value>::type>
+{
+    static constexpr bool ok = true;
+    static constexpr bool node = false;
+    using type = scal;
+    static constexpr type get(T v) { return type(static_cast<float>(v)); }
+};
+
+template<class T>
+struct lift<T, typename std::enable_if<std::is_base_of<expr<T>, T>::value>::type>
+{
+    static constexpr bool ok = true;
+    static constexpr bool node = true;
+    using type = T;
+    static constexpr const T &get(const T &v) { return v; }
+};
+
+template<class T> using bare = typename std::decay<T>::type;
+
+/* at least one side must be a vector / expression, both must be operands */
+template<class A, class B>
+using enable2 = typename std::enable_if<
+    lift<bare<A>>::ok && lift<bare<B>>::ok && (lift<bare<A>>::node || lift<bare<B>>::node)>::type;
+
+template<class A>
+using enable1 = typename std::enable_if<lift<bare<A>>::ok && lift<bare<A>>::node>::type;
+
+template<class Op, class A, class B>
+using bin_t = binary<Op, typename lift<bare<A>>::type, typename lift<bare<B>>::type>;
+
+template<class Op, class A>
+using un_t = unary<Op, typename lift<bare<A>>::type>;
+
+template<class Op, class A, class B>
+constexpr bin_t<Op, A, B> make(const A &a, const B &b)
+{
+    return bin_t<Op, A, B>(lift<bare<A>>::get(a), lift<bare<B>>::get(b));
+}
+
+template<class Op, class A>
+constexpr un_t<Op, A> make(const A &a)
+{
+    return un_t<Op, A>(lift<bare<A>>::get(a));
+}
+
+} // namespace detail
+
+} // namespace cgm
+
+/* -------------------------------------------------------------------------- */
+/* operators                                                                   */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * operators live in the global namespace next to the C structs, so
+ * `a + b` on two vec3 is found without `using namespace cgm`.
+ */
+
+template<class A, class B, class = cgm::detail::enable2<A, B>>
+constexpr cgm::detail::bin_t<cgm::op::add, A, B> operator+(const A &a, const B &b) { return cgm::detail::make<cgm::op::add>(a, b); }
+
+template<class A, class B, class = cgm::detail::enable2<A, B>>
+constexpr cgm::detail::bin_t<cgm::op::sub, A, B> operator-(const A &a, const B &b) { return cgm::detail::make<cgm::op::sub>(a, b); }
+
+template<class A, class B, class = cgm::detail::enable2<A, B>>
+constexpr cgm::detail::bin_t<cgm::op::mul, A, B> operator*(const A &a, const B &b) { return cgm::detail::make<cgm::op::mul>(a, b); }
+
+template<class A, class B, class = cgm::detail::enable2<A, B>>
+constexpr cgm::detail::bin_t<cgm::op::div, A, B> operator/(const A &a, const B &b) { return cgm::detail::make<cgm::op::div>(a, b); }
+
+template<class A, class = cgm::detail::enable1<A>>
+constexpr cgm::detail::un_t<cgm::op::neg, A> operator-(const A &a) { return cgm::detail::make<cgm::op::neg>(a); }
+
+/* compound assignment on the C structs */
+
+template<class V, class B, class = typename std::enable_if<(cgm::detail::dim<V>::value > 0)>::type, class = cgm::detail::enable2<V, B>>
+constexpr V &operator+=(V &a, const B &b) { return a = (a + b).eval(); }
+
+template<class V, class B, class = typename std::enable_if<(cgm::detail::dim<V>::value > 0)>::type, class = cgm::detail::enable2<V, B>>
+constexpr V &operator-=(V &a, const B &b) { return a = (a - b).eval(); }
+
+template<class V, class B, class = typename std::enable_if<(cgm::detail::dim<V>::value > 0)>::type, class = cgm::detail::enable2<V, B>>
+constexpr V &operator*=(V &a, const B &b) { return a = (a * b).eval(); }
+
+template<class V, class B, class = typename std::enable_if<(cgm::detail::dim<V>::value > 0)>::type, class = cgm::detail::enable2<V, B>>
+constexpr V &operator/=(V &a, const B &b) { return a = (a / b).eval(); }
+
+namespace cgm
+{
+
+template<class A, class B, class = detail::enable2<A, B>>
+constexpr detail::bin_t<op::min, A, B> min(const A &a, const B &b) { return detail::make<op::min>(a, b); }
+
+template<class A, class B, class = detail::enable2<A, B>>
+constexpr detail::bin_t<op::max, A, B> max(const A &a, const B &b) { return detail::make<op::max>(a, b); }
+
+template<class A, class = detail::enable1<A>>
+constexpr detail::un_t<op::abs, A> abs(const A &a) { return detail::make<op::abs>(a); }
+
+template<class A, class = detail::enable1<A>>
+detail::un_t<op::floor, A> floor(const A &a) { return detail::make<op::floor>(a); }
+
+template<class A, class = detail::enable1<A>>
+detail::un_t<op::fract, A> fract(const A &a) { return detail::make<op::fract>(a); }
+
+template<class A, class = detail::enable1<A>>
+detail::un_t<op::sqrt, A> sqrt(const A &a) { return detail::make<op::sqrt>(a); }
+
+/**
+ * @brief linear interpolation, a + (b - a) * t (t may be a scalar or vector)
+ */
+template<class A, class B, class T>
+constexpr auto mix(const A &a, const B &b, const T &t) -> decltype(a + (b - a) * t)
+{
+    return a + (b - a) * t;
+}
+
+/**
+ * @brief limits a value between lo and hi
+ */
+template<class A, class L, class H>
+constexpr auto clamp(const A &v, const L &lo, const H &hi) -> decltype(min(max(v, lo), hi))
+{
+    return min(max(v, lo), hi);
+}
+
+/* -------------------------------------------------------------------------- */
+/* reductions / non element-wise (single values)                               */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief forces evaluation of a single-value expression
+ */
+template<class E>
+constexpr vec_t<E::N> eval(const expr<E> &e) { return e.eval(); }
+
+/**
+ * @brief dot product of two single-value expressions
+ */
+template<class A, class B, class = detail::enable2<A, B>>
+constexpr float dot(const A &a, const B &b)
+{
+    using E = detail::bin_t<op::mul, A, B>;
+    E e = detail::make<op::mul>(a, b);
+    float s = 0.0f;
+    for(int c = 0; c < E::N; c++)
+    {
+        s += e.get(c, 0);
+    }
+    return s;
+}
+
+template<class A, class = detail::enable1<A>>
+float length(const A &a) { return std::sqrt(dot(a, a)); }
+
+/**
+ * @brief normalized vector, zero vector if the length is 0
+ */
+template<class A, class = detail::enable1<A>>
+vec_t<detail::lift<detail::bare<A>>::type::N> normalize(const A &a)
+{
+    float l = length(a);
+    return (l == 0.0f ? a * 0.0f : a * (1.0f / l)).eval();
+}
+
+/**
+ * @brief cross product
+ */
+constexpr vec3 cross(const vec3 &a, const vec3 &b)
+{
+    return vec3{a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+template<class A, class B, class = detail::enable2<A, B>>
+constexpr vec3 cross(const A &a, const B &b)
+{
+    return cross(vec3(eval(detail::lift<detail::bare<A>>::get(a))), vec3(eval(detail::lift<detail::bare<B>>::get(b))));
+}
+
+/* -------------------------------------------------------------------------- */
+/* unit vectors                                                                */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * the unitvec overloads skip normalization, the plain vector overloads
+ * always normalize (whatever `CGM_ASSUME_NORMALIZED` says).
+ */
+
+inline unitvec2 unit(const vec2 &v) { return gmUnitVec2(v); }
+inline unitvec3 unit(const vec3 &v) { return gmUnitVec3(v); }
+
+inline vec2 reflect(const vec2 &v, const unitvec2 &n) { return gmVec2reflectUnit(v, n); }
+inline vec3 reflect(const vec3 &v, const unitvec3 &n) { return gmVec3reflectUnit(v, n); }
+inline vec2 reflect(const vec2 &v, const vec2 &n) { return gmVec2reflectUnit(v, gmUnitVec2(n)); }
+inline vec3 reflect(const vec3 &v, const vec3 &n) { return gmVec3reflectUnit(v, gmUnitVec3(n)); }
+
+inline vec2 refract(const vec2 &v, const unitvec2 &n, float e) { return gmVec2refractUnit(v, n, e); }
+inline vec3 refract(const vec3 &v, const unitvec3 &n, float e) { return gmVec3refractUnit(v, n, e); }
+inline vec2 refract(const vec2 &v, const vec2 &n, float e) { return gmVec2refractUnit(v, gmUnitVec2(n), e); }
+inline vec3 refract(const vec3 &v, const vec3 &n, float e) { return gmVec3refractUnit(v, gmUnitVec3(n), e); }
+
+inline quat angleAxis(const unitvec3 &axis, float a) { return gmQuatAngleUnit(axis, a); }
+inline quat angleAxis(const vec3 &axis, float a) { return gmQuatAngleUnit(gmUnitVec3(axis), a); }
+
+} // namespace cgm
+
+/* -------------------------------------------------------------------------- */
+/* mat4 / quat                                                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief mat4 * mat4 (same as gmMat4mul)
+ */
+constexpr mat4 operator*(const mat4 &m0, const mat4 &m1)
+{
+    mat4 m{};
+    for(int c0 = 0; c0 < 4; c0++)
+    {
+        for(int r0 = 0; r0 < 4; r0++)
+        {
+            m.m[c0 * 4 + r0] =
+                m0.m[0 * 4 + r0] * m1.m[c0 * 4 + 0] +
+                m0.m[1 * 4 + r0] * m1.m[c0 * 4 + 1] +
+                m0.m[2 * 4 + r0] * m1.m[c0 * 4 + 2] +
+                m0.m[3 * 4 + r0] * m1.m[c0 * 4 + 3];
+        }
+    }
+    return m;
+}
+
+/**
+ * @brief mat4 * vec4 (same as gmMat4mulVec4)
+ */
+constexpr vec4 operator*(const mat4 &m, const vec4 &v)
+{
+    return vec4{
+        m.m[0] * v.x + m.m[4] * v.y + m.m[8]  * v.z + m.m[12] * v.w,
+        m.m[1] * v.x + m.m[5] * v.y + m.m[9]  * v.z + m.m[13] * v.w,
+        m.m[2] * v.x + m.m[6] * v.y + m.m[10] * v.z + m.m[14] * v.w,
+        m.m[3] * v.x + m.m[7] * v.y + m.m[11] * v.z + m.m[15] * v.w
+    };
+}
+
+/**
+ * @brief mat3 * mat3 (same as gmMat3mul)
+ */
+constexpr mat3 operator*(const mat3 &m0, const mat3 &m1)
+{
+    mat3 m{};
+    for(int c0 = 0; c0 < 3; c0++)
+    {
+        for(int r0 = 0; r0 < 3; r0++)
+        {
+            m.m[c0 * 3 + r0] =
+                m0.m[0 * 3 + r0] * m1.m[c0 * 3 + 0] +
+                m0.m[1 * 3 + r0] * m1.m[c0 * 3 + 1] +
+                m0.m[2 * 3 + r0] * m1.m[c0 * 3 + 2];
+        }
+    }
+    return m;
+}
+
+/**
+ * @brief mat3 * vec3 (same as gmMat3mulVec3)
+ */
+constexpr vec3 operator*(const mat3 &m, const vec3 &v)
+{
+    return vec3{
+        m.m[0] * v.x + m.m[3] * v.y + m.m[6] * v.z,
+        m.m[1] * v.x + m.m[4] * v.y + m.m[7] * v.z,
+        m.m[2] * v.x + m.m[5] * v.y + m.m[8] * v.z
+    };
+}
+
+/**
+ * @brief quaternion product (same as gmQuatmul)
+ */
+constexpr quat operator*(const quat &q0, const quat &q1)
+{
+    return quat{
+        q0.w * q1.x + q0.x * q1.w + q0.y * q1.z - q0.z * q1.y,
+        q0.w * q1.y - q0.x * q1.z + q0.y * q1.w + q0.z * q1.x,
+        q0.w * q1.z + q0.x * q1.y - q0.y * q1.x + q0.z * q1.w,
+        q0.w * q1.w - q0.x * q1.x - q0.y * q1.y - q0.z * q1.z
+    };
+}
+
+/* -------------------------------------------------------------------------- */
+/* compile time                                                                */
+/* -------------------------------------------------------------------------- */
+
+namespace cgm
+{
+namespace ct
+{
+
+/*
+ * constexpr libm subset, evaluated in double and rounded once to float.
+ * results match sinf/cosf/tanf/sqrtf to within 1 ulp.
+ */
+
+constexpr double pi = 3.14159265358979323846;
+
+/**
+ * @brief reduces an angle to [-pi, pi]
+ */
+constexpr double wrap(double x)
+{
+    double k = x / (2.0 * pi);
+    long long n = static_cast<long long>(k < 0.0 ? k - 0.5 : k + 0.5);
+    return x - static_cast<double>(n) * 2.0 * pi;
+}
+
+constexpr double sind(double x)
+{
+    x = wrap(x);
+    double t = x, s = x, x2 = x * x;
+    for(int i = 1; i < 12; i++)
+    {
+        t *= -x2 / ((2 * i) * (2 * i + 1));
+        s += t;
+    }
+    return s;
+}
+
+constexpr double cosd(double x)
+{
+    x = wrap(x);
+    double t = 1.0, s = 1.0, x2 = x * x;
+    for(int i = 1; i < 12; i++)
+    {
+        t *= -x2 / ((2 * i - 1) * (2 * i));
+        s += t;
+    }
+    return s;
+}
+
+constexpr double sqrtd(double x)
+{
+    if(x <= 0.0)
+    {
+        return 0.0;
+    }
+    double r = x < 1.0 ? 1.0 : x;
+    for(int i = 0; i < 128; i++)
+    {
+        double n = 0.5 * (r + x / r);
+        if(n == r)
+        {
+            break;
+        }
+        r = n;
+    }
+    return r;
+}
+
+constexpr float sin(float x)  { return static_cast<float>(sind(x)); }
+constexpr float cos(float x)  { return static_cast<float>(cosd(x)); }
+constexpr float tan(float x)  { return static_cast<float>(sind(x) / cosd(x)); }
+constexpr float sqrt(float x) { return static_cast<float>(sqrtd(x)); }
+
+/**
+ * @brief fixed size table usable in constant expressions
+ */
+template<class T, std::size_t N>
+struct table
+{
+    T v[N];
+    constexpr const T &operator[](std::size_t i) const { return v[i]; }
+    constexpr std::size_t size() const { return N; }
+};
+
+/**
+ * @brief builds a table from a constexpr callable f(i)
+ */
+template<class T, std::size_t N, class F>
+constexpr table<T, N> generate(F f)
+{
+    table<T, N> t{};
+    for(std::size_t i = 0; i < N; i++)
+    {
+        t.v[i] = f(i);
+    }
+    return t;
+}
+
+/**
+ * @brief identity matrix (gmMat4identity)
+ */
+constexpr mat4 identity()
+{
+    return mat4{{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1}};
+}
+
+/**
+ * @brief translation matrix (gmMat4translate)
+ */
+constexpr mat4 translate(float x, float y, float z)
+{
+    mat4 m = identity();
+    m.m[12] = x;
+    m.m[13] = y;
+    m.m[14] = z;
+    return m;
+}
+
+/**
+ * @brief scaling matrix (gmMat4scale)
+ */
+constexpr mat4 scale(float x, float y, float z)
+{
+    mat4 m = identity();
+    m.m[0] = x;
+    m.m[5] = y;
+    m.m[10] = z;
+    return m;
+}
+
+/**
+ * @brief x axis rotation matrix (gmMat4Xrotate)
+ */
+constexpr mat4 rotateX(float a)
+{
+    mat4 m = identity();
+    m.m[5] =  cos(a);
+    m.m[6] = -sin(a);
+    m.m[9] =  sin(a);
+    m.m[10] = cos(a);
+    return m;
+}
+
+/**
+ * @brief y axis rotation matrix (gmMat4Yrotate)
+ */
+constexpr mat4 rotateY(float a)
+{
+    mat4 m = identity();
+    m.m[0] =  cos(a);
+    m.m[2] = -sin(a);
+    m.m[8] =  sin(a);
+    m.m[10] = cos(a);
+    return m;
+}
+
+/**
+ * @brief z axis rotation matrix (gmMat4Zrotate)
+ */
+constexpr mat4 rotateZ(float a)
+{
+    mat4 m = identity();
+    m.m[0] =  cos(a);
+    m.m[4] = -sin(a);
+    m.m[1] =  sin(a);
+    m.m[5] =  cos(a);
+    return m;
+}
+
+/**
+ * @brief perspective projection matrix (gmMat4perspective)
+ */
+constexpr mat4 perspective(float mv, float ma, float mn, float mf)
+{
+    float mt = tan(mv * 0.5f);
+    mat4 m{};
+    m.m[0] = 1.0f / (ma * mt);
+    m.m[5] = 1.0f / mt;
+    m.m[10] = -(mf + mn) / (mf - mn);
+    m.m[11] = -1.0f;
+    m.m[14] = -(2.0f * mf * mn) / (mf - mn);
+    return m;
+}
+
+constexpr vec3 normalize(vec3 v)
+{
+    float l = sqrt(dot(v, v));
+    return l == 0.0f ? vec3{0, 0, 0} : vec3{v.x / l, v.y / l, v.z / l};
+}
+
+/**
+ * @brief lookat matrix (gmMat4lookAt)
+ */
+constexpr mat4 lookAt(vec3 mey, vec3 mc, vec3 mup)
+{
+    vec3 f = normalize(vec3(mc - mey));
+    vec3 s = normalize(cross(f, mup));
+    vec3 u = cross(s, f);
+    mat4 m = identity();
+
+    m.m[0] = s.x;
+    m.m[4] = s.y;
+    m.m[8] = s.z;
+
+    m.m[1] = u.x;
+    m.m[5] = u.y;
+    m.m[9] = u.z;
+
+    m.m[2] =  -f.x;
+    m.m[6] =  -f.y;
+    m.m[10] = -f.z;
+
+    m.m[12] = -dot(s, mey);
+    m.m[13] = -dot(u, mey);
+    m.m[14] =  dot(f, mey);
+    return m;
+}
+
+/**
+ * @brief lattice hash in [0, 1], same values as `gmHash` in ngm/noise.h
+ */
+constexpr float hash(int x, int y)
+{
+    std::uint32_t h = static_cast<std::uint32_t>(x) * 374761393u + static_cast<std::uint32_t>(y) * 668265263u;
+    h = (h ^ static_cast<std::uint32_t>(static_cast<std::int32_t>(h) >> 13)) * 1274126177u;
+    return static_cast<float>(static_cast<std::int32_t>(h & 0x7fffffffu)) / 2147483647.0f;
+}
+
+/**
+ * @brief sin/cos of N angles evenly spread over [0, 2pi)
+ */
+template<std::size_t N>
+constexpr table<vec2, N> sincosTable()
+{
+    table<vec2, N> t{};
+    for(std::size_t i = 0; i < N; i++)
+    {
+        double a = 2.0 * pi * static_cast<double>(i) / static_cast<double>(N);
+        t.v[i] = vec2{static_cast<float>(cosd(a)), static_cast<float>(sind(a))};
+    }
+    return t;
+}
+
+/**
+ * @brief N rotation matrices about z, evenly spread over [0, 2pi)
+ */
+template<std::size_t N>
+constexpr table<mat4, N> rotationZTable()
+{
+    table<mat4, N> t{};
+    for(std::size_t i = 0; i < N; i++)
+    {
+        t.v[i] = rotateZ(static_cast<float>(2.0 * pi * static_cast<double>(i) / static_cast<double>(N)));
+    }
+    return t;
+}
+
+/**
+ * @brief shuffled 0..N-1 (Fisher-Yates driven by `hash`)
+ */
+template<std::size_t N>
+constexpr table<int, N> permutation(int seed)
+{
+    table<int, N> t{};
+    for(std::size_t i = 0; i < N; i++)
+    {
+        t.v[i] = static_cast<int>(i);
+    }
+    for(std::size_t i = N - 1; i > 0; i--)
+    {
+        std::size_t j = static_cast<std::size_t>(hash(static_cast<int>(i), seed) * static_cast<float>(i + 1));
+        j = j > i ? i : j;
+        int s = t.v[i];
+        t.v[i] = t.v[j];
+        t.v[j] = s;
+    }
+    return t;
+}
+
+/**
+ * @brief unit gradients of a W x H lattice, the vectors `gmGrad`
+ * (ngm/noise.h) builds with cosf/sinf for every sample
+ *
+ * entry y * W + x is (cos a, sin a) with a = hash(x, y) * 2pi.
+ * up to 128 x 128 fits the default GCC constexpr budget, larger lattices
+ * need `-fconstexpr-ops-limit`.
+ */
+template<int W, int H>
+constexpr table<vec2, W * H> gradientTable()
+{
+    table<vec2, W * H> t{};
+    for(int y = 0; y < H; y++)
+    {
+        for(int x = 0; x < W; x++)
+        {
+            double a = static_cast<double>(hash(x, y) * 6.2831853f);
+            t.v[y * W + x] = vec2{static_cast<float>(cosd(a)), static_cast<float>(sind(a))};
+        }
+    }
+    return t;
+}
+
+} // namespace ct
+} // namespace cgm
+
+#endif
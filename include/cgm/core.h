@@ -2,6 +2,18 @@
 #define CORE_H
 /* core.h */
 
+/*
+ * `CGMINLINE`: every cgm function
+ * `CGMINTRINSIC`: thin intrinsic wrappers (sgm/simd.h), never profiled
+ */
+#if defined(CGM_PROFILE)
+/* instrumented build, see pgm/profile.h */
+#define CGMINLINE static inline __attribute__((section("cgm_text")))
+#define CGMINTRINSIC static inline __attribute__((always_inline, no_instrument_function))
+#include "pgm/profile.h"
+#else
 #define CGMINLINE static inline
+#define CGMINTRINSIC static inline
+#endif
 
 #endif
\ No newline at end of file
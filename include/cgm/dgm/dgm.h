@@ -0,0 +1,183 @@
+#ifndef DOUBLE_GRAPHICS_MATH
+#define DOUBLE_GRAPHICS_MATH
+
+/**
+ * @file dgm.h
+ * @brief double precision family: dvec2, dvec3, dvec4, dmat4, dquat
+ *
+ * generated from dgm/template.h with the `D` prefix, so every float
+ * function has a double twin (gmVec3add -> gmDVec3add,
+ * gmMat4perspective -> gmDMat4perspective, gmClamp -> gmDClamp, ...).
+ *
+ * large worlds keep positions in double and narrow them to float vec3
+ * relative to the camera right before rendering, which keeps precision
+ * where it is visible.
+ */
+
+#include "template.h"
+#include "../vec3.h"
+#include "../vec4.h"
+#include "../mat4.h"
+#include "../sgm/simd.h"
+#include "../jgm/job.h"
+#include <stddef.h>
+
+CGM_TEMPLATE_SCALAR(double, D, )
+CGM_TEMPLATE_VEC2(double, D, , dvec2)
+CGM_TEMPLATE_VEC3(double, D, , dvec3)
+CGM_TEMPLATE_VEC4(double, D, , dvec4, dvec3)
+CGM_TEMPLATE_MAT4(double, D, , dmat4, dvec3, dvec4)
+CGM_TEMPLATE_QUAT(double, D, , dquat, dvec3)
+
+/**
+ * @brief widen a vec3 to dvec3
+ */
+CGMINLINE dvec3 gmDVec3fromVec3(vec3 v)
+{
+    return gmDVec3(v.x, v.y, v.z);
+}
+
+/**
+ * @brief narrow a dvec3 to vec3
+ */
+CGMINLINE vec3 gmVec3fromDVec3(dvec3 v)
+{
+    return gmVec3((float)v.x, (float)v.y, (float)v.z);
+}
+
+/**
+ * @brief narrow a dmat4 to mat4
+ */
+CGMINLINE mat4 gmMat4fromDMat4(dmat4 m)
+{
+    mat4 r;
+    for(int i = 0; i < 16; i++)
+    {
+        r.m[i] = (float)m.m[i];
+    }
+    return r;
+}
+
+/**
+ * @brief camera relative position: (float)(p - origin)
+ *
+ * the subtraction happens in double, so only the (small) result is
+ * rounded to float.
+ */
+CGMINLINE vec3 gmDVec3relative(dvec3 p, dvec3 origin)
+{
+    return gmVec3fromDVec3(gmDVec3sub(p, origin));
+}
+
+/**
+ * @brief camera relative model matrix
+ *
+ * translation is taken relative to `origin` in double before narrowing;
+ * use it with a view matrix built with the camera at the origin.
+ */
+CGMINLINE mat4 gmDMat4relative(dmat4 m, dvec3 origin)
+{
+    m.m[12] -= origin.x * m.m[15];
+    m.m[13] -= origin.y * m.m[15];
+    m.m[14] -= origin.z * m.m[15];
+    return gmMat4fromDMat4(m);
+}
+
+/**
+ * @brief camera relative positions for n points
+ *
+ * out[i] = (float)(p[i] - origin). the dvec3 array is processed as a
+ * flat stream of doubles, 4 points (12 doubles) per step, with the
+ * origin pre-rotated into the three lane patterns, so loads and stores
+ * stay contiguous.
+ *
+ * @param p double positions
+ * @param n number of points
+ * @param origin camera position
+ * @param out float positions (must not alias `p`)
+ */
+CGMINLINE void gmDVec3relativeBatch(const dvec3 *p, size_t n, dvec3 origin, vec3 *out)
+{
+    size_t i = 0;
+
+#if defined(CGM_SIMD_SSE)
+    const double *s = &p[0].x;
+    float *d = &out[0].x;
+#endif
+#if defined(CGM_SIMD_AVX2)
+    __m256d o0 = _mm256_setr_pd(origin.x, origin.y, origin.z, origin.x);
+    __m256d o1 = _mm256_setr_pd(origin.y, origin.z, origin.x, origin.y);
+    __m256d o2 = _mm256_setr_pd(origin.z, origin.x, origin.y, origin.z);
+    for(; i + 4 <= n; i += 4, s += 12, d += 12)
+    {
+        _mm_storeu_ps(d + 0, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(s + 0), o0)));
+        _mm_storeu_ps(d + 4, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(s + 4), o1)));
+        _mm_storeu_ps(d + 8, _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(s + 8), o2)));
+    }
+#elif defined(CGM_SIMD_SSE)
+    __m128d o0 = _mm_setr_pd(origin.x, origin.y);
+    __m128d o1 = _mm_setr_pd(origin.z, origin.x);
+    __m128d o2 = _mm_setr_pd(origin.y, origin.z);
+    for(; i + 4 <= n; i += 4, s += 12, d += 12)
+    {
+        __m128 a = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s + 0),  o0));
+        __m128 b = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s + 2),  o1));
+        __m128 c = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s + 4),  o2));
+        __m128 e = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s + 6),  o0));
+        __m128 f = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s + 8),  o1));
+        __m128 g = _mm_cvtpd_ps(_mm_sub_pd(_mm_loadu_pd(s + 10), o2));
+        _mm_storeu_ps(d + 0, _mm_movelh_ps(a, b));
+        _mm_storeu_ps(d + 4, _mm_movelh_ps(c, e));
+        _mm_storeu_ps(d + 8, _mm_movelh_ps(f, g));
+    }
+#endif
+
+    for(; i < n; i++)
+    {
+        out[i] = gmDVec3relative(p[i], origin);
+    }
+}
+
+/**
+ * @brief camera relative model matrices for n instances
+ *
+ * @param m double model matrices
+ * @param n number of matrices
+ * @param origin camera position
+ * @param out float model matrices
+ */
+CGMINLINE void gmDMat4relativeBatch(const dmat4 *m, size_t n, dvec3 origin, mat4 *out)
+{
+    for(size_t i = 0; i < n; i++)
+    {
+        out[i] = gmDMat4relative(m[i], origin);
+    }
+}
+
+typedef struct
+{
+    const dvec3 *p;
+    dvec3 origin;
+    vec3 *out;
+} gmDVec3relativeJob;
+
+CGMINLINE void gmDVec3relativeTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmDVec3relativeJob *j = (gmDVec3relativeJob *)ctx;
+    (void)thread;
+    gmDVec3relativeBatch(j->p + b, e - b, j->origin, j->out + b);
+}
+
+/**
+ * @brief `gmDVec3relativeBatch` split across the job pool
+ *
+ * chunks are multiples of the 4-point SIMD block so only the last one
+ * takes the scalar tail.
+ */
+CGMINLINE void gmDVec3relativeBatchParallel(const dvec3 *p, size_t n, dvec3 origin, vec3 *out)
+{
+    gmDVec3relativeJob j = {p, origin, out};
+    gmParallelFor(n, 4096, gmDVec3relativeTask, &j);
+}
+
+#endif
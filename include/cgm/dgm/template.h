@@ -0,0 +1,822 @@
+#ifndef TEMPLATE_GRAPHICS_MATH
+#define TEMPLATE_GRAPHICS_MATH
+
+/**
+ * @file template.h
+ * @brief macro templates that stamp out the gm* vector/matrix/quaternion
+ * API for a given scalar type.
+ *
+ * every template takes:
+ *  `T`: scalar type (e.g. double)
+ *  `P`: name prefix pasted after `gm` (e.g. D -> gmDVec3add)
+ *  `F`: libm suffix (empty for double, f for float)
+ *
+ * the generated functions follow the float API in vec2.h, vec3.h, vec4.h,
+ * mat4.h, quat.h and tgm/transform.h one to one, so a call site can switch
+ * precision by changing the prefix only.
+ */
+
+#include "../core.h"
+#include "../ugm/ugm.h"
+#include <math.h>
+
+/* -------------------------------------------------------------------------- */
+/* scalar helpers (ugm.h)                                                      */
+/* -------------------------------------------------------------------------- */
+
+#define CGM_TEMPLATE_SCALAR(T, P, F)                                            \
+CGMINLINE T gm##P##Clamp(T x, T min, T max)                                     \
+{                                                                               \
+    return GMMAX(min, GMMIN(x, max));                                           \
+}                                                                               \
+CGMINLINE T gm##P##Fract(T x)                                                   \
+{                                                                               \
+    return x - floor##F(x);                                                     \
+}                                                                               \
+CGMINLINE T gm##P##Mix(T a, T b, T t)                                           \
+{                                                                               \
+    return a + (b - a) * t;                                                     \
+}                                                                               \
+CGMINLINE T gm##P##Step(T e, T x)                                               \
+{                                                                               \
+    return (x < e) ? (T)0 : (T)1;                                               \
+}                                                                               \
+CGMINLINE T gm##P##Smooth(T t)                                                  \
+{                                                                               \
+    return t * t * ((T)3 - (T)2 * t);                                           \
+}                                                                               \
+CGMINLINE T gm##P##Smoothstep(T e0, T e1, T x)                                  \
+{                                                                               \
+    return gm##P##Smooth(gm##P##Clamp((x - e0) / (e1 - e0), (T)0, (T)1));       \
+}                                                                               \
+CGMINLINE T gm##P##Fade(T t)                                                    \
+{                                                                               \
+    return t * t * t * (t * (t * (T)6 - (T)15) + (T)10);                        \
+}
+
+/* -------------------------------------------------------------------------- */
+/* vec2 (vec2.h)                                                              */
+/* -------------------------------------------------------------------------- */
+
+#define CGM_TEMPLATE_VEC2(T, P, F, V)                                           \
+typedef struct                                                                  \
+{                                                                               \
+    T x;                                                                        \
+    T y;                                                                        \
+} V;                                                                            \
+CGMINLINE V gm##P##Vec2(T x, T y)                                               \
+{                                                                               \
+    return (V){x, y};                                                           \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2neg(V v)                                                 \
+{                                                                               \
+    return gm##P##Vec2(-v.x, -v.y);                                             \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2splat(T s)                                               \
+{                                                                               \
+    return gm##P##Vec2(s, s);                                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2add(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec2(a.x + b.x, a.y + b.y);                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2sub(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec2(a.x - b.x, a.y - b.y);                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2mul(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec2(a.x * b.x, a.y * b.y);                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2mulScale(V v, T s)                                       \
+{                                                                               \
+    return gm##P##Vec2(v.x * s, v.y * s);                                       \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2div(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec2(a.x / b.x, a.y / b.y);                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2divScale(V v, T s)                                       \
+{                                                                               \
+    return gm##P##Vec2(v.x / s, v.y / s);                                       \
+}                                                                               \
+                                                                                \
+CGMINLINE T gm##P##Vec2dot(V a, V b)                                            \
+{                                                                               \
+    return a.x * b.x + a.y * b.y;                                               \
+}                                                                               \
+                                                                                \
+CGMINLINE T gm##P##Vec2length(V v)                                              \
+{                                                                               \
+    return sqrt##F(gm##P##Vec2dot(v, v));                                       \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2normalize(V v)                                           \
+{                                                                               \
+    T l = gm##P##Vec2length(v);                                                 \
+    return (l == (T)0) ? gm##P##Vec2splat((T)0) : gm##P##Vec2divScale(v, l);    \
+}                                                                               \
+                                                                                \
+CGMINLINE T gm##P##Vec2distance(V a, V b)                                       \
+{                                                                               \
+    return gm##P##Vec2length(gm##P##Vec2sub(a, b));                             \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2reflect(V v, V n)                                        \
+{                                                                               \
+    if(!CGM_ASSUME_NORMALIZED)                                                  \
+    {                                                                           \
+        n = gm##P##Vec2normalize(n);                                            \
+    }                                                                           \
+    T d = gm##P##Vec2dot(v, n);                                                 \
+    return gm##P##Vec2sub(v, gm##P##Vec2mulScale(n, (T)2 * d));                 \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2refract(V v, V n, T e)                                   \
+{                                                                               \
+    if(!CGM_ASSUME_NORMALIZED)                                                  \
+    {                                                                           \
+        n = gm##P##Vec2normalize(n);                                            \
+    }                                                                           \
+    T d = gm##P##Vec2dot(n, v);                                                 \
+    T k = (T)1 - e * e * ((T)1 - d * d);                                        \
+    return (k < (T)0) ? gm##P##Vec2splat((T)0) :                                \
+    gm##P##Vec2sub(gm##P##Vec2mulScale(v, e), gm##P##Vec2mulScale(n, e * d + sqrt##F(k)));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2floor(V v)                                               \
+{                                                                               \
+    return gm##P##Vec2(floor##F(v.x), floor##F(v.y));                           \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2abs(V v)                                                 \
+{                                                                               \
+    return gm##P##Vec2(fabs##F(v.x), fabs##F(v.y));                             \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2ceil(V v)                                                \
+{                                                                               \
+    return gm##P##Vec2(ceil##F(v.x), ceil##F(v.y));                             \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2fract(V v)                                               \
+{                                                                               \
+    return gm##P##Vec2(gm##P##Fract(v.x), gm##P##Fract(v.y));                   \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2min(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec2(GMMIN(a.x, b.x), GMMIN(a.y, b.y));                       \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2max(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec2(GMMAX(a.x, b.x), GMMAX(a.y, b.y));                       \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2clamp(V v, V min, V max)                                 \
+{                                                                               \
+    return gm##P##Vec2(gm##P##Clamp(v.x, min.x, max.x), gm##P##Clamp(v.y, min.y, max.y));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2mix(V a, V b, T t)                                       \
+{                                                                               \
+    return gm##P##Vec2(gm##P##Mix(a.x, b.x, t), gm##P##Mix(a.y, b.y, t));       \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2step(V e, V v)                                           \
+{                                                                               \
+    return gm##P##Vec2(gm##P##Step(e.x, v.x), gm##P##Step(e.y, v.y));           \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2smoothstep(V e0, V e1, V x)                              \
+{                                                                               \
+    return gm##P##Vec2(gm##P##Smoothstep(e0.x, e1.x, x.x), gm##P##Smoothstep(e0.y, e1.y, x.y));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec2fade(V v)                                                \
+{                                                                               \
+    return gm##P##Vec2(gm##P##Fade(v.x), gm##P##Fade(v.y));                     \
+}
+
+/* -------------------------------------------------------------------------- */
+/* vec3 (vec3.h)                                                              */
+/* -------------------------------------------------------------------------- */
+
+#define CGM_TEMPLATE_VEC3(T, P, F, V)                                           \
+typedef struct                                                                  \
+{                                                                               \
+    T x;                                                                        \
+    T y;                                                                        \
+    T z;                                                                        \
+} V;                                                                            \
+CGMINLINE V gm##P##Vec3(T x, T y, T z)                                          \
+{                                                                               \
+    return (V){x, y, z};                                                        \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3neg(V v)                                                 \
+{                                                                               \
+    return gm##P##Vec3(-v.x, -v.y, -v.z);                                       \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3splat(T s)                                               \
+{                                                                               \
+    return gm##P##Vec3(s, s, s);                                                \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3add(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec3(a.x + b.x, a.y + b.y, a.z + b.z);                        \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3sub(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec3(a.x - b.x, a.y - b.y, a.z - b.z);                        \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3mul(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec3(a.x * b.x, a.y * b.y, a.z * b.z);                        \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3mulScale(V v, T s)                                       \
+{                                                                               \
+    return gm##P##Vec3(v.x * s, v.y * s, v.z * s);                              \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3div(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec3(a.x / b.x, a.y / b.y, a.z / b.z);                        \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3divScale(V v, T s)                                       \
+{                                                                               \
+    return gm##P##Vec3(v.x / s, v.y / s, v.z / s);                              \
+}                                                                               \
+                                                                                \
+CGMINLINE T gm##P##Vec3dot(V a, V b)                                            \
+{                                                                               \
+    return a.x * b.x + a.y * b.y + a.z * b.z;                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE T gm##P##Vec3length(V v)                                              \
+{                                                                               \
+    return sqrt##F(gm##P##Vec3dot(v, v));                                       \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3normalize(V v)                                           \
+{                                                                               \
+    T l = gm##P##Vec3length(v);                                                 \
+    return (l == (T)0) ? gm##P##Vec3splat((T)0) : gm##P##Vec3divScale(v, l);    \
+}                                                                               \
+                                                                                \
+CGMINLINE T gm##P##Vec3distance(V a, V b)                                       \
+{                                                                               \
+    return gm##P##Vec3length(gm##P##Vec3sub(a, b));                             \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3reflect(V v, V n)                                        \
+{                                                                               \
+    if(!CGM_ASSUME_NORMALIZED)                                                  \
+    {                                                                           \
+        n = gm##P##Vec3normalize(n);                                            \
+    }                                                                           \
+    T d = gm##P##Vec3dot(v, n);                                                 \
+    return gm##P##Vec3sub(v, gm##P##Vec3mulScale(n, (T)2 * d));                 \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3refract(V v, V n, T e)                                   \
+{                                                                               \
+    if(!CGM_ASSUME_NORMALIZED)                                                  \
+    {                                                                           \
+        n = gm##P##Vec3normalize(n);                                            \
+    }                                                                           \
+    T d = gm##P##Vec3dot(n, v);                                                 \
+    T k = (T)1 - e * e * ((T)1 - d * d);                                        \
+    return (k < (T)0) ? gm##P##Vec3splat((T)0) :                                \
+    gm##P##Vec3sub(gm##P##Vec3mulScale(v, e), gm##P##Vec3mulScale(n, e * d + sqrt##F(k)));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3cross(V a, V b)                                          \
+{                                                                               \
+    return gm##P##Vec3(                                                         \
+        a.y * b.z - a.z * b.y,                                                  \
+        a.z * b.x - a.x * b.z,                                                  \
+        a.x * b.y - a.y * b.x                                                   \
+    );                                                                          \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3floor(V v)                                               \
+{                                                                               \
+    return gm##P##Vec3(floor##F(v.x), floor##F(v.y), floor##F(v.z));            \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3abs(V v)                                                 \
+{                                                                               \
+    return gm##P##Vec3(fabs##F(v.x), fabs##F(v.y), fabs##F(v.z));               \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3ceil(V v)                                                \
+{                                                                               \
+    return gm##P##Vec3(ceil##F(v.x), ceil##F(v.y), ceil##F(v.z));               \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3fract(V v)                                               \
+{                                                                               \
+    return gm##P##Vec3(gm##P##Fract(v.x), gm##P##Fract(v.y), gm##P##Fract(v.z));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3min(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec3(GMMIN(a.x, b.x), GMMIN(a.y, b.y), GMMIN(a.z, b.z));      \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3max(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec3(GMMAX(a.x, b.x), GMMAX(a.y, b.y), GMMAX(a.z, b.z));      \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3clamp(V v, V min, V max)                                 \
+{                                                                               \
+    return gm##P##Vec3(gm##P##Clamp(v.x, min.x, max.x), gm##P##Clamp(v.y, min.y, max.y), gm##P##Clamp(v.z, min.z, max.z));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3mix(V a, V b, T t)                                       \
+{                                                                               \
+    return gm##P##Vec3(gm##P##Mix(a.x, b.x, t), gm##P##Mix(a.y, b.y, t), gm##P##Mix(a.z, b.z, t));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3step(V e, V v)                                           \
+{                                                                               \
+    return gm##P##Vec3(gm##P##Step(e.x, v.x), gm##P##Step(e.y, v.y), gm##P##Step(e.z, v.z));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec3smoothstep(V e0, V e1, V x)                              \
+{                                                                               \
+    return gm##P##Vec3(gm##P##Smoothstep(e0.x, e1.x, x.x), gm##P##Smoothstep(e0.y, e1.y, x.y), gm##P##Smoothstep(e0.z, e1.z, x.z));\
+}
+
+/* -------------------------------------------------------------------------- */
+/* vec4 (vec4.h)                                                              */
+/* -------------------------------------------------------------------------- */
+
+#define CGM_TEMPLATE_VEC4(T, P, F, V, V3)                                       \
+typedef struct                                                                  \
+{                                                                               \
+    T x;                                                                        \
+    T y;                                                                        \
+    T z;                                                                        \
+    T w;                                                                        \
+} V;                                                                            \
+CGMINLINE V gm##P##Vec4(T x, T y, T z, T w)                                     \
+{                                                                               \
+    return (V){x, y, z, w};                                                     \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4neg(V v)                                                 \
+{                                                                               \
+    return gm##P##Vec4(-v.x, -v.y, -v.z, -v.w);                                 \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4splat(T s)                                               \
+{                                                                               \
+    return gm##P##Vec4(s, s, s, s);                                             \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4add(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w);             \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4sub(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec4(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w);             \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4mul(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec4(a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w);             \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4mulScale(V v, T s)                                       \
+{                                                                               \
+    return gm##P##Vec4(v.x * s, v.y * s, v.z * s, v.w * s);                     \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4div(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec4(a.x / b.x, a.y / b.y, a.z / b.z, a.w / b.w);             \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4divScale(V v, T s)                                       \
+{                                                                               \
+    return gm##P##Vec4(v.x / s, v.y / s, v.z / s, v.w / s);                     \
+}                                                                               \
+                                                                                \
+CGMINLINE T gm##P##Vec4dot(V a, V b)                                            \
+{                                                                               \
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;                       \
+}                                                                               \
+                                                                                \
+CGMINLINE T gm##P##Vec4length(V v)                                              \
+{                                                                               \
+    return sqrt##F(gm##P##Vec4dot(v, v));                                       \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4normalize(V v)                                           \
+{                                                                               \
+    T l = gm##P##Vec4length(v);                                                 \
+    return (l == (T)0) ? gm##P##Vec4splat((T)0) : gm##P##Vec4divScale(v, l);    \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4floor(V v)                                               \
+{                                                                               \
+    return gm##P##Vec4(floor##F(v.x), floor##F(v.y), floor##F(v.z), floor##F(v.w));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4abs(V v)                                                 \
+{                                                                               \
+    return gm##P##Vec4(fabs##F(v.x), fabs##F(v.y), fabs##F(v.z), fabs##F(v.w)); \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4ceil(V v)                                                \
+{                                                                               \
+    return gm##P##Vec4(ceil##F(v.x), ceil##F(v.y), ceil##F(v.z), ceil##F(v.w)); \
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4fract(V v)                                               \
+{                                                                               \
+    return gm##P##Vec4(gm##P##Fract(v.x), gm##P##Fract(v.y), gm##P##Fract(v.z), gm##P##Fract(v.w));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4min(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec4(GMMIN(a.x, b.x), GMMIN(a.y, b.y), GMMIN(a.z, b.z), GMMIN(a.w, b.w));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4max(V a, V b)                                            \
+{                                                                               \
+    return gm##P##Vec4(GMMAX(a.x, b.x), GMMAX(a.y, b.y), GMMAX(a.z, b.z), GMMAX(a.w, b.w));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4clamp(V v, V min, V max)                                 \
+{                                                                               \
+    return gm##P##Vec4(gm##P##Clamp(v.x, min.x, max.x), gm##P##Clamp(v.y, min.y, max.y), gm##P##Clamp(v.z, min.z, max.z), gm##P##Clamp(v.w, min.w, max.w));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4mix(V a, V b, T t)                                       \
+{                                                                               \
+    return gm##P##Vec4(gm##P##Mix(a.x, b.x, t), gm##P##Mix(a.y, b.y, t), gm##P##Mix(a.z, b.z, t), gm##P##Mix(a.w, b.w, t));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4step(V e, V v)                                           \
+{                                                                               \
+    return gm##P##Vec4(gm##P##Step(e.x, v.x), gm##P##Step(e.y, v.y), gm##P##Step(e.z, v.z), gm##P##Step(e.w, v.w));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4smoothstep(V e0, V e1, V x)                              \
+{                                                                               \
+    return gm##P##Vec4(gm##P##Smoothstep(e0.x, e1.x, x.x), gm##P##Smoothstep(e0.y, e1.y, x.y), gm##P##Smoothstep(e0.z, e1.z, x.z), gm##P##Smoothstep(e0.w, e1.w, x.w));\
+}                                                                               \
+                                                                                \
+CGMINLINE V gm##P##Vec4from##P##Vec3(V3 v, T w)                                 \
+{                                                                               \
+    return gm##P##Vec4(v.x, v.y, v.z, w);                                       \
+}
+
+/* -------------------------------------------------------------------------- */
+/* mat4 (mat4.h, tgm/transform.h)                                             */
+/* -------------------------------------------------------------------------- */
+
+#define CGM_TEMPLATE_MAT4(T, P, F, M, V3, V4)                                   \
+typedef struct                                                                  \
+{                                                                               \
+    T m[16];                                                                    \
+} M;                                                                            \
+                                                                                \
+CGMINLINE M gm##P##Mat4identity(void)                                           \
+{                                                                               \
+    M m = (M){{0}};                                                             \
+    m.m[0]  = (T)1.0;                                                           \
+    m.m[5]  = (T)1.0;                                                           \
+    m.m[10] = (T)1.0;                                                           \
+    m.m[15] = (T)1.0;                                                           \
+    return m;                                                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE M gm##P##Mat4mul(M m0, M m1)                                          \
+{                                                                               \
+    M m = (M){{0}};                                                             \
+    for(int c0 = 0; c0 < 4; c0++)                                               \
+    {                                                                           \
+        for(int r0 = 0; r0 < 4; r0++)                                           \
+        {                                                                       \
+            m.m[c0 * 4 + r0] =                                                  \
+                m0.m[0 * 4 + r0] * m1.m[c0 * 4 + 0] +                           \
+                m0.m[1 * 4 + r0] * m1.m[c0 * 4 + 1] +                           \
+                m0.m[2 * 4 + r0] * m1.m[c0 * 4 + 2] +                           \
+                m0.m[3 * 4 + r0] * m1.m[c0 * 4 + 3];                            \
+        }                                                                       \
+    }                                                                           \
+    return m;                                                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE M gm##P##Mat4inverse(M m)                                             \
+{                                                                               \
+    M r;                                                                        \
+                                                                                \
+    T *ma = m.m;                                                                \
+    T *mo = r.m;                                                                \
+                                                                                \
+    mo[0] = ma[5] * ma[10]* ma[15] -                                            \
+            ma[5] * ma[11]* ma[14] -                                            \
+            ma[9] * ma[6] * ma[15] +                                            \
+            ma[9] * ma[7] * ma[14] +                                            \
+            ma[13]* ma[6] * ma[11] -                                            \
+            ma[13]* ma[7] * ma[10];                                             \
+                                                                                \
+    mo[4] = -ma[4] * ma[10]* ma[15] +                                           \
+             ma[4] * ma[11]* ma[14] +                                           \
+             ma[8] * ma[6] * ma[15] -                                           \
+             ma[8] * ma[7] * ma[14] -                                           \
+             ma[12]* ma[6] *ma[11]  +                                           \
+             ma[12]* ma[7] *ma[10];                                             \
+                                                                                \
+    mo[8] = ma[4] * ma[9] * ma[15] -                                            \
+            ma[4] * ma[11]* ma[13] -                                            \
+            ma[8] * ma[5] * ma[15]+                                             \
+            ma[8] * ma[7] * ma[13] +                                            \
+            ma[12]* ma[5] * ma[11] -                                            \
+            ma[12]* ma[7] * ma[9];                                              \
+                                                                                \
+    mo[12] = -ma[4] * ma[9] * ma[14] +                                          \
+              ma[4] * ma[10]* ma[13] +                                          \
+              ma[8] * ma[5] * ma[14] -                                          \
+              ma[8] * ma[6] * ma[13] -                                          \
+              ma[12]* ma[5] * ma[10] +                                          \
+              ma[12]* ma[6] * ma[9];                                            \
+                                                                                \
+    mo[1] = -ma[1] * ma[10]* ma[15] +                                           \
+             ma[1] * ma[11]* ma[14] +                                           \
+             ma[9] * ma[2] * ma[15] -                                           \
+             ma[9] * ma[3] * ma[14] -                                           \
+             ma[13]* ma[2] * ma[11] +                                           \
+             ma[13]* ma[3] * ma[10];                                            \
+                                                                                \
+    mo[5] = ma[0] * ma[10]* ma[15] -                                            \
+            ma[0] * ma[11]* ma[14] -                                            \
+            ma[8] * ma[2] * ma[15] +                                            \
+            ma[8] * ma[3] * ma[14] +                                            \
+            ma[12]* ma[2] * ma[11] -                                            \
+            ma[12]* ma[3] * ma[10];                                             \
+                                                                                \
+    mo[9] = -ma[0] * ma[9] * ma[15] +                                           \
+             ma[0] * ma[11]* ma[13] +                                           \
+             ma[8] * ma[1] * ma[15] -                                           \
+             ma[8] * ma[3] * ma[13] -                                           \
+             ma[12]* ma[1] * ma[11] +                                           \
+             ma[12]* ma[3] * ma[9];                                             \
+                                                                                \
+    mo[13] = ma[0] * ma[9] * ma[14] -                                           \
+             ma[0] * ma[10]* ma[13] -                                           \
+             ma[8] * ma[1] * ma[14] +                                           \
+             ma[8] * ma[2] * ma[13] +                                           \
+             ma[12]* ma[1] * ma[10] -                                           \
+             ma[12]* ma[2] * ma[9];                                             \
+                                                                                \
+    mo[2] =  ma[1] * ma[6] * ma[15] -                                           \
+             ma[1] * ma[7] * ma[14] -                                           \
+             ma[5] * ma[2] * ma[15] +                                           \
+             ma[5] * ma[3] * ma[14] +                                           \
+             ma[13]* ma[2] * ma[7] -                                            \
+             ma[13]* ma[3] * ma[6];                                             \
+                                                                                \
+    mo[6] = -ma[0] * ma[6] * ma[15] +                                           \
+             ma[0] * ma[7] * ma[14] +                                           \
+             ma[4] * ma[2] * ma[15] -                                           \
+             ma[4] * ma[3] * ma[14] -                                           \
+             ma[12]* ma[2] * ma[7] +                                            \
+             ma[12]* ma[3] * ma[6];                                             \
+                                                                                \
+    mo[10] = ma[0] * ma[5] * ma[15] -                                           \
+             ma[0] * ma[7] * ma[13] -                                           \
+             ma[4] * ma[1] * ma[15] +                                           \
+             ma[4] * ma[3] * ma[13] +                                           \
+             ma[12]* ma[1] * ma[7] -                                            \
+             ma[12]* ma[3] * ma[5];                                             \
+                                                                                \
+    mo[14] = -ma[0] * ma[5] * ma[14] +                                          \
+              ma[0] * ma[6] * ma[13] +                                          \
+              ma[4] * ma[1] * ma[14] -                                          \
+              ma[4] * ma[2] * ma[13] -                                          \
+              ma[12]* ma[1] * ma[6] +                                           \
+              ma[12]* ma[2] * ma[5];                                            \
+                                                                                \
+    mo[3] = -ma[1] * ma[6] * ma[11] +                                           \
+             ma[1] * ma[7] * ma[10] +                                           \
+             ma[5] * ma[2] * ma[11] -                                           \
+             ma[5] * ma[3] * ma[10] -                                           \
+             ma[9] * ma[2] * ma[7] +                                            \
+             ma[9] * ma[3] * ma[6];                                             \
+                                                                                \
+    mo[7] = ma[0] * ma[6] * ma[11] -                                            \
+            ma[0] * ma[7] * ma[10] -                                            \
+            ma[4] * ma[2] * ma[11] +                                            \
+            ma[4] * ma[3] * ma[10] +                                            \
+            ma[8] * ma[2] * ma[7] -                                             \
+            ma[8] * ma[3] * ma[6];                                              \
+                                                                                \
+    mo[11] = -ma[0] * ma[5] * ma[11] +                                          \
+              ma[0] * ma[7] * ma[9] +                                           \
+              ma[4] * ma[1] * ma[11] -                                          \
+              ma[4] * ma[3] * ma[9] -                                           \
+              ma[8] * ma[1] * ma[7] +                                           \
+              ma[8] * ma[3] * ma[5];                                            \
+                                                                                \
+    mo[15] = ma[0] * ma[5] * ma[10] -                                           \
+             ma[0] * ma[6] * ma[9] -                                            \
+             ma[4] * ma[1] * ma[10] +                                           \
+             ma[4] * ma[2] * ma[9] +                                            \
+             ma[8] * ma[1] * ma[6] -                                            \
+             ma[8] * ma[2] * ma[5];                                             \
+                                                                                \
+    T dt = ma[0] * mo[0] + ma[1] * mo[4] + ma[2] * mo[8] + ma[3] * mo[12];      \
+                                                                                \
+    T Inverse = (T)1.0 / dt;                                                    \
+                                                                                \
+    for(int i = 0; i < 16; i++)                                                 \
+    {                                                                           \
+        mo[i] *= Inverse;                                                       \
+    }                                                                           \
+                                                                                \
+    return r;                                                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE V4 gm##P##Mat4mulVec4(M m, V4 v)                                      \
+{                                                                               \
+    V4 r;                                                                       \
+    r.x = m.m[0]  * v.x + m.m[4]  * v.y + m.m[8]  * v.z + m.m[12] * v.w;        \
+    r.y = m.m[1]  * v.x + m.m[5]  * v.y + m.m[9]  * v.z + m.m[13] * v.w;        \
+    r.z = m.m[2]  * v.x + m.m[6]  * v.y + m.m[10] * v.z + m.m[14] * v.w;        \
+    r.w = m.m[3]  * v.x + m.m[7]  * v.y + m.m[11] * v.z + m.m[15] * v.w;        \
+    return r;                                                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE M gm##P##Mat4translate(T x, T y, T z)                                 \
+{                                                                               \
+    M m = gm##P##Mat4identity();                                                \
+    m.m[12] = x;                                                                \
+    m.m[13] = y;                                                                \
+    m.m[14] = z;                                                                \
+    return m;                                                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE M gm##P##Mat4scale(T x, T y, T z)                                     \
+{                                                                               \
+    M m = gm##P##Mat4identity();                                                \
+    m.m[0] = x;                                                                 \
+    m.m[5] = y;                                                                 \
+    m.m[10] = z;                                                                \
+    return m;                                                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE M gm##P##Mat4Xrotate(T ma)                                            \
+{                                                                               \
+    M m = gm##P##Mat4identity();                                                \
+    m.m[5] =  cos##F(ma);                                                       \
+    m.m[6] = -sin##F(ma);                                                       \
+    m.m[9] =  sin##F(ma);                                                       \
+    m.m[10] = cos##F(ma);                                                       \
+    return m;                                                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE M gm##P##Mat4Yrotate(T ma)                                            \
+{                                                                               \
+    M m = gm##P##Mat4identity();                                                \
+    m.m[0] =  cos##F(ma);                                                       \
+    m.m[2] = -sin##F(ma);                                                       \
+    m.m[8] =  sin##F(ma);                                                       \
+    m.m[10] = cos##F(ma);                                                       \
+    return m;                                                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE M gm##P##Mat4Zrotate(T ma)                                            \
+{                                                                               \
+    M m = gm##P##Mat4identity();                                                \
+    m.m[0] =  cos##F(ma);                                                       \
+    m.m[4] = -sin##F(ma);                                                       \
+    m.m[1] =  sin##F(ma);                                                       \
+    m.m[5] =  cos##F(ma);                                                       \
+    return m;                                                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE M gm##P##Mat4perspective(T mv, T ma, T mn, T mf)                      \
+{                                                                               \
+    T mt = tan##F(mv * (T)0.5);                                                 \
+    M m = (M){{0}};                                                             \
+    m.m[0] = (T)1.0 / (ma * mt);                                                \
+    m.m[5] = (T)1.0 / mt;                                                       \
+    m.m[10] = -(mf + mn) / (mf -mn);                                            \
+    m.m[11] = -(T)1.0;                                                          \
+    m.m[14] = -((T)2.0 * mf * mn) / (mf - mn);                                  \
+    return m;                                                                   \
+}                                                                               \
+                                                                                \
+CGMINLINE M gm##P##Mat4lookAt(V3 mey, V3 mc, V3 mup)                            \
+{                                                                               \
+    V3 f = gm##P##Vec3normalize(gm##P##Vec3sub(mc, mey));                       \
+    V3 s = gm##P##Vec3normalize(gm##P##Vec3cross(f, mup));                      \
+    V3 u = gm##P##Vec3cross(s, f);                                              \
+    M m = gm##P##Mat4identity();                                                \
+                                                                                \
+    m.m[0] = s.x;                                                               \
+    m.m[4] = s.y;                                                               \
+    m.m[8] = s.z;                                                               \
+                                                                                \
+    m.m[1] = u.x;                                                               \
+    m.m[5] = u.y;                                                               \
+    m.m[9] = u.z;                                                               \
+                                                                                \
+    m.m[2] =  -f.x;                                                             \
+    m.m[6] =  -f.y;                                                             \
+    m.m[10] = -f.z;                                                             \
+                                                                                \
+    m.m[12] = -gm##P##Vec3dot(s, mey);                                          \
+    m.m[13] = -gm##P##Vec3dot(u, mey);                                          \
+    m.m[14] =  gm##P##Vec3dot(f, mey);                                          \
+    return m;                                                                   \
+}
+
+/* -------------------------------------------------------------------------- */
+/* quat (quat.h)                                                              */
+/* -------------------------------------------------------------------------- */
+
+#define CGM_TEMPLATE_QUAT(T, P, F, Q, V3)                                       \
+typedef struct                                                                  \
+{                                                                               \
+    T x;                                                                        \
+    T y;                                                                        \
+    T z;                                                                        \
+    T w;                                                                        \
+} Q;                                                                            \
+                                                                                \
+CGMINLINE Q gm##P##Quat(T x, T y, T z, T w)                                     \
+{                                                                               \
+    return (Q){x, y, z, w};                                                     \
+}                                                                               \
+                                                                                \
+CGMINLINE Q gm##P##Quatidentity(void)                                           \
+{                                                                               \
+    return gm##P##Quat((T)0, (T)0, (T)0, (T)1);                                 \
+}                                                                               \
+                                                                                \
+CGMINLINE T gm##P##Quatdot(Q q0, Q q1)                                          \
+{                                                                               \
+    return q0.x * q1.x +                                                        \
+        q0.y * q1.y +                                                           \
+        q0.z * q1.z +                                                           \
+        q0.w * q1.w;                                                            \
+}                                                                               \
+                                                                                \
+CGMINLINE Q gm##P##Quatneg(Q q)                                                 \
+{                                                                               \
+    return gm##P##Quat(-q.x, -q.y, -q.z, -q.w);                                 \
+}                                                                               \
+                                                                                \
+CGMINLINE Q gm##P##Quatmul(Q q0, Q q1)                                          \
+{                                                                               \
+    return gm##P##Quat(                                                         \
+        q0.w * q1.x + q0.x * q1.w + q0.y * q1.z - q0.z * q1.y,                  \
+        q0.w * q1.y - q0.x * q1.z + q0.y * q1.w + q0.z * q1.x,                  \
+        q0.w * q1.z + q0.x * q1.y - q0.y * q1.x + q0.z * q1.w,                  \
+        q0.w * q1.w - q0.x * q1.x - q0.y * q1.y - q0.z * q1.z                   \
+    );                                                                          \
+}                                                                               \
+                                                                                \
+CGMINLINE Q gm##P##QuatAngle(V3 va, T a)                                        \
+{                                                                               \
+    if(!CGM_ASSUME_NORMALIZED)                                                  \
+    {                                                                           \
+        va = gm##P##Vec3normalize(va);                                          \
+    }                                                                           \
+    T h = a * (T)0.5;                                                           \
+    T s = sin##F(h);                                                            \
+                                                                                \
+    return gm##P##Quat(                                                         \
+        va.x * s,                                                               \
+        va.y * s,                                                               \
+        va.z * s,                                                               \
+        cos##F(h)                                                               \
+    );                                                                          \
+}
+
+#endif
@@ -0,0 +1,461 @@
+#ifndef ENCODE_GRAPHICS_MATH
+#define ENCODE_GRAPHICS_MATH
+
+/**
+ * @file encode.h
+ * @brief compact encodings for unit vectors and rotations
+ *
+ *  octahedral unit vec3: 16 bit (2 x snorm8) and 32 bit (2 x snorm16)
+ *  smallest-three quat: 32 bit (2 + 3 x 10) and 48 bit (2 + 3 x 15)
+ *
+ * the batch kernels evaluate `CGM_SIMD_WIDTH` elements per step on the
+ * `sgm/simd.h` lanes and return the same values as the scalar functions.
+ */
+
+#include "../core.h"
+#include "../ugm/ugm.h"
+#include "../vec2.h"
+#include "../vec3.h"
+#include "../quat.h"
+#include "../sgm/simd.h"
+#include "../structs/stcquat48.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/* -------------------------------------------------------------------------- */
+/* octahedral                                                                  */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * @brief octahedral mapping of a unit vector to [-1, 1]^2 (lanes)
+ */
+CGMINLINE void gmOctencodeLanes(simdf x, simdf y, simdf z, simdf *px, simdf *py)
+{
+    simdf one = gmSimdsplat(1.0f);
+    simdf inv = gmSimddiv(one, gmSimdadd(gmSimdadd(gmSimdabs(x), gmSimdabs(y)), gmSimdabs(z)));
+    simdf u = gmSimdmul(x, inv);
+    simdf v = gmSimdmul(y, inv);
+
+    /* lower hemisphere folds over the diagonals */
+    simdf fu = gmSimdcopysign(gmSimdsub(one, gmSimdabs(v)), u);
+    simdf fv = gmSimdcopysign(gmSimdsub(one, gmSimdabs(u)), v);
+    simdf lo = gmSimdlt(z, gmSimdzero());
+
+    *px = gmSimdselect(lo, fu, u);
+    *py = gmSimdselect(lo, fv, v);
+}
+
+/*
+ * @brief inverse octahedral mapping, returns a unit vector (lanes)
+ */
+CGMINLINE void gmOctdecodeLanes(simdf u, simdf v, simdf *x, simdf *y, simdf *z)
+{
+    simdf nz = gmSimdsub(gmSimdsub(gmSimdsplat(1.0f), gmSimdabs(u)), gmSimdabs(v));
+    simdf t = gmSimdmax(gmSimdsub(gmSimdzero(), nz), gmSimdzero());
+    simdf nx = gmSimdsub(u, gmSimdcopysign(t, u));
+    simdf ny = gmSimdsub(v, gmSimdcopysign(t, v));
+    simdf l = gmSimdsqrt(gmSimdfma(nx, nx, gmSimdfma(ny, ny, gmSimdmul(nz, nz))));
+    simdf inv = gmSimddiv(gmSimdsplat(1.0f), l);
+
+    *x = gmSimdmul(nx, inv);
+    *y = gmSimdmul(ny, inv);
+    *z = gmSimdmul(nz, inv);
+}
+
+/*
+ * @brief snorm quantization of [-1, 1] to [-s, s] (lanes)
+ */
+CGMINLINE simdi gmSnormencodeLanes(simdf v, float s)
+{
+    simdf one = gmSimdsplat(1.0f);
+    v = gmSimdmax(gmSimdsub(gmSimdzero(), one), gmSimdmin(v, one));
+    return gmSimdiround(gmSimdmul(v, gmSimdsplat(s)));
+}
+
+CGMINLINE simdf gmSnormdecodeLanes(simdi q, float s)
+{
+    return gmSimdmax(gmSimdsplat(-1.0f), gmSimdmul(gmSimditof(q), gmSimdsplat(1.0f / s)));
+}
+
+/**
+ * @brief octahedral mapping of a unit vector to [-1, 1]^2
+ */
+CGMINLINE vec2 gmOctencode(vec3 v)
+{
+    simdf x, y;
+    float r[2][CGM_SIMD_WIDTH];
+    gmOctencodeLanes(gmSimdsplat(v.x), gmSimdsplat(v.y), gmSimdsplat(v.z), &x, &y);
+    gmSimdstore(r[0], x);
+    gmSimdstore(r[1], y);
+    return gmVec2(r[0][0], r[1][0]);
+}
+
+/**
+ * @brief inverse octahedral mapping
+ * 
+ * @return unit vector
+ */
+CGMINLINE vec3 gmOctdecode(vec2 p)
+{
+    simdf x, y, z;
+    float r[3][CGM_SIMD_WIDTH];
+    gmOctdecodeLanes(gmSimdsplat(p.x), gmSimdsplat(p.y), &x, &y, &z);
+    gmSimdstore(r[0], x);
+    gmSimdstore(r[1], y);
+    gmSimdstore(r[2], z);
+    return gmVec3(r[0][0], r[1][0], r[2][0]);
+}
+
+/*
+ * @brief encodes up to `CGM_SIMD_WIDTH` vectors into snorm pairs
+ */
+CGMINLINE void gmOctencodeBlock(const vec3 *src, size_t c, float s, int32_t *qu, int32_t *qv)
+{
+    float x[CGM_SIMD_WIDTH], y[CGM_SIMD_WIDTH], z[CGM_SIMD_WIDTH];
+    for(size_t k = 0; k < CGM_SIMD_WIDTH; k++)
+    {
+        vec3 v = (k < c) ? src[k] : CGM_VEC3_ONE;
+        x[k] = v.x;
+        y[k] = v.y;
+        z[k] = v.z;
+    }
+
+    simdf u, w;
+    gmOctencodeLanes(gmSimdload(x), gmSimdload(y), gmSimdload(z), &u, &w);
+    gmSimdistore(qu, gmSnormencodeLanes(u, s));
+    gmSimdistore(qv, gmSnormencodeLanes(w, s));
+}
+
+/*
+ * @brief decodes up to `CGM_SIMD_WIDTH` snorm pairs into unit vectors
+ */
+CGMINLINE void gmOctdecodeBlock(const int32_t *qu, const int32_t *qv, size_t c, float s, vec3 *dst)
+{
+    simdf x, y, z;
+    float r[3][CGM_SIMD_WIDTH];
+    gmOctdecodeLanes(gmSnormdecodeLanes(gmSimdiload(qu), s), gmSnormdecodeLanes(gmSimdiload(qv), s), &x, &y, &z);
+    gmSimdstore(r[0], x);
+    gmSimdstore(r[1], y);
+    gmSimdstore(r[2], z);
+
+    for(size_t k = 0; k < c; k++)
+    {
+        dst[k] = gmVec3(r[0][k], r[1][k], r[2][k]);
+    }
+}
+
+/**
+ * @brief encodes n unit vectors as 2 x snorm8 (low byte u, high byte v)
+ */
+CGMINLINE void gmOct16encodeBatch(const vec3 *src, size_t n, uint16_t *dst)
+{
+    int32_t qu[CGM_SIMD_WIDTH], qv[CGM_SIMD_WIDTH];
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t c = (n - i < CGM_SIMD_WIDTH) ? n - i : CGM_SIMD_WIDTH;
+        gmOctencodeBlock(src + i, c, 127.0f, qu, qv);
+        for(size_t k = 0; k < c; k++)
+        {
+            dst[i + k] = (uint16_t)((qu[k] & 0xff) | ((qv[k] & 0xff) << 8));
+        }
+    }
+}
+
+/**
+ * @brief decodes n 2 x snorm8 octahedral vectors
+ */
+CGMINLINE void gmOct16decodeBatch(const uint16_t *src, size_t n, vec3 *dst)
+{
+    int32_t qu[CGM_SIMD_WIDTH] = {0}, qv[CGM_SIMD_WIDTH] = {0};
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t c = (n - i < CGM_SIMD_WIDTH) ? n - i : CGM_SIMD_WIDTH;
+        for(size_t k = 0; k < c; k++)
+        {
+            qu[k] = (int8_t)(src[i + k] & 0xff);
+            qv[k] = (int8_t)(src[i + k] >> 8);
+        }
+        gmOctdecodeBlock(qu, qv, c, 127.0f, dst + i);
+    }
+}
+
+/**
+ * @brief encodes n unit vectors as 2 x snorm16 (low half u, high half v)
+ */
+CGMINLINE void gmOct32encodeBatch(const vec3 *src, size_t n, uint32_t *dst)
+{
+    int32_t qu[CGM_SIMD_WIDTH], qv[CGM_SIMD_WIDTH];
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t c = (n - i < CGM_SIMD_WIDTH) ? n - i : CGM_SIMD_WIDTH;
+        gmOctencodeBlock(src + i, c, 32767.0f, qu, qv);
+        for(size_t k = 0; k < c; k++)
+        {
+            dst[i + k] = (uint32_t)(qu[k] & 0xffff) | ((uint32_t)(qv[k] & 0xffff) << 16);
+        }
+    }
+}
+
+/**
+ * @brief decodes n 2 x snorm16 octahedral vectors
+ */
+CGMINLINE void gmOct32decodeBatch(const uint32_t *src, size_t n, vec3 *dst)
+{
+    int32_t qu[CGM_SIMD_WIDTH] = {0}, qv[CGM_SIMD_WIDTH] = {0};
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t c = (n - i < CGM_SIMD_WIDTH) ? n - i : CGM_SIMD_WIDTH;
+        for(size_t k = 0; k < c; k++)
+        {
+            qu[k] = (int16_t)(src[i + k] & 0xffff);
+            qv[k] = (int16_t)(src[i + k] >> 16);
+        }
+        gmOctdecodeBlock(qu, qv, c, 32767.0f, dst + i);
+    }
+}
+
+/**
+ * @brief unit vector -> 2 x snorm8
+ */
+CGMINLINE uint16_t gmOct16encode(vec3 v)
+{
+    uint16_t r;
+    gmOct16encodeBatch(&v, 1, &r);
+    return r;
+}
+
+/**
+ * @brief 2 x snorm8 -> unit vector
+ */
+CGMINLINE vec3 gmOct16decode(uint16_t e)
+{
+    vec3 r;
+    gmOct16decodeBatch(&e, 1, &r);
+    return r;
+}
+
+/**
+ * @brief unit vector -> 2 x snorm16
+ */
+CGMINLINE uint32_t gmOct32encode(vec3 v)
+{
+    uint32_t r;
+    gmOct32encodeBatch(&v, 1, &r);
+    return r;
+}
+
+/**
+ * @brief 2 x snorm16 -> unit vector
+ */
+CGMINLINE vec3 gmOct32decode(uint32_t e)
+{
+    vec3 r;
+    gmOct32decodeBatch(&e, 1, &r);
+    return r;
+}
+
+/* -------------------------------------------------------------------------- */
+/* smallest-three quaternion                                                   */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * the largest |component| is dropped and rebuilt from the unit length,
+ * its index is stored in 2 bits. the sign of the quaternion is flipped so
+ * the dropped component is positive (q and -q are the same rotation).
+ * the three kept components lie in [-1/sqrt(2), 1/sqrt(2)] and are
+ * quantized with an even number of steps so 0 is exact.
+ */
+
+/*
+ * @brief splits up to `CGM_SIMD_WIDTH` quaternions into index + 3 quantized
+ * components with `m` steps
+ */
+CGMINLINE void gmQuatencodeBlock(const quat *src, size_t c, float m, int32_t *idx, int32_t *qa, int32_t *qb, int32_t *qc)
+{
+    float a[CGM_SIMD_WIDTH], b[CGM_SIMD_WIDTH], d[CGM_SIMD_WIDTH];
+    for(size_t k = 0; k < CGM_SIMD_WIDTH; k++)
+    {
+        quat q = (k < c) ? src[k] : CGM_QUAT_IDENTITY;
+        float v[4] = {q.x, q.y, q.z, q.w};
+        int l = 0;
+        for(int j = 1; j < 4; j++)
+        {
+            l = (fabsf(v[j]) > fabsf(v[l])) ? j : l;
+        }
+        float s = (v[l] < 0.0f) ? -1.0f : 1.0f;
+        float o[3];
+        for(int j = 0, t = 0; j < 4; j++)
+        {
+            if(j != l)
+            {
+                o[t++] = v[j] * s;
+            }
+        }
+        idx[k] = l;
+        a[k] = o[0];
+        b[k] = o[1];
+        d[k] = o[2];
+    }
+
+    /* [-1/sqrt(2), 1/sqrt(2)] -> [0, m] */
+    simdf sc = gmSimdsplat(CGM_SQRT2 * 0.5f * m);
+    simdf of = gmSimdsplat(0.5f * m);
+    simdf lo = gmSimdzero();
+    simdf hi = gmSimdsplat(m);
+    gmSimdistore(qa, gmSimdiround(gmSimdmin(hi, gmSimdmax(lo, gmSimdfma(gmSimdload(a), sc, of)))));
+    gmSimdistore(qb, gmSimdiround(gmSimdmin(hi, gmSimdmax(lo, gmSimdfma(gmSimdload(b), sc, of)))));
+    gmSimdistore(qc, gmSimdiround(gmSimdmin(hi, gmSimdmax(lo, gmSimdfma(gmSimdload(d), sc, of)))));
+}
+
+/*
+ * @brief rebuilds up to `CGM_SIMD_WIDTH` quaternions
+ */
+CGMINLINE void gmQuatdecodeBlock(const int32_t *idx, const int32_t *qa, const int32_t *qb, const int32_t *qc,
+                                 size_t c, float m, quat *dst)
+{
+    simdf sc = gmSimdsplat(2.0f / m * CGM_INV_SQRT2);
+    simdf of = gmSimdsplat(-CGM_INV_SQRT2);
+    simdf a = gmSimdfma(gmSimditof(gmSimdiload(qa)), sc, of);
+    simdf b = gmSimdfma(gmSimditof(gmSimdiload(qb)), sc, of);
+    simdf d = gmSimdfma(gmSimditof(gmSimdiload(qc)), sc, of);
+    simdf r = gmSimdsub(gmSimdsplat(1.0f), gmSimdfma(a, a, gmSimdfma(b, b, gmSimdmul(d, d))));
+    simdf l = gmSimdsqrt(gmSimdmax(r, gmSimdzero()));
+
+    simdi i = gmSimdiload(idx);
+    simdf i0 = gmSimdasf(gmSimdieq(i, gmSimdisplat(0)));
+    simdf i1 = gmSimdasf(gmSimdieq(i, gmSimdisplat(1)));
+    simdf i2 = gmSimdasf(gmSimdieq(i, gmSimdisplat(2)));
+    simdf i3 = gmSimdasf(gmSimdieq(i, gmSimdisplat(3)));
+
+    float o[4][CGM_SIMD_WIDTH];
+    gmSimdstore(o[0], gmSimdselect(i0, l, a));
+    gmSimdstore(o[1], gmSimdselect(i0, a, gmSimdselect(i1, l, b)));
+    gmSimdstore(o[2], gmSimdselect(i3, d, gmSimdselect(i2, l, b)));
+    gmSimdstore(o[3], gmSimdselect(i3, l, d));
+
+    for(size_t k = 0; k < c; k++)
+    {
+        dst[k] = gmQuat(o[0][k], o[1][k], o[2][k], o[3][k]);
+    }
+}
+
+/**
+ * @brief encodes n unit quaternions in 32 bits (2 bit index, 3 x 10 bit)
+ */
+CGMINLINE void gmQuat32encodeBatch(const quat *src, size_t n, uint32_t *dst)
+{
+    int32_t idx[CGM_SIMD_WIDTH], qa[CGM_SIMD_WIDTH], qb[CGM_SIMD_WIDTH], qc[CGM_SIMD_WIDTH];
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t c = (n - i < CGM_SIMD_WIDTH) ? n - i : CGM_SIMD_WIDTH;
+        gmQuatencodeBlock(src + i, c, 1022.0f, idx, qa, qb, qc);
+        for(size_t k = 0; k < c; k++)
+        {
+            dst[i + k] = ((uint32_t)idx[k] << 30) | ((uint32_t)qa[k] << 20) | ((uint32_t)qb[k] << 10) | (uint32_t)qc[k];
+        }
+    }
+}
+
+/**
+ * @brief decodes n 32 bit quaternions
+ */
+CGMINLINE void gmQuat32decodeBatch(const uint32_t *src, size_t n, quat *dst)
+{
+    int32_t idx[CGM_SIMD_WIDTH] = {0}, qa[CGM_SIMD_WIDTH] = {0}, qb[CGM_SIMD_WIDTH] = {0}, qc[CGM_SIMD_WIDTH] = {0};
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t c = (n - i < CGM_SIMD_WIDTH) ? n - i : CGM_SIMD_WIDTH;
+        for(size_t k = 0; k < c; k++)
+        {
+            uint32_t u = src[i + k];
+            idx[k] = (int32_t)(u >> 30);
+            qa[k] = (int32_t)((u >> 20) & 1023u);
+            qb[k] = (int32_t)((u >> 10) & 1023u);
+            qc[k] = (int32_t)(u & 1023u);
+        }
+        gmQuatdecodeBlock(idx, qa, qb, qc, c, 1022.0f, dst + i);
+    }
+}
+
+/**
+ * @brief encodes n unit quaternions in 48 bits (2 bit index, 3 x 15 bit)
+ */
+CGMINLINE void gmQuat48encodeBatch(const quat *src, size_t n, quat48 *dst)
+{
+    int32_t idx[CGM_SIMD_WIDTH], qa[CGM_SIMD_WIDTH], qb[CGM_SIMD_WIDTH], qc[CGM_SIMD_WIDTH];
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t c = (n - i < CGM_SIMD_WIDTH) ? n - i : CGM_SIMD_WIDTH;
+        gmQuatencodeBlock(src + i, c, 32766.0f, idx, qa, qb, qc);
+        for(size_t k = 0; k < c; k++)
+        {
+            uint64_t u = ((uint64_t)idx[k] << 45) | ((uint64_t)qa[k] << 30) | ((uint64_t)qb[k] << 15) | (uint64_t)qc[k];
+            dst[i + k].v[0] = (uint16_t)u;
+            dst[i + k].v[1] = (uint16_t)(u >> 16);
+            dst[i + k].v[2] = (uint16_t)(u >> 32);
+        }
+    }
+}
+
+/**
+ * @brief decodes n 48 bit quaternions
+ */
+CGMINLINE void gmQuat48decodeBatch(const quat48 *src, size_t n, quat *dst)
+{
+    int32_t idx[CGM_SIMD_WIDTH] = {0}, qa[CGM_SIMD_WIDTH] = {0}, qb[CGM_SIMD_WIDTH] = {0}, qc[CGM_SIMD_WIDTH] = {0};
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t c = (n - i < CGM_SIMD_WIDTH) ? n - i : CGM_SIMD_WIDTH;
+        for(size_t k = 0; k < c; k++)
+        {
+            uint64_t u = (uint64_t)src[i + k].v[0] | ((uint64_t)src[i + k].v[1] << 16) | ((uint64_t)src[i + k].v[2] << 32);
+            idx[k] = (int32_t)(u >> 45);
+            qa[k] = (int32_t)((u >> 30) & 32767u);
+            qb[k] = (int32_t)((u >> 15) & 32767u);
+            qc[k] = (int32_t)(u & 32767u);
+        }
+        gmQuatdecodeBlock(idx, qa, qb, qc, c, 32766.0f, dst + i);
+    }
+}
+
+/**
+ * @brief unit quaternion -> 32 bit smallest-three
+ */
+CGMINLINE uint32_t gmQuat32encode(quat q)
+{
+    uint32_t r;
+    gmQuat32encodeBatch(&q, 1, &r);
+    return r;
+}
+
+/**
+ * @brief 32 bit smallest-three -> unit quaternion
+ */
+CGMINLINE quat gmQuat32decode(uint32_t e)
+{
+    quat r;
+    gmQuat32decodeBatch(&e, 1, &r);
+    return r;
+}
+
+/**
+ * @brief unit quaternion -> 48 bit smallest-three
+ */
+CGMINLINE quat48 gmQuat48encode(quat q)
+{
+    quat48 r;
+    gmQuat48encodeBatch(&q, 1, &r);
+    return r;
+}
+
+/**
+ * @brief 48 bit smallest-three -> unit quaternion
+ */
+CGMINLINE quat gmQuat48decode(quat48 e)
+{
+    quat r;
+    gmQuat48decodeBatch(&e, 1, &r);
+    return r;
+}
+
+#endif
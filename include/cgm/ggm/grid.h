@@ -0,0 +1,375 @@
+#ifndef GRID_GRAPHICS_MATH
+#define GRID_GRAPHICS_MATH
+
+/**
+ * @file grid.h
+ * @brief filtered sampling of 2D float grids (heightmaps, density fields)
+ *
+ * sample (x, y) of the grid sits at coordinate (x, y), so a bilinear
+ * lookup at (2.5, 3) blends samples (2, 3) and (3, 3) evenly. coordinates
+ * outside the grid are resolved per sample with clamp or wrap addressing.
+ *
+ * storage:
+ *  - `CGM_GRID_LINEAR`: row-major, `gmGridView` wraps an existing array
+ *  - `CGM_GRID_TILED`: 8x8 tiles (256 bytes) in row-major order, samples
+ *    in Morton (Z) order inside a tile. a bilinear footprint then touches
+ *    one or two cache lines instead of two rows far apart, which pays off
+ *    for random access into large grids.
+ *
+ * the batch kernels compute addresses and weights for `CGM_SIMD_WIDTH`
+ * coordinates at once; the samples themselves are fetched one by one
+ * (there is no gather in sgm/simd.h).
+ */
+
+#include "../core.h"
+#include "../ugm/ugm.h"
+#include "../vec2.h"
+#include "../sgm/simd.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CGM_GRID_LINEAR 0
+#define CGM_GRID_TILED  1
+
+#define CGM_GRID_CLAMP 0
+#define CGM_GRID_WRAP  1
+
+#define CGM_GRID_TILE 8 /* tile edge of CGM_GRID_TILED */
+
+typedef struct
+{
+    float *data;
+    int    width;
+    int    height;
+    int    layout;  /* CGM_GRID_LINEAR or CGM_GRID_TILED */
+    int    address; /* CGM_GRID_CLAMP or CGM_GRID_WRAP */
+    int    tilesX;  /* tiles per row (tiled layout) */
+} gmGrid;
+
+/**
+ * @brief bytes of storage for a grid
+ */
+CGMINLINE size_t gmGridBytes(int width, int height, int layout)
+{
+    if(layout == CGM_GRID_TILED)
+    {
+        size_t tx = (size_t)(width + CGM_GRID_TILE - 1) / CGM_GRID_TILE;
+        size_t ty = (size_t)(height + CGM_GRID_TILE - 1) / CGM_GRID_TILE;
+        return tx * ty * CGM_GRID_TILE * CGM_GRID_TILE * sizeof(float);
+    }
+    return (size_t)width * (size_t)height * sizeof(float);
+}
+
+/**
+ * @brief grid over `gmGridBytes(width, height, layout)` bytes at mem, zeroed
+ */
+CGMINLINE gmGrid gmGridInit(void *mem, int width, int height, int layout, int address)
+{
+    gmGrid g;
+    g.data = (float *)mem;
+    g.width = width;
+    g.height = height;
+    g.layout = layout;
+    g.address = address;
+    g.tilesX = (width + CGM_GRID_TILE - 1) / CGM_GRID_TILE;
+    memset(mem, 0, gmGridBytes(width, height, layout));
+    return g;
+}
+
+/**
+ * @brief linear grid over an existing row-major array (no copy)
+ */
+CGMINLINE gmGrid gmGridView(float *data, int width, int height, int address)
+{
+    gmGrid g;
+    g.data = data;
+    g.width = width;
+    g.height = height;
+    g.layout = CGM_GRID_LINEAR;
+    g.address = address;
+    g.tilesX = (width + CGM_GRID_TILE - 1) / CGM_GRID_TILE;
+    return g;
+}
+
+/* 3-bit x and y interleaved: y2 x2 y1 x1 y0 x0 */
+CGMINLINE uint32_t gmGridMorton(uint32_t x, uint32_t y)
+{
+    x = (x | (x << 2)) & 0x13u;
+    x = (x | (x << 1)) & 0x15u;
+    y = (y | (y << 2)) & 0x13u;
+    y = (y | (y << 1)) & 0x15u;
+    return x | (y << 1);
+}
+
+/**
+ * @brief storage index of sample (x, y), both inside the grid
+ */
+CGMINLINE size_t gmGridIndex(const gmGrid *g, int x, int y)
+{
+    if(g->layout == CGM_GRID_TILED)
+    {
+        size_t tile = (size_t)(y / CGM_GRID_TILE) * (size_t)g->tilesX + (size_t)(x / CGM_GRID_TILE);
+        return tile * CGM_GRID_TILE * CGM_GRID_TILE + gmGridMorton((uint32_t)x & 7u, (uint32_t)y & 7u);
+    }
+    return (size_t)y * (size_t)g->width + (size_t)x;
+}
+
+/* resolves an integer coordinate with the grid's addressing */
+CGMINLINE int gmGridAddress(int c, int size, int address)
+{
+    if(address == CGM_GRID_WRAP)
+    {
+        c %= size;
+        return (c < 0) ? c + size : c;
+    }
+    return GMMAX(0, GMMIN(c, size - 1));
+}
+
+/**
+ * @brief sample (x, y), outside coordinates clamped or wrapped
+ */
+CGMINLINE float gmGridFetch(const gmGrid *g, int x, int y)
+{
+    x = gmGridAddress(x, g->width, g->address);
+    y = gmGridAddress(y, g->height, g->address);
+    return g->data[gmGridIndex(g, x, y)];
+}
+
+/**
+ * @brief sets sample (x, y), both inside the grid
+ */
+CGMINLINE void gmGridStore(gmGrid *g, int x, int y, float v)
+{
+    g->data[gmGridIndex(g, x, y)] = v;
+}
+
+/**
+ * @brief copies a row-major width x height array into the grid
+ */
+CGMINLINE void gmGridfromArray(gmGrid *g, const float *src)
+{
+    for(int y = 0; y < g->height; y++)
+    {
+        for(int x = 0; x < g->width; x++)
+        {
+            g->data[gmGridIndex(g, x, y)] = src[(size_t)y * (size_t)g->width + (size_t)x];
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* filtering                                                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief bilinear sample at p
+ */
+CGMINLINE float gmGridSampleBilinear(const gmGrid *g, vec2 p)
+{
+    float ix = floorf(p.x), iy = floorf(p.y);
+    float fx = p.x - ix, fy = p.y - iy;
+    int x = (int)ix, y = (int)iy;
+
+    float a = gmMix(gmGridFetch(g, x, y), gmGridFetch(g, x + 1, y), fx);
+    float b = gmMix(gmGridFetch(g, x, y + 1), gmGridFetch(g, x + 1, y + 1), fx);
+    return gmMix(a, b, fy);
+}
+
+/* Catmull-Rom weights of the samples at -1, 0, 1, 2 for t in [0, 1) */
+CGMINLINE void gmGridCubicWeights(float t, float *w)
+{
+    w[0] = t * (-0.5f + t * (1.0f - 0.5f * t));
+    w[1] = 1.0f + t * t * (-2.5f + 1.5f * t);
+    w[2] = t * (0.5f + t * (2.0f - 1.5f * t));
+    w[3] = t * t * (-0.5f + 0.5f * t);
+}
+
+/**
+ * @brief bicubic (Catmull-Rom) sample at p, passes through the samples
+ */
+CGMINLINE float gmGridSampleBicubic(const gmGrid *g, vec2 p)
+{
+    float ix = floorf(p.x), iy = floorf(p.y);
+    float wx[4], wy[4];
+    int x = (int)ix, y = (int)iy;
+    float r = 0.0f;
+
+    gmGridCubicWeights(p.x - ix, wx);
+    gmGridCubicWeights(p.y - iy, wy);
+    for(int j = 0; j < 4; j++)
+    {
+        float row = 0.0f;
+        for(int i = 0; i < 4; i++)
+        {
+            row += wx[i] * gmGridFetch(g, x + i - 1, y + j - 1);
+        }
+        r += wy[j] * row;
+    }
+    return r;
+}
+
+/* -------------------------------------------------------------------------- */
+/* lanes                                                                       */
+/* -------------------------------------------------------------------------- */
+
+/* addressing of integer-valued lanes c + offset, returned as int lanes */
+CGMINLINE simdi gmGridAddressLanes(simdf c, int offset, int size, int address)
+{
+    simdf s = gmSimdsplat((float)size);
+    c = gmSimdadd(c, gmSimdsplat((float)offset));
+    if(address == CGM_GRID_WRAP)
+    {
+        c = gmSimdsub(c, gmSimdmul(s, gmSimdfloor(gmSimdmul(c, gmSimdsplat(1.0f / (float)size)))));
+        /* the reciprocal can be off by one ulp at multiples of size */
+        c = gmSimdsub(c, gmSimdand(gmSimdle(s, c), s));
+        c = gmSimdadd(c, gmSimdand(gmSimdlt(c, gmSimdzero()), s));
+    }
+    else
+    {
+        c = gmSimdmax(gmSimdzero(), gmSimdmin(c, gmSimdsub(s, gmSimdsplat(1.0f))));
+    }
+    return gmSimditrunc(c);
+}
+
+CGMINLINE simdi gmGridMortonLanes(simdi v)
+{
+    v = gmSimdiand(v, gmSimdisplat(7));
+    v = gmSimdiand(gmSimdior(v, gmSimdisll(v, 2)), gmSimdisplat(0x13));
+    return gmSimdiand(gmSimdior(v, gmSimdisll(v, 1)), gmSimdisplat(0x15));
+}
+
+/*
+ * the row part (y) and column part (x) of a storage index, so a footprint
+ * needs one add per sample: index = row(y) + col(x)
+ */
+CGMINLINE simdi gmGridRowLanes(const gmGrid *g, simdi y)
+{
+    if(g->layout == CGM_GRID_TILED)
+    {
+        simdi tile = gmSimdimul(gmSimdisrl(y, 3), gmSimdisplat(g->tilesX * CGM_GRID_TILE * CGM_GRID_TILE));
+        return gmSimdior(tile, gmSimdisll(gmGridMortonLanes(y), 1));
+    }
+    return gmSimdimul(y, gmSimdisplat(g->width));
+}
+
+CGMINLINE simdi gmGridColLanes(const gmGrid *g, simdi x)
+{
+    if(g->layout == CGM_GRID_TILED)
+    {
+        return gmSimdior(gmSimdisll(gmSimdisrl(x, 3), 6), gmGridMortonLanes(x));
+    }
+    return x;
+}
+
+CGMINLINE simdf gmGridGather(const float *data, simdi row, simdi col)
+{
+    int32_t idx[CGM_SIMD_WIDTH];
+    float v[CGM_SIMD_WIDTH];
+    gmSimdistore(idx, gmSimdiadd(row, col));
+    for(int l = 0; l < CGM_SIMD_WIDTH; l++)
+    {
+        v[l] = data[(uint32_t)idx[l]];
+    }
+    return gmSimdload(v);
+}
+
+/* -------------------------------------------------------------------------- */
+/* batch                                                                       */
+/* -------------------------------------------------------------------------- */
+
+CGMINLINE void gmGridLoadCoords(const vec2 *p, size_t k, simdf *x, simdf *y)
+{
+    float t[2][CGM_SIMD_WIDTH];
+    for(size_t l = 0; l < CGM_SIMD_WIDTH; l++)
+    {
+        t[0][l] = (l < k) ? p[l].x : 0.0f;
+        t[1][l] = (l < k) ? p[l].y : 0.0f;
+    }
+    *x = gmSimdload(t[0]);
+    *y = gmSimdload(t[1]);
+}
+
+CGMINLINE void gmGridStoreLanes(simdf v, size_t k, float *out)
+{
+    float t[CGM_SIMD_WIDTH];
+    gmSimdstore(t, v);
+    for(size_t l = 0; l < k; l++)
+    {
+        out[l] = t[l];
+    }
+}
+
+/**
+ * @brief `gmGridSampleBilinear` at n coordinates
+ */
+CGMINLINE void gmGridSampleBilinearBatch(const gmGrid *g, const vec2 *p, size_t n, float *out)
+{
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, n - i);
+        simdf px, py;
+
+        gmGridLoadCoords(p + i, k, &px, &py);
+        simdf ix = gmSimdfloor(px), iy = gmSimdfloor(py);
+        simdf fx = gmSimdsub(px, ix), fy = gmSimdsub(py, iy);
+
+        simdi c0 = gmGridColLanes(g, gmGridAddressLanes(ix, 0, g->width, g->address));
+        simdi c1 = gmGridColLanes(g, gmGridAddressLanes(ix, 1, g->width, g->address));
+        simdi r0 = gmGridRowLanes(g, gmGridAddressLanes(iy, 0, g->height, g->address));
+        simdi r1 = gmGridRowLanes(g, gmGridAddressLanes(iy, 1, g->height, g->address));
+
+        simdf s00 = gmGridGather(g->data, r0, c0), s10 = gmGridGather(g->data, r0, c1);
+        simdf s01 = gmGridGather(g->data, r1, c0), s11 = gmGridGather(g->data, r1, c1);
+        simdf a = gmSimdfma(gmSimdsub(s10, s00), fx, s00);
+        simdf b = gmSimdfma(gmSimdsub(s11, s01), fx, s01);
+        gmGridStoreLanes(gmSimdfma(gmSimdsub(b, a), fy, a), k, out + i);
+    }
+}
+
+CGMINLINE void gmGridCubicWeightLanes(simdf t, simdf *w)
+{
+    simdf h = gmSimdsplat(0.5f), t2 = gmSimdmul(t, t);
+    w[0] = gmSimdmul(t, gmSimdfma(t, gmSimdfma(gmSimdsplat(-0.5f), t, gmSimdsplat(1.0f)), gmSimdsplat(-0.5f)));
+    w[1] = gmSimdfma(t2, gmSimdfma(gmSimdsplat(1.5f), t, gmSimdsplat(-2.5f)), gmSimdsplat(1.0f));
+    w[2] = gmSimdmul(t, gmSimdfma(t, gmSimdfma(gmSimdsplat(-1.5f), t, gmSimdsplat(2.0f)), h));
+    w[3] = gmSimdmul(t2, gmSimdfma(h, t, gmSimdsplat(-0.5f)));
+}
+
+/**
+ * @brief `gmGridSampleBicubic` at n coordinates
+ */
+CGMINLINE void gmGridSampleBicubicBatch(const gmGrid *g, const vec2 *p, size_t n, float *out)
+{
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, n - i);
+        simdf px, py, wx[4], wy[4];
+        simdi col[4], row[4];
+
+        gmGridLoadCoords(p + i, k, &px, &py);
+        simdf ix = gmSimdfloor(px), iy = gmSimdfloor(py);
+        gmGridCubicWeightLanes(gmSimdsub(px, ix), wx);
+        gmGridCubicWeightLanes(gmSimdsub(py, iy), wy);
+        for(int t = 0; t < 4; t++)
+        {
+            col[t] = gmGridColLanes(g, gmGridAddressLanes(ix, t - 1, g->width, g->address));
+            row[t] = gmGridRowLanes(g, gmGridAddressLanes(iy, t - 1, g->height, g->address));
+        }
+
+        simdf r = gmSimdzero();
+        for(int j = 0; j < 4; j++)
+        {
+            simdf s = gmSimdzero();
+            for(int c = 0; c < 4; c++)
+            {
+                s = gmSimdfma(wx[c], gmGridGather(g->data, row[j], col[c]), s);
+            }
+            r = gmSimdfma(wy[j], s, r);
+        }
+        gmGridStoreLanes(r, k, out + i);
+    }
+}
+
+#endif
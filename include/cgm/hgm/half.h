@@ -0,0 +1,387 @@
+#ifndef HALF_GRAPHICS_MATH
+#define HALF_GRAPHICS_MATH
+
+/**
+ * @file half.h
+ * @brief half precision (fp16) storage for vector streams
+ *
+ * hvec2/hvec3/hvec4 are storage types only: math happens in float after
+ * widening a small block into registers / L1, never on a full float copy
+ * of the stream.
+ *
+ * conversions round to nearest even. with F16C (`-mf16c`) the bulk and
+ * scalar conversions use the hardware instructions, otherwise a
+ * branch-free integer version on the `sgm/simd.h` lanes is used. both
+ * give the same bits, NaNs included: they come out quiet, with the top
+ * payload bits kept in either direction.
+ */
+
+#include "../core.h"
+#include "../ugm/ugm.h"
+#include "../vec2.h"
+#include "../vec3.h"
+#include "../vec4.h"
+#include "../mat4.h"
+#include "../sgm/simd.h"
+#include "../jgm/job.h"
+#include "../structs/stchvec.h"
+#include <stddef.h>
+
+#if defined(__F16C__) && !defined(CGM_NO_SIMD)
+#define CGM_HALF_F16C 1
+#include <immintrin.h>
+#endif
+
+/* block size (in halves) widened at once by the mixed kernels */
+#define CGM_HALF_BLOCK 192
+
+/* -------------------------------------------------------------------------- */
+/* software conversion on simd lanes                                           */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * @brief float bits -> half bits (in the low 16 bits of each lane)
+ */
+CGMINLINE simdi gmHalfencodeLanes(simdf v)
+{
+    simdi f = gmSimdasi(v);
+    simdi sign = gmSimdiand(f, gmSimdisplat((int32_t)0x80000000));
+    f = gmSimdixor(f, sign);
+
+    /* overflow to inf; NaN is quieted and keeps the top 9 payload bits */
+    simdi big = gmSimdigt(f, gmSimdisplat(((127 + 16) << 23) - 1));
+    simdi nan = gmSimdigt(f, gmSimdisplat(255 << 23));
+    simdi payload = gmSimdior(gmSimdisplat(0x7e00), gmSimdiand(gmSimdisrl(f, 13), gmSimdisplat(0x3ff)));
+    simdi ob = gmSimdiselect(nan, payload, gmSimdisplat(0x7c00));
+
+    /* subnormal result: let the float adder do the rounding */
+    simdi sub = gmSimdigt(gmSimdisplat(113 << 23), f);
+    simdf magic = gmSimdasf(gmSimdisplat(((127 - 15) + (23 - 10) + 1) << 23));
+    simdi os = gmSimdisub(gmSimdasi(gmSimdadd(gmSimdasf(f), magic)), gmSimdasi(magic));
+
+    /* normal result: rebias and round to nearest even */
+    simdi odd = gmSimdiand(gmSimdisrl(f, 13), gmSimdisplat(1));
+    simdi on = gmSimdiadd(f, gmSimdisplat(0xfff - ((127 - 15) << 23)));
+    on = gmSimdisrl(gmSimdiadd(on, odd), 13);
+
+    simdi o = gmSimdiselect(big, ob, gmSimdiselect(sub, os, on));
+    return gmSimdior(o, gmSimdisrl(sign, 16));
+}
+
+/*
+ * @brief half bits (low 16 bits of each lane) -> float
+ */
+CGMINLINE simdf gmHalfdecodeLanes(simdi h)
+{
+    simdi o = gmSimdisll(gmSimdiand(h, gmSimdisplat(0x7fff)), 13);
+    simdi e = gmSimdiand(o, gmSimdisplat(0x7c00 << 13));
+    o = gmSimdiadd(o, gmSimdisplat((127 - 15) << 23));
+
+    /* inf / NaN: extra exponent adjust, NaN gets the quiet bit */
+    simdi inf = gmSimdieq(e, gmSimdisplat(0x7c00 << 13));
+    simdi nan = gmSimdiandnot(gmSimdieq(gmSimdiand(h, gmSimdisplat(0x3ff)), gmSimdisplat(0)), inf);
+    o = gmSimdiadd(o, gmSimdiand(inf, gmSimdisplat((128 - 16) << 23)));
+    o = gmSimdior(o, gmSimdiand(nan, gmSimdisplat(0x00400000)));
+
+    /* zero / subnormal: renormalize through the float unit */
+    simdi zero = gmSimdieq(e, gmSimdisplat(0));
+    simdf magic = gmSimdasf(gmSimdisplat(113 << 23));
+    simdi oz = gmSimdasi(gmSimdsub(gmSimdasf(gmSimdiadd(o, gmSimdisplat(1 << 23))), magic));
+    o = gmSimdiselect(zero, oz, o);
+
+    simdi sign = gmSimdisll(gmSimdiand(h, gmSimdisplat(0x8000)), 16);
+    return gmSimdasf(gmSimdior(o, sign));
+}
+
+/* -------------------------------------------------------------------------- */
+/* scalar                                                                      */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief float -> half
+ */
+CGMINLINE half gmHalffromFloat(float v)
+{
+#if defined(CGM_HALF_F16C)
+    return (half)_cvtss_sh(v, _MM_FROUND_TO_NEAREST_INT);
+#else
+    int32_t r[CGM_SIMD_WIDTH];
+    gmSimdistore(r, gmHalfencodeLanes(gmSimdsplat(v)));
+    return (half)r[0];
+#endif
+}
+
+/**
+ * @brief half -> float
+ */
+CGMINLINE float gmFloatfromHalf(half h)
+{
+#if defined(CGM_HALF_F16C)
+    return _cvtsh_ss(h);
+#else
+    float r[CGM_SIMD_WIDTH];
+    gmSimdstore(r, gmHalfdecodeLanes(gmSimdisplat(h)));
+    return r[0];
+#endif
+}
+
+CGMINLINE hvec2 gmHVec2fromVec2(vec2 v)
+{
+    return (hvec2){gmHalffromFloat(v.x), gmHalffromFloat(v.y)};
+}
+
+CGMINLINE vec2 gmVec2fromHVec2(hvec2 v)
+{
+    return gmVec2(gmFloatfromHalf(v.x), gmFloatfromHalf(v.y));
+}
+
+CGMINLINE hvec3 gmHVec3fromVec3(vec3 v)
+{
+    return (hvec3){gmHalffromFloat(v.x), gmHalffromFloat(v.y), gmHalffromFloat(v.z)};
+}
+
+CGMINLINE vec3 gmVec3fromHVec3(hvec3 v)
+{
+    return gmVec3(gmFloatfromHalf(v.x), gmFloatfromHalf(v.y), gmFloatfromHalf(v.z));
+}
+
+CGMINLINE hvec4 gmHVec4fromVec4(vec4 v)
+{
+    return (hvec4){gmHalffromFloat(v.x), gmHalffromFloat(v.y), gmHalffromFloat(v.z), gmHalffromFloat(v.w)};
+}
+
+CGMINLINE vec4 gmVec4fromHVec4(hvec4 v)
+{
+    return gmVec4(gmFloatfromHalf(v.x), gmFloatfromHalf(v.y), gmFloatfromHalf(v.z), gmFloatfromHalf(v.w));
+}
+
+/* -------------------------------------------------------------------------- */
+/* bulk                                                                        */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief converts n floats to halves
+ *
+ * works on any flat stream, e.g. `(const float *)vec3s, 3 * count`.
+ */
+CGMINLINE void gmHalfencodeBatch(const float *src, size_t n, half *dst)
+{
+    size_t i = 0;
+#if defined(CGM_HALF_F16C) && defined(__AVX__)
+    for(; i + 8 <= n; i += 8)
+    {
+        _mm_storeu_si128((__m128i *)(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+    }
+#elif defined(CGM_HALF_F16C)
+    for(; i + 4 <= n; i += 4)
+    {
+        _mm_storel_epi64((__m128i *)(dst + i), _mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+    }
+#else
+    int32_t r[CGM_SIMD_WIDTH];
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        gmSimdistore(r, gmHalfencodeLanes(gmSimdload(src + i)));
+        for(int k = 0; k < CGM_SIMD_WIDTH; k++)
+        {
+            dst[i + k] = (half)r[k];
+        }
+    }
+#endif
+    for(; i < n; i++)
+    {
+        dst[i] = gmHalffromFloat(src[i]);
+    }
+}
+
+/**
+ * @brief converts n halves to floats
+ */
+CGMINLINE void gmHalfdecodeBatch(const half *src, size_t n, float *dst)
+{
+    size_t i = 0;
+#if defined(CGM_HALF_F16C) && defined(__AVX__)
+    for(; i + 8 <= n; i += 8)
+    {
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(src + i))));
+    }
+#elif defined(CGM_HALF_F16C)
+    for(; i + 4 <= n; i += 4)
+    {
+        _mm_storeu_ps(dst + i, _mm_cvtph_ps(_mm_loadl_epi64((const __m128i *)(src + i))));
+    }
+#else
+    int32_t r[CGM_SIMD_WIDTH];
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        for(int k = 0; k < CGM_SIMD_WIDTH; k++)
+        {
+            r[k] = src[i + k];
+        }
+        gmSimdstore(dst + i, gmHalfdecodeLanes(gmSimdiload(r)));
+    }
+#endif
+    for(; i < n; i++)
+    {
+        dst[i] = gmFloatfromHalf(src[i]);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* mixed kernels                                                               */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief transforms n half directions by the upper 3x3 of a mat4 and
+ * renormalizes them, half in / half out
+ *
+ * pass a normal matrix (e.g. from `gmMat4normalMatrix` widened to mat4)
+ * for normals. the stream is widened `CGM_HALF_BLOCK / 3` vectors at a
+ * time into a stack buffer, so memory traffic stays at 6 bytes per
+ * vector each way. `src` and `dst` may be the same array.
+ */
+CGMINLINE void gmHVec3transformDirBatch(mat4 m, const hvec3 *src, size_t n, hvec3 *dst)
+{
+    float b[CGM_HALF_BLOCK];
+    const size_t step = CGM_HALF_BLOCK / 3;
+
+    for(size_t i = 0; i < n; i += step)
+    {
+        size_t c = (n - i < step) ? n - i : step;
+        gmHalfdecodeBatch(&src[i].x, c * 3, b);
+
+        for(size_t k = 0; k < c; k++)
+        {
+            float x = b[k * 3 + 0], y = b[k * 3 + 1], z = b[k * 3 + 2];
+            float tx = m.m[0] * x + m.m[4] * y + m.m[8]  * z;
+            float ty = m.m[1] * x + m.m[5] * y + m.m[9]  * z;
+            float tz = m.m[2] * x + m.m[6] * y + m.m[10] * z;
+            float l = tx * tx + ty * ty + tz * tz;
+            float s = (l > 0.0f) ? 1.0f / sqrtf(l) : 0.0f;
+            b[k * 3 + 0] = tx * s;
+            b[k * 3 + 1] = ty * s;
+            b[k * 3 + 2] = tz * s;
+        }
+
+        gmHalfencodeBatch(b, c * 3, &dst[i].x);
+    }
+}
+
+/**
+ * @brief transforms n half tangents (xyz direction, w handedness) by the
+ * upper 3x3 of a mat4, renormalizing xyz and keeping w
+ *
+ * `src` and `dst` may be the same array.
+ */
+CGMINLINE void gmHVec4transformTangentBatch(mat4 m, const hvec4 *src, size_t n, hvec4 *dst)
+{
+    float b[CGM_HALF_BLOCK];
+    const size_t step = CGM_HALF_BLOCK / 4;
+
+    for(size_t i = 0; i < n; i += step)
+    {
+        size_t c = (n - i < step) ? n - i : step;
+        gmHalfdecodeBatch(&src[i].x, c * 4, b);
+
+        for(size_t k = 0; k < c; k++)
+        {
+            float x = b[k * 4 + 0], y = b[k * 4 + 1], z = b[k * 4 + 2];
+            float tx = m.m[0] * x + m.m[4] * y + m.m[8]  * z;
+            float ty = m.m[1] * x + m.m[5] * y + m.m[9]  * z;
+            float tz = m.m[2] * x + m.m[6] * y + m.m[10] * z;
+            float l = tx * tx + ty * ty + tz * tz;
+            float s = (l > 0.0f) ? 1.0f / sqrtf(l) : 0.0f;
+            b[k * 4 + 0] = tx * s;
+            b[k * 4 + 1] = ty * s;
+            b[k * 4 + 2] = tz * s;
+        }
+
+        gmHalfencodeBatch(b, c * 4, &dst[i].x);
+    }
+}
+
+/**
+ * @brief transforms n half vec4 by a mat4, half in / half out
+ *
+ * `src` and `dst` may be the same array.
+ */
+CGMINLINE void gmHVec4transformBatch(mat4 m, const hvec4 *src, size_t n, hvec4 *dst)
+{
+    float b[CGM_HALF_BLOCK];
+    const size_t step = CGM_HALF_BLOCK / 4;
+
+    for(size_t i = 0; i < n; i += step)
+    {
+        size_t c = (n - i < step) ? n - i : step;
+        gmHalfdecodeBatch(&src[i].x, c * 4, b);
+
+        for(size_t k = 0; k < c; k++)
+        {
+            vec4 v = gmVec4(b[k * 4 + 0], b[k * 4 + 1], b[k * 4 + 2], b[k * 4 + 3]);
+            v = gmMat4mulVec4(m, v);
+            b[k * 4 + 0] = v.x;
+            b[k * 4 + 1] = v.y;
+            b[k * 4 + 2] = v.z;
+            b[k * 4 + 3] = v.w;
+        }
+
+        gmHalfencodeBatch(b, c * 4, &dst[i].x);
+    }
+}
+
+typedef struct
+{
+    const void *src;
+    void *dst;
+    mat4 m;
+} gmHalfJob;
+
+CGMINLINE void gmHalfencodeTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmHalfJob *j = (gmHalfJob *)ctx;
+    (void)thread;
+    gmHalfencodeBatch((const float *)j->src + b, e - b, (half *)j->dst + b);
+}
+
+CGMINLINE void gmHalfdecodeTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmHalfJob *j = (gmHalfJob *)ctx;
+    (void)thread;
+    gmHalfdecodeBatch((const half *)j->src + b, e - b, (float *)j->dst + b);
+}
+
+CGMINLINE void gmHVec4transformTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmHalfJob *j = (gmHalfJob *)ctx;
+    (void)thread;
+    gmHVec4transformBatch(j->m, (const hvec4 *)j->src + b, e - b, (hvec4 *)j->dst + b);
+}
+
+/**
+ * @brief `gmHalfencodeBatch` split across the job pool
+ */
+CGMINLINE void gmHalfencodeBatchParallel(const float *src, size_t n, half *dst)
+{
+    gmHalfJob j = {src, dst, {{0}}};
+    gmParallelFor(n, 16384, gmHalfencodeTask, &j);
+}
+
+/**
+ * @brief `gmHalfdecodeBatch` split across the job pool
+ */
+CGMINLINE void gmHalfdecodeBatchParallel(const half *src, size_t n, float *dst)
+{
+    gmHalfJob j = {src, dst, {{0}}};
+    gmParallelFor(n, 16384, gmHalfdecodeTask, &j);
+}
+
+/**
+ * @brief `gmHVec4transformBatch` split across the job pool
+ */
+CGMINLINE void gmHVec4transformBatchParallel(mat4 m, const hvec4 *src, size_t n, hvec4 *dst)
+{
+    gmHalfJob j = {src, dst, m};
+    gmParallelFor(n, 4 * CGM_HALF_BLOCK, gmHVec4transformTask, &j);
+}
+
+#endif
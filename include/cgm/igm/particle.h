@@ -0,0 +1,398 @@
+#ifndef PARTICLE_GRAPHICS_MATH
+#define PARTICLE_GRAPHICS_MATH
+
+/**
+ * @file particle.h
+ * @brief particle integration over SoA vec3 streams
+ *
+ * positions and velocities live in separate x / y / z float arrays
+ * (`gmVec3Soa`), so one SIMD register holds the same component of
+ * `CGM_SIMD_WIDTH` particles and a step is straight-line lane math instead
+ * of `gmVec3add(gmVec3mulScale(...))` chains on AoS `vec3`.
+ *
+ * integrators:
+ *  - `gmParticlesEuler`: semi-implicit (symplectic) Euler, v first then p
+ *  - `gmParticlesVerletBegin` / `gmParticlesVerletEnd`: velocity Verlet as
+ *    kick-drift / kick, update the per-particle acceleration in between
+ *
+ * after the position update every step applies the same constraints:
+ * `gmVec3clamp`-style bounds, then each collision plane with a lane-wise
+ * `gmVec3reflect` of the velocity.
+ *
+ * every step has a `*Parallel` variant split with `gmParallelFor`
+ * (jgm/job.h); particles are independent, so results do not depend on
+ * the thread count.
+ */
+
+#include "../core.h"
+#include "../ugm/ugm.h"
+#include "../vec3.h"
+#include "../vec4.h"
+#include "../sgm/simd.h"
+#include "../jgm/job.h"
+#include <math.h>
+#include <stddef.h>
+
+#ifndef CGM_PARTICLE_GRAIN
+#define CGM_PARTICLE_GRAIN 4096 /* particles per parallel chunk */
+#endif
+
+#ifndef CGM_PARTICLE_PLANES
+#define CGM_PARTICLE_PLANES 16 /* max collision planes per step */
+#endif
+
+/*
+ * @brief SoA view of a vec3 stream, element i is (x[i], y[i], z[i])
+ */
+typedef struct
+{
+    float *x;
+    float *y;
+    float *z;
+} gmVec3Soa;
+
+typedef struct
+{
+    gmVec3Soa p;  /* positions */
+    gmVec3Soa v;  /* velocities */
+    gmVec3Soa a;  /* per-particle acceleration (gravity, forces / mass), a.x NULL for none */
+    size_t    n;
+} gmParticles;
+
+typedef struct
+{
+    vec3        gravity;     /* uniform acceleration added to every particle */
+    float       drag;        /* linear drag: dv/dt -= drag * v */
+    int         bounds;      /* clamp positions into [min, max] */
+    vec3        min;
+    vec3        max;
+    const vec4 *planes;      /* (n, d): n·p + d >= 0 is free space, n unit (see CGM_ASSUME_NORMALIZED) */
+    int         planeCount;  /* at most CGM_PARTICLE_PLANES */
+    float       restitution; /* normal speed kept on impact, 1 = gmVec3reflect */
+} gmParticleParams;
+
+/**
+ * @brief default parameters: no gravity, drag, bounds or planes
+ */
+CGMINLINE gmParticleParams gmParticleParamsDefault(void)
+{
+    gmParticleParams prm;
+    prm.gravity = gmVec3(0.0f, 0.0f, 0.0f);
+    prm.drag = 0.0f;
+    prm.bounds = 0;
+    prm.min = gmVec3(0.0f, 0.0f, 0.0f);
+    prm.max = gmVec3(0.0f, 0.0f, 0.0f);
+    prm.planes = NULL;
+    prm.planeCount = 0;
+    prm.restitution = 1.0f;
+    return prm;
+}
+
+/* -------------------------------------------------------------------------- */
+/* AoS conversion                                                              */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief scatter n AoS vectors into a SoA stream
+ */
+CGMINLINE void gmVec3SoafromArray(const vec3 *v, size_t n, gmVec3Soa out)
+{
+    for(size_t i = 0; i < n; i++)
+    {
+        out.x[i] = v[i].x;
+        out.y[i] = v[i].y;
+        out.z[i] = v[i].z;
+    }
+}
+
+/**
+ * @brief gather n vectors of a SoA stream into AoS
+ */
+CGMINLINE void gmVec3SoatoArray(gmVec3Soa v, size_t n, vec3 *out)
+{
+    for(size_t i = 0; i < n; i++)
+    {
+        out[i] = gmVec3(v.x[i], v.y[i], v.z[i]);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* lane kernels                                                                */
+/* -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    simdf px, py, pz;
+    simdf vx, vy, vz;
+    simdf ax, ay, az;
+} gmParticleLanes;
+
+/* staging for a partial last block: p, v, a components */
+typedef struct
+{
+    float lane[9][CGM_SIMD_WIDTH];
+} gmParticleTail;
+
+/* planes with unit normals, prepared once per step */
+typedef struct
+{
+    vec4 plane[CGM_PARTICLE_PLANES];
+    int  count;
+} gmParticlePlanes;
+
+CGMINLINE void gmParticlePlanesInit(const gmParticleParams *prm, gmParticlePlanes *out)
+{
+    out->count = GMMIN(prm->planeCount, CGM_PARTICLE_PLANES);
+    for(int i = 0; i < out->count; i++)
+    {
+        vec4 pl = prm->planes[i];
+#if !CGM_ASSUME_NORMALIZED
+        float inv = 1.0f / sqrtf(pl.x * pl.x + pl.y * pl.y + pl.z * pl.z);
+        pl = gmVec4(pl.x * inv, pl.y * inv, pl.z * inv, pl.w * inv);
+#endif
+        out->plane[i] = pl;
+    }
+}
+
+/*
+ * loads lanes [i, i + CGM_SIMD_WIDTH) or, with k < CGM_SIMD_WIDTH, the k
+ * remaining particles through `t` (unused lanes are zero)
+ */
+CGMINLINE void gmParticleLoad(const gmParticles *ps, size_t i, size_t k, gmParticleTail *t, gmParticleLanes *l)
+{
+    const float *src[9] = {ps->p.x, ps->p.y, ps->p.z, ps->v.x, ps->v.y, ps->v.z, ps->a.x, ps->a.y, ps->a.z};
+    simdf *dst[9] = {&l->px, &l->py, &l->pz, &l->vx, &l->vy, &l->vz, &l->ax, &l->ay, &l->az};
+    int streams = ps->a.x ? 9 : 6;
+
+    for(int s = 0; s < 9; s++)
+    {
+        if(s >= streams)
+        {
+            *dst[s] = gmSimdzero();
+        }
+        else if(k == CGM_SIMD_WIDTH)
+        {
+            *dst[s] = gmSimdload(src[s] + i);
+        }
+        else
+        {
+            float *lane = t->lane[s];
+            for(size_t j = 0; j < CGM_SIMD_WIDTH; j++)
+            {
+                lane[j] = (j < k) ? src[s][i + j] : 0.0f;
+            }
+            *dst[s] = gmSimdload(lane);
+        }
+    }
+}
+
+CGMINLINE void gmParticleStore(const gmParticles *ps, size_t i, size_t k, gmParticleTail *t, const gmParticleLanes *l)
+{
+    float *dst[6] = {ps->p.x, ps->p.y, ps->p.z, ps->v.x, ps->v.y, ps->v.z};
+    simdf src[6] = {l->px, l->py, l->pz, l->vx, l->vy, l->vz};
+
+    for(int s = 0; s < 6; s++)
+    {
+        if(k == CGM_SIMD_WIDTH)
+        {
+            gmSimdstore(dst[s] + i, src[s]);
+        }
+        else
+        {
+            float *lane = t->lane[s];
+            gmSimdstore(lane, src[s]);
+            for(size_t j = 0; j < k; j++)
+            {
+                dst[s][i + j] = lane[j];
+            }
+        }
+    }
+}
+
+/* v += (gravity + a - drag * v) * h */
+CGMINLINE void gmParticleKick(gmParticleLanes *l, const gmParticleParams *prm, simdf h)
+{
+    simdf k = gmSimdsplat(prm->drag);
+    simdf ax = gmSimdsub(gmSimdadd(l->ax, gmSimdsplat(prm->gravity.x)), gmSimdmul(k, l->vx));
+    simdf ay = gmSimdsub(gmSimdadd(l->ay, gmSimdsplat(prm->gravity.y)), gmSimdmul(k, l->vy));
+    simdf az = gmSimdsub(gmSimdadd(l->az, gmSimdsplat(prm->gravity.z)), gmSimdmul(k, l->vz));
+    l->vx = gmSimdfma(ax, h, l->vx);
+    l->vy = gmSimdfma(ay, h, l->vy);
+    l->vz = gmSimdfma(az, h, l->vz);
+}
+
+CGMINLINE void gmParticleDrift(gmParticleLanes *l, simdf h)
+{
+    l->px = gmSimdfma(l->vx, h, l->px);
+    l->py = gmSimdfma(l->vy, h, l->py);
+    l->pz = gmSimdfma(l->vz, h, l->pz);
+}
+
+/* clamps one axis, velocity pointing further out of the box is zeroed */
+CGMINLINE void gmParticleClampAxis(simdf *p, simdf *v, float min, float max)
+{
+    simdf lo = gmSimdsplat(min), hi = gmSimdsplat(max), zero = gmSimdzero();
+    simdf out = gmSimdor(gmSimdand(gmSimdlt(*p, lo), gmSimdlt(*v, zero)),
+                         gmSimdand(gmSimdlt(hi, *p), gmSimdlt(zero, *v)));
+    *v = gmSimdandnot(out, *v);
+    *p = gmSimdmax(lo, gmSimdmin(*p, hi));
+}
+
+/*
+ * bounds, then every plane: penetrating particles are pushed back onto the
+ * plane and, when moving inwards, their velocity is reflected
+ * (v - (1 + e) (v·n) n, the lane form of gmVec3reflect for e = 1)
+ */
+CGMINLINE void gmParticleConstrain(gmParticleLanes *l, const gmParticleParams *prm, const gmParticlePlanes *pl)
+{
+    if(prm->bounds)
+    {
+        gmParticleClampAxis(&l->px, &l->vx, prm->min.x, prm->max.x);
+        gmParticleClampAxis(&l->py, &l->vy, prm->min.y, prm->max.y);
+        gmParticleClampAxis(&l->pz, &l->vz, prm->min.z, prm->max.z);
+    }
+
+    simdf zero = gmSimdzero();
+    simdf e1 = gmSimdsplat(1.0f + prm->restitution);
+    for(int i = 0; i < pl->count; i++)
+    {
+        simdf nx = gmSimdsplat(pl->plane[i].x);
+        simdf ny = gmSimdsplat(pl->plane[i].y);
+        simdf nz = gmSimdsplat(pl->plane[i].z);
+
+        simdf d = gmSimdfma(nx, l->px, gmSimdfma(ny, l->py, gmSimdfma(nz, l->pz, gmSimdsplat(pl->plane[i].w))));
+        simdf pen = gmSimdmin(d, zero);
+        l->px = gmSimdsub(l->px, gmSimdmul(nx, pen));
+        l->py = gmSimdsub(l->py, gmSimdmul(ny, pen));
+        l->pz = gmSimdsub(l->pz, gmSimdmul(nz, pen));
+
+        simdf vn = gmSimdfma(nx, l->vx, gmSimdfma(ny, l->vy, gmSimdmul(nz, l->vz)));
+        simdf hit = gmSimdand(gmSimdlt(d, zero), gmSimdlt(vn, zero));
+        simdf j = gmSimdand(hit, gmSimdmul(e1, vn));
+        l->vx = gmSimdsub(l->vx, gmSimdmul(nx, j));
+        l->vy = gmSimdsub(l->vy, gmSimdmul(ny, j));
+        l->vz = gmSimdsub(l->vz, gmSimdmul(nz, j));
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* steps over a range                                                          */
+/* -------------------------------------------------------------------------- */
+
+#define CGM_PARTICLE_EULER        0
+#define CGM_PARTICLE_VERLET_BEGIN 1
+#define CGM_PARTICLE_VERLET_END   2
+
+/**
+ * @brief one integrator stage for particles [begin, end)
+ * @param stage CGM_PARTICLE_EULER, CGM_PARTICLE_VERLET_BEGIN or CGM_PARTICLE_VERLET_END
+ */
+CGMINLINE void gmParticlesStepRange(const gmParticles *ps, const gmParticleParams *prm, float dt, int stage,
+                                    size_t begin, size_t end)
+{
+    gmParticlePlanes pl;
+    gmParticleTail t;
+    simdf full = gmSimdsplat(dt), half = gmSimdsplat(0.5f * dt);
+
+    gmParticlePlanesInit(prm, &pl);
+    for(size_t i = begin; i < end; i += CGM_SIMD_WIDTH)
+    {
+        size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, end - i);
+        gmParticleLanes l;
+
+        gmParticleLoad(ps, i, k, &t, &l);
+        if(stage == CGM_PARTICLE_EULER)
+        {
+            gmParticleKick(&l, prm, full);
+            gmParticleDrift(&l, full);
+            gmParticleConstrain(&l, prm, &pl);
+        }
+        else if(stage == CGM_PARTICLE_VERLET_BEGIN)
+        {
+            gmParticleKick(&l, prm, half);
+            gmParticleDrift(&l, full);
+            gmParticleConstrain(&l, prm, &pl);
+        }
+        else
+        {
+            gmParticleKick(&l, prm, half);
+        }
+        gmParticleStore(ps, i, k, &t, &l);
+    }
+}
+
+typedef struct
+{
+    const gmParticles      *ps;
+    const gmParticleParams *prm;
+    float                   dt;
+    int                     stage;
+} gmParticleJob;
+
+CGMINLINE void gmParticlesStepTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmParticleJob *j = (gmParticleJob *)ctx;
+    (void)thread;
+    gmParticlesStepRange(j->ps, j->prm, j->dt, j->stage, b, e);
+}
+
+/* -------------------------------------------------------------------------- */
+/* integrators                                                                 */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief semi-implicit Euler: v += a dt, then p += v dt, then constraints
+ *
+ * the acceleration is gravity + ps->a - drag * v; stable while drag * dt < 1.
+ */
+CGMINLINE void gmParticlesEuler(const gmParticles *ps, const gmParticleParams *prm, float dt)
+{
+    gmParticlesStepRange(ps, prm, dt, CGM_PARTICLE_EULER, 0, ps->n);
+}
+
+/**
+ * @brief first half of velocity Verlet: v += a dt / 2, p += v dt, constraints
+ *
+ * recompute ps->a at the new positions, then call `gmParticlesVerletEnd`.
+ */
+CGMINLINE void gmParticlesVerletBegin(const gmParticles *ps, const gmParticleParams *prm, float dt)
+{
+    gmParticlesStepRange(ps, prm, dt, CGM_PARTICLE_VERLET_BEGIN, 0, ps->n);
+}
+
+/**
+ * @brief second half of velocity Verlet: v += a dt / 2 with the new acceleration
+ */
+CGMINLINE void gmParticlesVerletEnd(const gmParticles *ps, const gmParticleParams *prm, float dt)
+{
+    gmParticlesStepRange(ps, prm, dt, CGM_PARTICLE_VERLET_END, 0, ps->n);
+}
+
+/**
+ * @brief `gmParticlesEuler` split across the job pool
+ */
+CGMINLINE void gmParticlesEulerParallel(const gmParticles *ps, const gmParticleParams *prm, float dt)
+{
+    gmParticleJob j = {ps, prm, dt, CGM_PARTICLE_EULER};
+    gmParallelFor(ps->n, CGM_PARTICLE_GRAIN, gmParticlesStepTask, &j);
+}
+
+/**
+ * @brief `gmParticlesVerletBegin` split across the job pool
+ */
+CGMINLINE void gmParticlesVerletBeginParallel(const gmParticles *ps, const gmParticleParams *prm, float dt)
+{
+    gmParticleJob j = {ps, prm, dt, CGM_PARTICLE_VERLET_BEGIN};
+    gmParallelFor(ps->n, CGM_PARTICLE_GRAIN, gmParticlesStepTask, &j);
+}
+
+/**
+ * @brief `gmParticlesVerletEnd` split across the job pool
+ */
+CGMINLINE void gmParticlesVerletEndParallel(const gmParticles *ps, const gmParticleParams *prm, float dt)
+{
+    gmParticleJob j = {ps, prm, dt, CGM_PARTICLE_VERLET_END};
+    gmParallelFor(ps->n, CGM_PARTICLE_GRAIN, gmParticlesStepTask, &j);
+}
+
+#endif
@@ -0,0 +1,397 @@
+#ifndef JOB_GRAPHICS_MATH
+#define JOB_GRAPHICS_MATH
+
+/**
+ * @file job.h
+ * @brief optional work-stealing parallel-for for the batch kernels
+ *
+ * `gmParallelFor(count, grain, fn, ctx)` splits [0, count) into chunks of
+ * `grain` elements and calls `fn(ctx, begin, end, thread)` once per chunk.
+ * chunk k is always [k * grain, min((k + 1) * grain, count)), whatever the
+ * number of threads, so kernels that store per-chunk results and combine
+ * them in chunk order are deterministic.
+ *
+ * each thread starts on a contiguous share of the chunks and steals half
+ * of the remaining range of another thread once its own share is empty.
+ * `thread` is in [0, gmJobThreads()) and indexes per-thread scratch
+ * (`gmJobScratch`) or per-thread state sized by the caller. the calling
+ * thread takes part as thread 0.
+ *
+ * macros:
+ *  `CGM_THREADS`: enable the pthread scheduler (compile and link with
+ *  `-pthread`). without it every call runs serially on the caller, with
+ *  the same chunking.
+ *  `CGM_MAX_THREADS`: upper bound on threads (default: 64)
+ *  `CGM_JOB_SCRATCH`: bytes of scratch per thread (default: 64 KiB)
+ *
+ * the pool is created on first use with one thread per online core, or
+ * explicitly with `gmJobInit`. calls made from inside a job run serially.
+ */
+
+#include "../core.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef CGM_MAX_THREADS
+#define CGM_MAX_THREADS 64
+#endif
+
+#ifndef CGM_JOB_SCRATCH
+#define CGM_JOB_SCRATCH (64 * 1024)
+#endif
+
+/**
+ * @brief chunk callback: process [begin, end) on thread `thread`
+ */
+typedef void (*gmJobFn)(void *ctx, size_t begin, size_t end, int thread);
+
+#if defined(CGM_THREADS)
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+/*
+ * pool state is a weak global, so every translation unit that includes
+ * this header shares one pool.
+ */
+typedef struct
+{
+    pthread_t       threads[CGM_MAX_THREADS];
+    int             count;
+    int             started;
+    int             quit;
+
+    /* current job, written under `gmJobLock` */
+    uint64_t        generation;
+    int             open;
+    gmJobFn         fn;
+    void           *ctx;
+    size_t          n;
+    size_t          grain;
+
+    /* per-thread chunk range packed as (begin << 32 | end) */
+    uint64_t        range[CGM_MAX_THREADS];
+    size_t          remaining;
+    int             busy;     /* workers inside gmJobWork, atomic */
+
+    unsigned char  *scratch[CGM_MAX_THREADS];
+} gmJobPool;
+
+__attribute__((weak)) gmJobPool gmJobPoolGlobal;
+
+/* `gmJobLock` guards the job fields, `gmJobDispatch` serializes jobs */
+__attribute__((weak)) pthread_mutex_t gmJobLock = PTHREAD_MUTEX_INITIALIZER;
+__attribute__((weak)) pthread_mutex_t gmJobDispatch = PTHREAD_MUTEX_INITIALIZER;
+__attribute__((weak)) pthread_cond_t  gmJobWake = PTHREAD_COND_INITIALIZER;
+
+/* 1 + index of the pool thread running a chunk on this thread, else 0 */
+__attribute__((weak)) __thread int gmJobInside;
+
+/*
+ * @brief takes one chunk from the front of thread t's own range
+ */
+CGMINLINE int gmJobPop(gmJobPool *p, int t, uint32_t *chunk)
+{
+    uint64_t r = __atomic_load_n(&p->range[t], __ATOMIC_ACQUIRE);
+    for(;;)
+    {
+        uint32_t b = (uint32_t)(r >> 32), e = (uint32_t)r;
+        if(b >= e)
+        {
+            return 0;
+        }
+        uint64_t nr = ((uint64_t)(b + 1) << 32) | e;
+        if(__atomic_compare_exchange_n(&p->range[t], &r, nr, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            *chunk = b;
+            return 1;
+        }
+    }
+}
+
+/*
+ * @brief steals the back half of another thread's range into t's range
+ */
+CGMINLINE int gmJobSteal(gmJobPool *p, int t)
+{
+    for(int k = 1; k < p->count; k++)
+    {
+        int v = (t + k) % p->count;
+        uint64_t r = __atomic_load_n(&p->range[v], __ATOMIC_ACQUIRE);
+        for(;;)
+        {
+            uint32_t b = (uint32_t)(r >> 32), e = (uint32_t)r;
+            if(b >= e)
+            {
+                break;
+            }
+            uint32_t m = e - (e - b + 1) / 2;
+            uint64_t nr = ((uint64_t)b << 32) | m;
+            if(__atomic_compare_exchange_n(&p->range[v], &r, nr, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                __atomic_store_n(&p->range[t], ((uint64_t)m << 32) | e, __ATOMIC_RELEASE);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * @brief runs chunks of the current job until none are left anywhere
+ */
+CGMINLINE void gmJobWork(gmJobPool *p, int t)
+{
+    uint32_t c;
+    gmJobInside = t + 1;
+    for(;;)
+    {
+        while(gmJobPop(p, t, &c))
+        {
+            size_t b = (size_t)c * p->grain;
+            size_t e = (b + p->grain < p->n) ? b + p->grain : p->n;
+            p->fn(p->ctx, b, e, t);
+            __atomic_sub_fetch(&p->remaining, 1, __ATOMIC_ACQ_REL);
+        }
+        if(!gmJobSteal(p, t))
+        {
+            break;
+        }
+    }
+    gmJobInside = 0;
+}
+
+CGMINLINE void *gmJobThreadMain(void *arg)
+{
+    gmJobPool *p = &gmJobPoolGlobal;
+    int t = (int)(intptr_t)arg;
+    uint64_t seen = 0;
+
+    pthread_mutex_lock(&gmJobLock);
+    for(;;)
+    {
+        while(!p->quit && (p->generation == seen || !p->open))
+        {
+            if(p->generation != seen)
+            {
+                seen = p->generation;
+            }
+            pthread_cond_wait(&gmJobWake, &gmJobLock);
+        }
+        if(p->quit)
+        {
+            break;
+        }
+        seen = p->generation;
+        __atomic_add_fetch(&p->busy, 1, __ATOMIC_ACQ_REL);
+        pthread_mutex_unlock(&gmJobLock);
+
+        gmJobWork(p, t);
+
+        pthread_mutex_lock(&gmJobLock);
+        __atomic_sub_fetch(&p->busy, 1, __ATOMIC_ACQ_REL);
+    }
+    pthread_mutex_unlock(&gmJobLock);
+    return NULL;
+}
+
+/**
+ * @brief starts the pool with `threads` threads (including the caller)
+ *
+ * @param threads thread count, 0 for one per online core
+ */
+CGMINLINE void gmJobInit(int threads)
+{
+    gmJobPool *p = &gmJobPoolGlobal;
+    pthread_mutex_lock(&gmJobDispatch);
+    if(!p->started)
+    {
+        if(threads <= 0)
+        {
+            long c = sysconf(_SC_NPROCESSORS_ONLN);
+            threads = (c > 0) ? (int)c : 1;
+        }
+        threads = (threads > CGM_MAX_THREADS) ? CGM_MAX_THREADS : threads;
+
+        p->count = threads;
+        p->quit = 0;
+        for(int t = 0; t < threads; t++)
+        {
+            p->scratch[t] = (unsigned char *)malloc(CGM_JOB_SCRATCH);
+        }
+        for(int t = 1; t < threads; t++)
+        {
+            if(pthread_create(&p->threads[t], NULL, gmJobThreadMain, (void *)(intptr_t)t) != 0)
+            {
+                p->count = t;
+                break;
+            }
+        }
+        __atomic_store_n(&p->started, 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&gmJobDispatch);
+}
+
+/**
+ * @brief stops and joins the pool threads
+ */
+CGMINLINE void gmJobShutdown(void)
+{
+    gmJobPool *p = &gmJobPoolGlobal;
+    pthread_mutex_lock(&gmJobDispatch);
+    if(p->started)
+    {
+        pthread_mutex_lock(&gmJobLock);
+        p->quit = 1;
+        pthread_cond_broadcast(&gmJobWake);
+        pthread_mutex_unlock(&gmJobLock);
+
+        for(int t = 1; t < p->count; t++)
+        {
+            pthread_join(p->threads[t], NULL);
+        }
+        for(int t = 0; t < CGM_MAX_THREADS; t++)
+        {
+            free(p->scratch[t]);
+            p->scratch[t] = NULL;
+        }
+        __atomic_store_n(&p->started, 0, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&gmJobDispatch);
+}
+
+/**
+ * @brief number of threads a job may run on (including the caller)
+ */
+CGMINLINE int gmJobThreads(void)
+{
+    gmJobPool *p = &gmJobPoolGlobal;
+    if(!__atomic_load_n(&p->started, __ATOMIC_ACQUIRE))
+    {
+        gmJobInit(0);
+    }
+    return p->count;
+}
+
+/**
+ * @brief `CGM_JOB_SCRATCH` bytes private to `thread` for the duration of a
+ * chunk callback, NULL if the allocation failed
+ *
+ * starts the pool if needed, so it is valid in every callback, including
+ * the serial ones that run before the first parallel job:
+ *
+ *     void task(void *ctx, size_t b, size_t e, int thread)
+ *     {
+ *         float *tmp = (float *)gmJobScratch(thread);
+ *         ...
+ *     }
+ */
+CGMINLINE void *gmJobScratch(int thread)
+{
+    return (thread < gmJobThreads()) ? gmJobPoolGlobal.scratch[thread] : NULL;
+}
+
+/**
+ * @brief parallel loop over [0, count) in chunks of `grain` elements
+ *
+ * returns when every chunk has run. with a single chunk, a single thread,
+ * or when called from inside a job, the chunks run in order on the caller.
+ */
+CGMINLINE void gmParallelFor(size_t count, size_t grain, gmJobFn fn, void *ctx)
+{
+    gmJobPool *p = &gmJobPoolGlobal;
+    grain = (grain == 0) ? 1 : grain;
+    size_t chunks = (count + grain - 1) / grain;
+
+    if(chunks > 1 && !gmJobInside && chunks <= 0xffffffffu)
+    {
+        int threads = gmJobThreads();
+        if(threads > 1)
+        {
+            pthread_mutex_lock(&gmJobDispatch);
+            pthread_mutex_lock(&gmJobLock);
+
+            p->fn = fn;
+            p->ctx = ctx;
+            p->n = count;
+            p->grain = grain;
+            p->remaining = chunks;
+            for(int t = 0; t < p->count; t++)
+            {
+                uint64_t b = chunks * (size_t)t / (size_t)p->count;
+                uint64_t e = chunks * (size_t)(t + 1) / (size_t)p->count;
+                p->range[t] = (b << 32) | e;
+            }
+            p->open = 1;
+            p->generation++;
+            pthread_cond_broadcast(&gmJobWake);
+            pthread_mutex_unlock(&gmJobLock);
+
+            gmJobWork(p, 0);
+            while(__atomic_load_n(&p->remaining, __ATOMIC_ACQUIRE) != 0)
+            {
+                sched_yield();
+            }
+
+            /* no late joiners, then wait for workers still scanning */
+            pthread_mutex_lock(&gmJobLock);
+            p->open = 0;
+            pthread_mutex_unlock(&gmJobLock);
+            while(__atomic_load_n(&p->busy, __ATOMIC_ACQUIRE) != 0)
+            {
+                sched_yield();
+            }
+
+            pthread_mutex_unlock(&gmJobDispatch);
+            return;
+        }
+    }
+
+    int thread = gmJobInside ? gmJobInside - 1 : 0;
+    for(size_t c = 0; c < chunks; c++)
+    {
+        size_t b = c * grain;
+        size_t e = (b + grain < count) ? b + grain : count;
+        fn(ctx, b, e, thread);
+    }
+}
+
+#else
+
+__attribute__((weak, aligned(64))) unsigned char gmJobScratchSerial[CGM_JOB_SCRATCH];
+
+CGMINLINE void gmJobInit(int threads)
+{
+    (void)threads;
+}
+
+CGMINLINE void gmJobShutdown(void)
+{
+}
+
+CGMINLINE int gmJobThreads(void)
+{
+    return 1;
+}
+
+CGMINLINE void *gmJobScratch(int thread)
+{
+    (void)thread;
+    return gmJobScratchSerial;
+}
+
+CGMINLINE void gmParallelFor(size_t count, size_t grain, gmJobFn fn, void *ctx)
+{
+    grain = (grain == 0) ? 1 : grain;
+    for(size_t b = 0; b < count; b += grain)
+    {
+        size_t e = (b + grain < count) ? b + grain : count;
+        fn(ctx, b, e, 0);
+    }
+}
+
+#endif
+
+#endif
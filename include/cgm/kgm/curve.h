@@ -0,0 +1,547 @@
+#ifndef CURVE_GRAPHICS_MATH
+#define CURVE_GRAPHICS_MATH
+
+/**
+ * @file curve.h
+ * @brief keyframe animation curves for float, vec3 and quat channels
+ *
+ * a curve is a view over caller arrays: `count` increasing key times and
+ * `dim` floats per key (1 float, 3 vec3, 4 quat). between key k and k + 1
+ * the value follows, with u = (t - time[k]) / (time[k + 1] - time[k]):
+ *  - `CGM_CURVE_STEP`: value[k]
+ *  - `CGM_CURVE_LINEAR`: `gmMix(value[k], value[k + 1], u)`
+ *  - `CGM_CURVE_HERMITE`: cubic Hermite with `out[k]` / `in[k + 1]` as
+ *    slopes per unit of time (glTF CUBICSPLINE). zero tangents give
+ *    `gmSmoothstep` easing.
+ *  - `CGM_CURVE_BEZIER`: cubic Bezier in u with `out[k]` / `in[k + 1]`
+ *    as the inner control values (time handles are not supported)
+ * before the first and after the last key the curve holds the end value.
+ * a curve with a single key is constant, an empty one (count 0) samples
+ * as zero, or the identity for quat curves.
+ *
+ * quat curves interpolate componentwise and normalize, i.e. nlerp for
+ * linear segments; consecutive keys must lie in the same hemisphere
+ * (`gmCurveAlignQuat`).
+ *
+ * sampling keeps a cursor per curve instance: playback moves forward, so
+ * the key segment is found by stepping from the previous one in
+ * amortized O(1), with a binary search fallback for jumps.
+ *
+ * `gmCurveSet` samples many curves at the same (or per-curve) time. it
+ * caches the polynomial of every curve's current segment in SoA blocks,
+ * so a frame is one SIMD pass that checks the segment bounds and
+ * evaluates `CGM_SIMD_WIDTH` curves at a time; only the lanes that left
+ * their segment go back to the scalar cursor code.
+ */
+
+#include "../core.h"
+#include "../ugm/ugm.h"
+#include "../vec3.h"
+#include "../quat.h"
+#include "../sgm/simd.h"
+#include "../jgm/job.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef CGM_CURVE_GRAIN
+#define CGM_CURVE_GRAIN 4096 /* curves per parallel chunk, multiple of 8 */
+#endif
+
+#ifndef CGM_CURVE_WALK
+#define CGM_CURVE_WALK 4 /* keys stepped by a cursor before it falls back to binary search */
+#endif
+
+#define CGM_CURVE_STEP    0
+#define CGM_CURVE_LINEAR  1
+#define CGM_CURVE_HERMITE 2
+#define CGM_CURVE_BEZIER  3
+
+/* floats per key */
+#define CGM_CURVE_FLOAT 1
+#define CGM_CURVE_VEC3  3
+#define CGM_CURVE_QUAT  4
+
+typedef struct
+{
+    const float *time;  /* count increasing key times */
+    const float *value; /* dim floats per key */
+    const float *in;    /* dim floats per key, Hermite / Bezier only */
+    const float *out;   /* dim floats per key, Hermite / Bezier only */
+    int          count;
+    int          dim;   /* CGM_CURVE_FLOAT, CGM_CURVE_VEC3 or CGM_CURVE_QUAT */
+    int          mode;  /* CGM_CURVE_STEP ... CGM_CURVE_BEZIER */
+} gmCurve;
+
+/**
+ * @brief curve over caller arrays
+ */
+CGMINLINE gmCurve gmCurveInit(const float *time, const float *value, const float *in, const float *out,
+                              int count, int dim, int mode)
+{
+    gmCurve c = {time, value, in, out, count, dim, mode};
+    return c;
+}
+
+/**
+ * @brief flips quat keys (and their tangents) into the hemisphere of the
+ * previous key
+ */
+CGMINLINE void gmCurveAlignQuat(float *value, float *in, float *out, int count)
+{
+    for(int k = 1; k < count; k++)
+    {
+        float *p = value + 4 * (k - 1), *q = value + 4 * k;
+        if(p[0] * q[0] + p[1] * q[1] + p[2] * q[2] + p[3] * q[3] < 0.0f)
+        {
+            for(int i = 0; i < 4; i++)
+            {
+                q[i] = -q[i];
+                if(in)
+                {
+                    in[4 * k + i] = -in[4 * k + i];
+                }
+                if(out)
+                {
+                    out[4 * k + i] = -out[4 * k + i];
+                }
+            }
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* segments                                                                    */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief segment of t: k with time[k] <= t < time[k + 1], -1 before the
+ * first key, count - 1 from the last key on
+ *
+ * @param cursor per-instance state, the previous segment (start at 0)
+ */
+CGMINLINE int gmCurveSeek(const gmCurve *c, int *cursor, float t)
+{
+    const float *time = c->time;
+    int n = c->count;
+    int k = GMMIN(GMMAX(*cursor, -1), n - 1);
+
+    for(int s = 0; s < CGM_CURVE_WALK; s++)
+    {
+        if(k + 1 < n && t >= time[k + 1])
+        {
+            k++;
+        }
+        else if(k >= 0 && t < time[k])
+        {
+            k--;
+        }
+        else
+        {
+            *cursor = k;
+            return k;
+        }
+    }
+
+    /* far jump: number of keys <= t, minus one */
+    int lo = 0, hi = n;
+    while(lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if(time[mid] <= t)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    *cursor = lo - 1;
+    return lo - 1;
+}
+
+/**
+ * @brief segment weights of the key values and tangents at u in [0, 1)
+ *
+ * v = w[0] value[k] + w[1] value[k + 1] + w[2] out[k] + w[3] in[k + 1]
+ */
+CGMINLINE void gmCurveWeights(int mode, float u, float dt, float *w)
+{
+    float u2 = u * u, u3 = u2 * u;
+
+    switch(mode)
+    {
+        case CGM_CURVE_STEP:
+            w[0] = 1.0f; w[1] = 0.0f; w[2] = 0.0f; w[3] = 0.0f;
+            break;
+        case CGM_CURVE_LINEAR:
+            w[0] = 1.0f - u; w[1] = u; w[2] = 0.0f; w[3] = 0.0f;
+            break;
+        case CGM_CURVE_HERMITE:
+            w[0] = 2.0f * u3 - 3.0f * u2 + 1.0f;
+            w[1] = 3.0f * u2 - 2.0f * u3;
+            w[2] = (u3 - 2.0f * u2 + u) * dt;
+            w[3] = (u3 - u2) * dt;
+            break;
+        default:
+        {
+            float v = 1.0f - u;
+            w[0] = v * v * v;
+            w[1] = u3;
+            w[2] = 3.0f * v * v * u;
+            w[3] = 3.0f * v * u2;
+            break;
+        }
+    }
+}
+
+/* held value before the first (k < 0) or from the last key on */
+CGMINLINE void gmCurveHold(const gmCurve *c, int k, float *v)
+{
+    int d = c->dim, n = c->count;
+
+    for(int i = 0; i < d; i++)
+    {
+        v[i] = (n > 0) ? c->value[(size_t)d * (size_t)((k < 0) ? 0 : n - 1) + (size_t)i]
+                       : (d == CGM_CURVE_QUAT && i == 3) ? 1.0f : 0.0f;
+    }
+}
+
+/**
+ * @brief power basis of segment k, v(u) = p0 + p1 u + p2 u^2 + p3 u^3
+ * for every component, plus the segment bounds
+ *
+ * @param p coefficient j of component i at p[(4 i + j) * stride]
+ * @param t0 segment start (-inf before the first key)
+ * @param t1 segment end (+inf from the last key on)
+ * @param inv 1 / (t1 - t0), 0 for the held ends
+ */
+CGMINLINE void gmCurveSegment(const gmCurve *c, int k, float *p, size_t stride, float *t0, float *t1, float *inv)
+{
+    int d = c->dim, n = c->count;
+
+    if(k < 0 || k >= n - 1)
+    {
+        float v[4];
+        gmCurveHold(c, k, v);
+        for(int i = 0; i < d; i++)
+        {
+            p[(size_t)(4 * i) * stride] = v[i];
+            p[(size_t)(4 * i + 1) * stride] = 0.0f;
+            p[(size_t)(4 * i + 2) * stride] = 0.0f;
+            p[(size_t)(4 * i + 3) * stride] = 0.0f;
+        }
+        *t0 = (k < 0 || n == 0) ? -INFINITY : c->time[n - 1];
+        *t1 = (k < 0 && n > 0) ? c->time[0] : INFINITY;
+        *inv = 0.0f;
+        return;
+    }
+
+    /* basis[mode][j]: weights of value[k], value[k + 1], out[k], in[k + 1] for coefficient j */
+    static const float basis[4][4][4] = {
+        {{1, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}},
+        {{1, 0, 0, 0}, {-1, 1, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}},
+        {{1, 0, 0, 0}, {0, 0, 1, 0}, {-3, 3, -2, -1}, {2, -2, 1, 1}},
+        {{1, 0, 0, 0}, {-3, 0, 3, 0}, {3, 0, -6, 3}, {-1, 1, 3, -3}}
+    };
+    const float (*w)[4] = basis[c->mode];
+    float dt = c->time[k + 1] - c->time[k];
+    float scale = (c->mode == CGM_CURVE_HERMITE) ? dt : 1.0f;
+    size_t a = (size_t)d * (size_t)k, b = a + (size_t)d;
+
+    *t0 = c->time[k];
+    *t1 = c->time[k + 1];
+    *inv = 1.0f / dt;
+
+    for(int i = 0; i < d; i++)
+    {
+        float x[4];
+        x[0] = c->value[a + (size_t)i];
+        x[1] = c->value[b + (size_t)i];
+        x[2] = (c->mode >= CGM_CURVE_HERMITE) ? c->out[a + (size_t)i] * scale : 0.0f;
+        x[3] = (c->mode >= CGM_CURVE_HERMITE) ? c->in[b + (size_t)i] * scale : 0.0f;
+        for(int j = 0; j < 4; j++)
+        {
+            p[(size_t)(4 * i + j) * stride] = w[j][0] * x[0] + w[j][1] * x[1] + w[j][2] * x[2] + w[j][3] * x[3];
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* scalar sampling                                                             */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief value of the curve at t into out (dim floats), quats normalized
+ * @param cursor per-instance state (start at 0)
+ */
+CGMINLINE void gmCurveSample(const gmCurve *c, int *cursor, float t, float *out)
+{
+    int d = c->dim, n = c->count;
+    int k = gmCurveSeek(c, cursor, t);
+    float v[4];
+
+    if(k < 0 || k >= n - 1)
+    {
+        gmCurveHold(c, k, v);
+    }
+    else
+    {
+        float dt = c->time[k + 1] - c->time[k], w[4];
+        size_t a = (size_t)d * (size_t)k, b = a + (size_t)d;
+        gmCurveWeights(c->mode, (t - c->time[k]) / dt, dt, w);
+
+        for(int i = 0; i < d; i++)
+        {
+            v[i] = w[0] * c->value[a + (size_t)i] + w[1] * c->value[b + (size_t)i];
+            if(c->mode >= CGM_CURVE_HERMITE)
+            {
+                v[i] += w[2] * c->out[a + (size_t)i] + w[3] * c->in[b + (size_t)i];
+            }
+        }
+    }
+    if(d == CGM_CURVE_QUAT)
+    {
+        float s = 1.0f / sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3]);
+        v[0] *= s;
+        v[1] *= s;
+        v[2] *= s;
+        v[3] *= s;
+    }
+    for(int i = 0; i < d; i++)
+    {
+        out[i] = v[i];
+    }
+}
+
+CGMINLINE float gmCurveSampleFloat(const gmCurve *c, int *cursor, float t)
+{
+    float v;
+    gmCurveSample(c, cursor, t, &v);
+    return v;
+}
+
+CGMINLINE vec3 gmCurveSampleVec3(const gmCurve *c, int *cursor, float t)
+{
+    float v[3];
+    gmCurveSample(c, cursor, t, v);
+    return gmVec3(v[0], v[1], v[2]);
+}
+
+CGMINLINE quat gmCurveSampleQuat(const gmCurve *c, int *cursor, float t)
+{
+    float v[4];
+    gmCurveSample(c, cursor, t, v);
+    return gmQuat(v[0], v[1], v[2], v[3]);
+}
+
+/* -------------------------------------------------------------------------- */
+/* curve sets                                                                  */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * cached segment of every curve. curves are grouped in blocks of
+ * `CGM_SIMD_WIDTH`; a block holds `rows` arrays of `CGM_SIMD_WIDTH`
+ * floats: t0, t1, inv, then coefficient j of component i in row 3 + 4 i + j.
+ * a refresh touches one block, the SIMD pass streams through them.
+ * padding lanes of the last block hold a constant segment.
+ */
+typedef struct
+{
+    const gmCurve *curves;
+    size_t         count;
+    int            dim;
+    int            rows;   /* 3 + 4 * dim */
+    int32_t       *cursor;
+    float         *block;
+} gmCurveSet;
+
+CGMINLINE size_t gmCurveSetBlocks(size_t count)
+{
+    return (count + CGM_SIMD_WIDTH - 1) / CGM_SIMD_WIDTH;
+}
+
+/**
+ * @brief bytes of memory needed for `count` curves of dimension `dim`
+ */
+CGMINLINE size_t gmCurveSetBytes(size_t count, int dim)
+{
+    return gmCurveSetBlocks(count) * CGM_SIMD_WIDTH * (4 + 4 * (size_t)dim) * sizeof(float);
+}
+
+/* refreshes the cached segment of curve i for time t */
+CGMINLINE void gmCurveSetRefresh(gmCurveSet *s, size_t i, float t)
+{
+    float *b = s->block + (i / CGM_SIMD_WIDTH) * (size_t)s->rows * CGM_SIMD_WIDTH + i % CGM_SIMD_WIDTH;
+    int cursor = s->cursor[i];
+    int k = gmCurveSeek(&s->curves[i], &cursor, t);
+
+    s->cursor[i] = cursor;
+    gmCurveSegment(&s->curves[i], k, b + 3 * CGM_SIMD_WIDTH, CGM_SIMD_WIDTH,
+                   b, b + CGM_SIMD_WIDTH, b + 2 * CGM_SIMD_WIDTH);
+}
+
+/**
+ * @brief curve set over caller memory
+ *
+ * @param mem at least `gmCurveSetBytes(count, dim)` bytes, 4-byte aligned
+ * @param curves `count` curves, all of dimension `dim`, kept by reference
+ */
+CGMINLINE gmCurveSet gmCurveSetInit(void *mem, const gmCurve *curves, size_t count, int dim)
+{
+    gmCurveSet s;
+    size_t lanes = gmCurveSetBlocks(count) * CGM_SIMD_WIDTH;
+
+    s.curves = curves;
+    s.count = count;
+    s.dim = dim;
+    s.rows = 3 + 4 * dim;
+    s.cursor = (int32_t *)mem;
+    s.block = (float *)(s.cursor + lanes);
+
+    for(size_t i = 0; i < lanes; i++)
+    {
+        float *b = s.block + (i / CGM_SIMD_WIDTH) * (size_t)s.rows * CGM_SIMD_WIDTH + i % CGM_SIMD_WIDTH;
+        s.cursor[i] = 0;
+        /* empty segment, refreshed on the first sample; padding never is */
+        b[0] = (i < count) ? INFINITY : -INFINITY;
+        b[CGM_SIMD_WIDTH] = INFINITY;
+        for(int r = 2; r < s.rows; r++)
+        {
+            b[r * CGM_SIMD_WIDTH] = 0.0f;
+        }
+    }
+    return s;
+}
+
+/**
+ * @brief samples curves [b, e) of the set, b a multiple of `CGM_SIMD_WIDTH`
+ *
+ * @param times per-curve time, NULL to use t for every curve
+ * @param out SoA, component i of curve k at out[i * count + k]
+ */
+CGMINLINE void gmCurveSetSampleRange(gmCurveSet *s, float t, const float *times, size_t b, size_t e, float *out)
+{
+    size_t count = s->count;
+    int dim = s->dim;
+
+    for(size_t i = b; i < e; i += CGM_SIMD_WIDTH)
+    {
+        const float *blk = s->block + (i / CGM_SIMD_WIDTH) * (size_t)s->rows * CGM_SIMD_WIDTH;
+        size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, e - i);
+        float tt[CGM_SIMD_WIDTH];
+        simdf tv;
+
+        if(times)
+        {
+            for(size_t l = 0; l < CGM_SIMD_WIDTH; l++)
+            {
+                tt[l] = (l < k) ? times[i + l] : 0.0f;
+            }
+            tv = gmSimdload(tt);
+        }
+        else
+        {
+            tv = gmSimdsplat(t);
+        }
+
+        /* lanes outside their cached segment move their cursor */
+        int moved = gmSimdmask(gmSimdor(gmSimdlt(tv, gmSimdload(blk)), gmSimdle(gmSimdload(blk + CGM_SIMD_WIDTH), tv)));
+        moved &= (1 << k) - 1;
+        if(moved)
+        {
+            gmSimdstore(tt, tv);
+            for(size_t l = 0; l < k; l++)
+            {
+                if(moved & (1 << l))
+                {
+                    gmCurveSetRefresh(s, i + l, tt[l]);
+                }
+            }
+        }
+
+        /* held ends have inv == 0 and maybe t0 = -inf, keep their u at 0 */
+        simdf inv = gmSimdload(blk + 2 * CGM_SIMD_WIDTH);
+        simdf u = gmSimdmul(gmSimdsub(tv, gmSimdload(blk)), inv);
+        u = gmSimdselect(gmSimdeq(inv, gmSimdzero()), gmSimdzero(), u);
+        simdf v[4];
+
+        for(int c = 0; c < dim; c++)
+        {
+            const float *p = blk + (3 + 4 * c) * CGM_SIMD_WIDTH;
+            v[c] = gmSimdfma(gmSimdfma(gmSimdfma(gmSimdload(p + 3 * CGM_SIMD_WIDTH), u, gmSimdload(p + 2 * CGM_SIMD_WIDTH)), u,
+                                       gmSimdload(p + CGM_SIMD_WIDTH)), u, gmSimdload(p));
+        }
+        if(dim == CGM_CURVE_QUAT)
+        {
+            simdf n = gmSimdfma(v[0], v[0], gmSimdfma(v[1], v[1], gmSimdfma(v[2], v[2], gmSimdmul(v[3], v[3]))));
+            simdf r = gmSimdrsqrt(n);
+            for(int c = 0; c < 4; c++)
+            {
+                v[c] = gmSimdmul(v[c], r);
+            }
+        }
+
+        for(int c = 0; c < dim; c++)
+        {
+            float *dst = out + (size_t)c * count + i;
+            if(k == CGM_SIMD_WIDTH)
+            {
+                gmSimdstore(dst, v[c]);
+            }
+            else
+            {
+                gmSimdstore(tt, v[c]);
+                for(size_t l = 0; l < k; l++)
+                {
+                    dst[l] = tt[l];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief samples every curve of the set at time t
+ * @param out SoA, `dim` arrays of `count` floats
+ */
+CGMINLINE void gmCurveSetSample(gmCurveSet *s, float t, float *out)
+{
+    gmCurveSetSampleRange(s, t, NULL, 0, s->count, out);
+}
+
+/**
+ * @brief samples curve k of the set at times[k]
+ */
+CGMINLINE void gmCurveSetSampleTimes(gmCurveSet *s, const float *times, float *out)
+{
+    gmCurveSetSampleRange(s, 0.0f, times, 0, s->count, out);
+}
+
+typedef struct
+{
+    gmCurveSet  *s;
+    float        t;
+    const float *times;
+    float       *out;
+} gmCurveJob;
+
+CGMINLINE void gmCurveSetTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmCurveJob *j = (gmCurveJob *)ctx;
+    (void)thread;
+    gmCurveSetSampleRange(j->s, j->t, j->times, b, e, j->out);
+}
+
+/**
+ * @brief `gmCurveSetSample` (times NULL) or `gmCurveSetSampleTimes` split
+ * across the job pool
+ */
+CGMINLINE void gmCurveSetSampleParallel(gmCurveSet *s, float t, const float *times, float *out)
+{
+    gmCurveJob j = {s, t, times, out};
+    gmParallelFor(s->count, CGM_CURVE_GRAIN, gmCurveSetTask, &j);
+}
+
+#endif
@@ -0,0 +1,437 @@
+#ifndef SVD_GRAPHICS_MATH
+#define SVD_GRAPHICS_MATH
+
+/**
+ * @file svd.h
+ * @brief 3x3 singular value and polar decomposition
+ *
+ * follows McAdams et al., "Computing the Singular Value Decomposition of
+ * 3x3 matrices with minimal branching and elementary floating point
+ * operations" (2011):
+ *  1. Jacobi eigen-analysis of AᵀA with approximate Givens rotations,
+ *     a fixed number of sweeps, accumulated as the quaternion of V
+ *  2. B = AV, columns sorted by decreasing norm (V updated to match)
+ *  3. QR of B by three Givens rotations: U = Q (as a quaternion), Σ = diag(R)
+ *
+ * A = U diag(Σ) Vᵀ with U and V proper rotations, so for det(A) < 0 the
+ * smallest singular value comes out negative. every step is straight-line
+ * code with selects instead of branches: one matrix per SIMD lane,
+ * `CGM_SIMD_WIDTH` matrices per pass.
+ *
+ * macros:
+ *  `CGM_SVD_SWEEPS`: Jacobi sweeps (3 rotations each), default 6.
+ *
+ * accuracy, as relative reconstruction error |A - U Σ Vᵀ| / |A| over 10^6
+ * random matrices: with 6 sweeps ~3e-7 on average and below 2e-6 for
+ * well-conditioned inputs. 4 sweeps (the paper's count) leave ~1e-2 and 5
+ * leave ~1e-3 in rare cases. nearly rank-deficient inputs
+ * (σ_min / σ_max below ~1e-3) can reach ~1e-4 whatever the sweep count:
+ * AᵀA squares the condition number, so σ_min is only resolved to about
+ * sqrt(float epsilon) * σ_max.
+ */
+
+#include "../core.h"
+#include "../ugm/ugm.h"
+#include "../vec3.h"
+#include "../vec4.h"
+#include "../mat3.h"
+#include "../quat.h"
+#include "../sgm/simd.h"
+#include <stddef.h>
+
+#ifndef CGM_SVD_SWEEPS
+#define CGM_SVD_SWEEPS 6
+#endif
+
+#define CGM_SVD_GAMMA   5.828427124746190f /* 3 + 2 sqrt(2) */
+#define CGM_SVD_CSTAR   0.923879532511287f /* cos(pi / 8) */
+#define CGM_SVD_SSTAR   0.382683432365090f /* sin(pi / 8) */
+#define CGM_SVD_EPSILON 1e-6f
+
+/* -------------------------------------------------------------------------- */
+/* lane kernels                                                                */
+/* -------------------------------------------------------------------------- */
+
+/* q = q * r, quaternions as x, y, z, w lanes */
+CGMINLINE void gmSvdQuatmul(simdf *q, const simdf *r)
+{
+    simdf x = gmSimdadd(gmSimdadd(gmSimdmul(q[3], r[0]), gmSimdmul(q[0], r[3])),
+                        gmSimdsub(gmSimdmul(q[1], r[2]), gmSimdmul(q[2], r[1])));
+    simdf y = gmSimdadd(gmSimdsub(gmSimdmul(q[3], r[1]), gmSimdmul(q[0], r[2])),
+                        gmSimdadd(gmSimdmul(q[1], r[3]), gmSimdmul(q[2], r[0])));
+    simdf z = gmSimdadd(gmSimdadd(gmSimdmul(q[3], r[2]), gmSimdmul(q[0], r[1])),
+                        gmSimdsub(gmSimdmul(q[2], r[3]), gmSimdmul(q[1], r[0])));
+    simdf w = gmSimdsub(gmSimdsub(gmSimdmul(q[3], r[3]), gmSimdmul(q[0], r[0])),
+                        gmSimdadd(gmSimdmul(q[1], r[1]), gmSimdmul(q[2], r[2])));
+    q[0] = x;
+    q[1] = y;
+    q[2] = z;
+    q[3] = w;
+}
+
+/* rotation matrix m[row][col] of a unit quaternion */
+CGMINLINE void gmSvdQuattoMat(const simdf *q, simdf m[3][3])
+{
+    simdf one = gmSimdsplat(1.0f), two = gmSimdsplat(2.0f);
+    simdf xx = gmSimdmul(q[0], q[0]), yy = gmSimdmul(q[1], q[1]), zz = gmSimdmul(q[2], q[2]);
+    simdf xy = gmSimdmul(q[0], q[1]), xz = gmSimdmul(q[0], q[2]), yz = gmSimdmul(q[1], q[2]);
+    simdf wx = gmSimdmul(q[3], q[0]), wy = gmSimdmul(q[3], q[1]), wz = gmSimdmul(q[3], q[2]);
+
+    m[0][0] = gmSimdsub(one, gmSimdmul(two, gmSimdadd(yy, zz)));
+    m[0][1] = gmSimdmul(two, gmSimdsub(xy, wz));
+    m[0][2] = gmSimdmul(two, gmSimdadd(xz, wy));
+    m[1][0] = gmSimdmul(two, gmSimdadd(xy, wz));
+    m[1][1] = gmSimdsub(one, gmSimdmul(two, gmSimdadd(xx, zz)));
+    m[1][2] = gmSimdmul(two, gmSimdsub(yz, wx));
+    m[2][0] = gmSimdmul(two, gmSimdsub(xz, wy));
+    m[2][1] = gmSimdmul(two, gmSimdadd(yz, wx));
+    m[2][2] = gmSimdsub(one, gmSimdmul(two, gmSimdadd(xx, yy)));
+}
+
+/*
+ * one Jacobi rotation on the symmetric matrix (s11, s21, s22, s31, s32, s33)
+ * eliminating s21, accumulated into q about z. then both are relabelled
+ * cyclically so the next call works on the next (p, q) pair; three calls
+ * bring the labels back.
+ */
+CGMINLINE void gmSvdJacobi(simdf *s, simdf *q)
+{
+    simdf two = gmSimdsplat(2.0f);
+    simdf ch = gmSimdmul(two, gmSimdsub(s[0], s[2]));
+    simdf sh = s[1];
+
+    /* approximate Givens angle, falls back to pi / 8 when it overshoots */
+    simdf ok = gmSimdlt(gmSimdmul(gmSimdsplat(CGM_SVD_GAMMA), gmSimdmul(sh, sh)), gmSimdmul(ch, ch));
+    simdf w = gmSimdrsqrt(gmSimdfma(ch, ch, gmSimdmul(sh, sh)));
+    ch = gmSimdselect(ok, gmSimdmul(w, ch), gmSimdsplat(CGM_SVD_CSTAR));
+    sh = gmSimdselect(ok, gmSimdmul(w, sh), gmSimdsplat(CGM_SVD_SSTAR));
+
+    simdf a = gmSimdsub(gmSimdmul(ch, ch), gmSimdmul(sh, sh));
+    simdf b = gmSimdmul(two, gmSimdmul(sh, ch));
+
+    simdf s11 = s[0], s21 = s[1], s22 = s[2], s31 = s[3], s32 = s[4], s33 = s[5];
+    simdf t0 = gmSimdfma(a, s11, gmSimdmul(b, s21));
+    simdf t1 = gmSimdfma(a, s21, gmSimdmul(b, s22));
+    simdf t2 = gmSimdsub(gmSimdmul(a, s21), gmSimdmul(b, s11));
+    simdf t3 = gmSimdsub(gmSimdmul(a, s22), gmSimdmul(b, s21));
+
+    s[0] = gmSimdsub(gmSimdmul(a, t3), gmSimdmul(b, t2));
+    s[1] = gmSimdsub(gmSimdmul(a, s32), gmSimdmul(b, s31));
+    s[2] = s33;
+    s[3] = gmSimdfma(a, t2, gmSimdmul(b, t3));
+    s[4] = gmSimdfma(a, s31, gmSimdmul(b, s32));
+    s[5] = gmSimdfma(a, t0, gmSimdmul(b, t1));
+
+    /* q = q * (sh on z, ch), stored as (y, z, x, w) */
+    simdf x = q[0], y = q[1], z = q[2], qw = q[3];
+    q[0] = gmSimdsub(gmSimdmul(y, ch), gmSimdmul(x, sh));
+    q[1] = gmSimdfma(z, ch, gmSimdmul(qw, sh));
+    q[2] = gmSimdfma(x, ch, gmSimdmul(y, sh));
+    q[3] = gmSimdsub(gmSimdmul(qw, ch), gmSimdmul(z, sh));
+}
+
+/* swaps columns i and j of b, negating the new column j */
+CGMINLINE void gmSvdSwapCols(simdf c, simdf b[3][3], int i, int j)
+{
+    for(int r = 0; r < 3; r++)
+    {
+        simdf x = b[r][i], y = b[r][j];
+        b[r][i] = gmSimdselect(c, y, x);
+        b[r][j] = gmSimdselect(c, gmSimdsub(gmSimdzero(), x), y);
+    }
+}
+
+/* Givens quaternion (ch, sh) zeroing a2 below the pivot a1 */
+CGMINLINE void gmSvdGivensQR(simdf a1, simdf a2, simdf *ch, simdf *sh)
+{
+    simdf eps = gmSimdsplat(CGM_SVD_EPSILON);
+    simdf rho = gmSimdsqrt(gmSimdfma(a1, a1, gmSimdmul(a2, a2)));
+    simdf s = gmSimdand(gmSimdlt(eps, rho), a2);
+    simdf c = gmSimdadd(gmSimdabs(a1), gmSimdmax(rho, eps));
+    simdf neg = gmSimdlt(a1, gmSimdzero());
+    simdf cs = gmSimdselect(neg, s, c);
+    simdf ss = gmSimdselect(neg, c, s);
+    simdf w = gmSimddiv(gmSimdsplat(1.0f), gmSimdsqrt(gmSimdfma(cs, cs, gmSimdmul(ss, ss))));
+    *ch = gmSimdmul(cs, w);
+    *sh = gmSimdmul(ss, w);
+}
+
+/* rows i, j of b = G' b for the Givens (ch, sh) */
+CGMINLINE void gmSvdApplyRows(simdf b[3][3], int i, int j, simdf ch, simdf sh)
+{
+    simdf a = gmSimdsub(gmSimdsplat(1.0f), gmSimdmul(gmSimdsplat(2.0f), gmSimdmul(sh, sh)));
+    simdf s = gmSimdmul(gmSimdsplat(2.0f), gmSimdmul(ch, sh));
+    for(int c = 0; c < 3; c++)
+    {
+        simdf x = b[i][c], y = b[j][c];
+        b[i][c] = gmSimdfma(a, x, gmSimdmul(s, y));
+        b[j][c] = gmSimdsub(gmSimdmul(a, y), gmSimdmul(s, x));
+    }
+}
+
+/**
+ * @brief SVD of `CGM_SIMD_WIDTH` matrices, one per lane
+ *
+ * @param a input a[row][col]
+ * @param u, v rotations as quaternion lanes (x, y, z, w)
+ * @param s singular values, decreasing (the last one may be negative)
+ */
+CGMINLINE void gmMat3svdLanes(simdf a[3][3], simdf *u, simdf *s, simdf *v)
+{
+    simdf zero = gmSimdzero(), one = gmSimdsplat(1.0f);
+    simdf h = gmSimdsplat(CGM_INV_SQRT2);
+    simdf m[6], b[3][3], vm[3][3];
+
+    /* AᵀA, lower triangle: s11 s21 s22 s31 s32 s33 */
+    simdf ata[3][3];
+    for(int i = 0; i < 3; i++)
+    {
+        for(int j = 0; j <= i; j++)
+        {
+            ata[i][j] = gmSimdmul(a[0][i], a[0][j]);
+            ata[i][j] = gmSimdfma(a[1][i], a[1][j], ata[i][j]);
+            ata[i][j] = gmSimdfma(a[2][i], a[2][j], ata[i][j]);
+        }
+    }
+    m[0] = ata[0][0];
+    m[1] = ata[1][0];
+    m[2] = ata[1][1];
+    m[3] = ata[2][0];
+    m[4] = ata[2][1];
+    m[5] = ata[2][2];
+
+    v[0] = v[1] = v[2] = zero;
+    v[3] = one;
+    for(int i = 0; i < 3 * CGM_SVD_SWEEPS; i++)
+    {
+        gmSvdJacobi(m, v);
+    }
+
+    simdf ql = gmSimdsqrt(gmSimdadd(gmSimdadd(gmSimdmul(v[0], v[0]), gmSimdmul(v[1], v[1])),
+                                    gmSimdadd(gmSimdmul(v[2], v[2]), gmSimdmul(v[3], v[3]))));
+    for(int i = 0; i < 4; i++)
+    {
+        v[i] = gmSimddiv(v[i], ql);
+    }
+
+    /* B = AV */
+    gmSvdQuattoMat(v, vm);
+    for(int r = 0; r < 3; r++)
+    {
+        for(int c = 0; c < 3; c++)
+        {
+            b[r][c] = gmSimdmul(a[r][0], vm[0][c]);
+            b[r][c] = gmSimdfma(a[r][1], vm[1][c], b[r][c]);
+            b[r][c] = gmSimdfma(a[r][2], vm[2][c], b[r][c]);
+        }
+    }
+
+    /* sort columns by norm, each swap is V times a 90 degree rotation */
+    simdf rho[3];
+    for(int c = 0; c < 3; c++)
+    {
+        rho[c] = gmSimdmul(b[0][c], b[0][c]);
+        rho[c] = gmSimdfma(b[1][c], b[1][c], rho[c]);
+        rho[c] = gmSimdfma(b[2][c], b[2][c], rho[c]);
+    }
+
+    static const int pair[3][3] = {{0, 1, 2}, {0, 2, 1}, {1, 2, 0}};
+    for(int k = 0; k < 3; k++)
+    {
+        int i = pair[k][0], j = pair[k][1], axis = pair[k][2];
+        simdf c = gmSimdlt(rho[i], rho[j]);
+        simdf r[4];
+        simdf t = rho[i];
+
+        rho[i] = gmSimdselect(c, rho[j], rho[i]);
+        rho[j] = gmSimdselect(c, t, rho[j]);
+        gmSvdSwapCols(c, b, i, j);
+
+        /* +90 about z for (0,1), -90 about y for (0,2), +90 about x for (1,2) */
+        r[0] = r[1] = r[2] = zero;
+        r[axis] = gmSimdand(c, (axis == 1) ? gmSimdsub(zero, h) : h);
+        r[3] = gmSimdselect(c, h, one);
+        gmSvdQuatmul(v, r);
+    }
+
+    /* QR: Q = G1 G2 G3 */
+    simdf c1, s1, c2, s2, c3, s3;
+    gmSvdGivensQR(b[0][0], b[1][0], &c1, &s1);
+    gmSvdApplyRows(b, 0, 1, c1, s1);
+    gmSvdGivensQR(b[0][0], b[2][0], &c2, &s2);
+    gmSvdApplyRows(b, 0, 2, c2, s2);
+    gmSvdGivensQR(b[1][1], b[2][1], &c3, &s3);
+    gmSvdApplyRows(b, 1, 2, c3, s3);
+
+    s[0] = b[0][0];
+    s[1] = b[1][1];
+    s[2] = b[2][2];
+
+    /* G1 about z, G2 about -y, G3 about x */
+    simdf g[4];
+    u[0] = zero;
+    u[1] = zero;
+    u[2] = s1;
+    u[3] = c1;
+    g[0] = zero;
+    g[1] = gmSimdsub(zero, s2);
+    g[2] = zero;
+    g[3] = c2;
+    gmSvdQuatmul(u, g);
+    g[0] = s3;
+    g[1] = zero;
+    g[3] = c3;
+    gmSvdQuatmul(u, g);
+}
+
+/* -------------------------------------------------------------------------- */
+/* AoS entry points                                                            */
+/* -------------------------------------------------------------------------- */
+
+/* loads up to CGM_SIMD_WIDTH matrices, missing lanes are identity */
+CGMINLINE void gmSvdLoad(const mat3 *m, size_t n, simdf a[3][3])
+{
+    float t[9][CGM_SIMD_WIDTH];
+    for(int k = 0; k < 9; k++)
+    {
+        for(size_t l = 0; l < CGM_SIMD_WIDTH; l++)
+        {
+            t[k][l] = (l < n) ? m[l].m[k] : (k % 4 == 0) ? 1.0f : 0.0f;
+        }
+    }
+    /* column major: m[col * 3 + row] */
+    for(int c = 0; c < 3; c++)
+    {
+        for(int r = 0; r < 3; r++)
+        {
+            a[r][c] = gmSimdload(t[c * 3 + r]);
+        }
+    }
+}
+
+CGMINLINE void gmSvdStoreQuat(const simdf *q, size_t n, quat *out)
+{
+    float t[4][CGM_SIMD_WIDTH];
+    for(int k = 0; k < 4; k++)
+    {
+        gmSimdstore(t[k], q[k]);
+    }
+    for(size_t l = 0; l < n; l++)
+    {
+        out[l] = gmQuat(t[0][l], t[1][l], t[2][l], t[3][l]);
+    }
+}
+
+/**
+ * @brief A = U diag(s) Vᵀ for n matrices
+ *
+ * @param u, v rotations (may be NULL)
+ * @param s singular values, decreasing; the last is negative when det(A) < 0
+ * (may be NULL)
+ */
+CGMINLINE void gmMat3svdBatch(const mat3 *a, size_t n, quat *u, vec3 *s, quat *v)
+{
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, n - i);
+        simdf m[3][3], qu[4], sv[3], qv[4];
+
+        gmSvdLoad(a + i, k, m);
+        gmMat3svdLanes(m, qu, sv, qv);
+
+        if(u)
+        {
+            gmSvdStoreQuat(qu, k, u + i);
+        }
+        if(v)
+        {
+            gmSvdStoreQuat(qv, k, v + i);
+        }
+        if(s)
+        {
+            float t[3][CGM_SIMD_WIDTH];
+            for(int c = 0; c < 3; c++)
+            {
+                gmSimdstore(t[c], sv[c]);
+            }
+            for(size_t l = 0; l < k; l++)
+            {
+                s[i + l] = gmVec3(t[0][l], t[1][l], t[2][l]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief A = U diag(s) Vᵀ
+ */
+CGMINLINE void gmMat3svd(mat3 a, quat *u, vec3 *s, quat *v)
+{
+    gmMat3svdBatch(&a, 1, u, s, v);
+}
+
+/**
+ * @brief polar decomposition A = R S for n matrices
+ *
+ * R = U Vᵀ is the closest rotation to A (shape matching, co-rotational
+ * FEM), S = V diag(s) Vᵀ the symmetric stretch.
+ *
+ * @param r rotations (may be NULL)
+ * @param st stretch matrices (may be NULL)
+ */
+CGMINLINE void gmMat3polarBatch(const mat3 *a, size_t n, quat *r, mat3 *st)
+{
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, n - i);
+        simdf m[3][3], qu[4], sv[3], qv[4];
+
+        gmSvdLoad(a + i, k, m);
+        gmMat3svdLanes(m, qu, sv, qv);
+
+        if(r)
+        {
+            /* U * conj(V) */
+            simdf c[4];
+            c[0] = gmSimdsub(gmSimdzero(), qv[0]);
+            c[1] = gmSimdsub(gmSimdzero(), qv[1]);
+            c[2] = gmSimdsub(gmSimdzero(), qv[2]);
+            c[3] = qv[3];
+            gmSvdQuatmul(qu, c);
+            gmSvdStoreQuat(qu, k, r + i);
+        }
+        if(st)
+        {
+            simdf vm[3][3];
+            float t[9][CGM_SIMD_WIDTH];
+            gmSvdQuattoMat(qv, vm);
+            for(int x = 0; x < 3; x++)
+            {
+                for(int y = 0; y < 3; y++)
+                {
+                    simdf e = gmSimdmul(gmSimdmul(vm[x][0], sv[0]), vm[y][0]);
+                    e = gmSimdfma(gmSimdmul(vm[x][1], sv[1]), vm[y][1], e);
+                    e = gmSimdfma(gmSimdmul(vm[x][2], sv[2]), vm[y][2], e);
+                    gmSimdstore(t[y * 3 + x], e);
+                }
+            }
+            for(size_t l = 0; l < k; l++)
+            {
+                for(int e = 0; e < 9; e++)
+                {
+                    st[i + l].m[e] = t[e][l];
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief polar decomposition A = R S
+ */
+CGMINLINE void gmMat3polar(mat3 a, quat *r, mat3 *st)
+{
+    gmMat3polarBatch(&a, 1, r, st);
+}
+
+#endif
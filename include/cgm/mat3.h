@@ -0,0 +1,200 @@
+#ifndef CGM_MAT3_H
+#define CGM_MAT3_H
+
+/**
+ * @file mat3.h
+ * 3x3 matrices (column major), mainly used for rotations and normal matrices
+ */
+
+#include "core.h"
+#include "ugm/ugm.h"
+#include "structs/stcmat3.h"
+#include "vec3.h"
+#include "vec4.h"
+#include "mat4.h"
+#include "quat.h"
+
+#define CGM_MAT3_INIT ((mat3){0})
+
+/**
+ * @brief create an identity matrix
+ */
+CGMINLINE mat3 gmMat3identity(void)
+{
+    mat3 m = CGM_MAT3_INIT;
+    m.m[0] = 1.0f;
+    m.m[4] = 1.0f;
+    m.m[8] = 1.0f;
+    return m;
+}
+
+/**
+ * @brief build a mat3 from three column vectors
+ */
+CGMINLINE mat3 gmMat3fromCols(vec3 c0, vec3 c1, vec3 c2)
+{
+    return (mat3){{
+        c0.x, c0.y, c0.z,
+        c1.x, c1.y, c1.z,
+        c2.x, c2.y, c2.z
+    }};
+}
+
+/**
+ * @brief column i of the matrix
+ */
+CGMINLINE vec3 gmMat3col(mat3 m, int i)
+{
+    return gmVec3(m.m[i * 3 + 0], m.m[i * 3 + 1], m.m[i * 3 + 2]);
+}
+
+/**
+ * @brief upper-left 3x3 block of a mat4
+ */
+CGMINLINE mat3 gmMat3fromMat4(mat4 m)
+{
+    return (mat3){{
+        m.m[0], m.m[1], m.m[2],
+        m.m[4], m.m[5], m.m[6],
+        m.m[8], m.m[9], m.m[10]
+    }};
+}
+
+/**
+ * @brief rotation matrix from a unit quaternion
+ */
+CGMINLINE mat3 gmMat3fromQuat(quat q)
+{
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    return (mat3){{
+        1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz),        2.0f * (xz - wy),
+        2.0f * (xy - wz),        1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx),
+        2.0f * (xz + wy),        2.0f * (yz - wx),        1.0f - 2.0f * (xx + yy)
+    }};
+}
+
+/**
+ * @brief multiplication of two mat3 (m0 * m1)
+ */
+CGMINLINE mat3 gmMat3mul(mat3 m0, mat3 m1)
+{
+    mat3 m = CGM_MAT3_INIT;
+    for(int c0 = 0; c0 < 3; c0++)
+    {
+        for(int r0 = 0; r0 < 3; r0++)
+        {
+            m.m[c0 * 3 + r0] =
+                m0.m[0 * 3 + r0] * m1.m[c0 * 3 + 0] +
+                m0.m[1 * 3 + r0] * m1.m[c0 * 3 + 1] +
+                m0.m[2 * 3 + r0] * m1.m[c0 * 3 + 2];
+        }
+    }
+    return m;
+}
+
+/**
+ * @brief mat3 x vec3
+ */
+CGMINLINE vec3 gmMat3mulVec3(mat3 m, vec3 v)
+{
+    return gmVec3(
+        m.m[0] * v.x + m.m[3] * v.y + m.m[6] * v.z,
+        m.m[1] * v.x + m.m[4] * v.y + m.m[7] * v.z,
+        m.m[2] * v.x + m.m[5] * v.y + m.m[8] * v.z
+    );
+}
+
+/**
+ * @brief transpose of a mat3
+ */
+CGMINLINE mat3 gmMat3transpose(mat3 m)
+{
+    return (mat3){{
+        m.m[0], m.m[3], m.m[6],
+        m.m[1], m.m[4], m.m[7],
+        m.m[2], m.m[5], m.m[8]
+    }};
+}
+
+/**
+ * @brief determinant of a mat3
+ * 
+ * triple product of the columns: c0 . (c1 x c2)
+ */
+CGMINLINE float gmMat3determinant(mat3 m)
+{
+    return gmVec3dot(gmMat3col(m, 0), gmVec3cross(gmMat3col(m, 1), gmMat3col(m, 2)));
+}
+
+/**
+ * @brief cofactor matrix of a mat3 (transpose of the adjugate)
+ * 
+ * the columns are c1 x c2, c2 x c0 and c0 x c1.
+ */
+CGMINLINE mat3 gmMat3cofactor(mat3 m)
+{
+    vec3 c0 = gmMat3col(m, 0);
+    vec3 c1 = gmMat3col(m, 1);
+    vec3 c2 = gmMat3col(m, 2);
+    return gmMat3fromCols(gmVec3cross(c1, c2), gmVec3cross(c2, c0), gmVec3cross(c0, c1));
+}
+
+/**
+ * @brief mat3 inverse
+ * 
+ * @return inverse, or a zero matrix if the matrix is singular
+ */
+CGMINLINE mat3 gmMat3inverse(mat3 m)
+{
+    mat3 c = gmMat3cofactor(m);
+    float dt = m.m[0] * c.m[0] + m.m[1] * c.m[1] + m.m[2] * c.m[2];
+
+    if(dt == 0.0f)
+    {
+        return CGM_MAT3_INIT;
+    }
+
+    float Inverse = 1.0f / dt;
+    mat3 r = gmMat3transpose(c);
+    for(int i = 0; i < 9; i++)
+    {
+        r.m[i] *= Inverse;
+    }
+    return r;
+}
+
+/**
+ * @brief normal matrix of a model matrix
+ * 
+ * inverse-transpose of the upper 3x3 block, computed directly as
+ * cofactor / determinant (three cross products and one dot) instead of
+ * `gmMat4inverse` followed by a transpose.
+ * 
+ * @return normal matrix, or a zero matrix if the block is singular
+ */
+CGMINLINE mat3 gmMat4normalMatrix(mat4 m)
+{
+    vec3 c0 = gmVec3(m.m[0], m.m[1], m.m[2]);
+    vec3 c1 = gmVec3(m.m[4], m.m[5], m.m[6]);
+    vec3 c2 = gmVec3(m.m[8], m.m[9], m.m[10]);
+
+    vec3 x = gmVec3cross(c1, c2);
+    float dt = gmVec3dot(c0, x);
+
+    if(dt == 0.0f)
+    {
+        return CGM_MAT3_INIT;
+    }
+
+    float Inverse = 1.0f / dt;
+    return gmMat3fromCols(
+        gmVec3mulScale(x, Inverse),
+        gmVec3mulScale(gmVec3cross(c2, c0), Inverse),
+        gmVec3mulScale(gmVec3cross(c0, c1), Inverse)
+    );
+}
+
+#endif
@@ -0,0 +1,374 @@
+#ifndef NOISE_GRAPHICS_MATH
+#define NOISE_GRAPHICS_MATH
+
+/**
+ * @file noise.h
+ * @brief 2D gradient noise with analytic derivatives
+ *
+ * the noise is the Perlin variant of src/test.c: lattice gradients at
+ * angle gmHash(x, y) * 2pi, blended with `gmFade`. writing the blend as
+ *
+ *     n = k0 + k1 u + k2 v + k3 u v,    (u, v) = fade(f)
+ *
+ * gives the gradient in the same evaluation through `gmFadeDerivative`,
+ * so a terrain normal costs one sample instead of three for central
+ * differences.
+ *
+ * value-and-gradient results are packed as vec3 (n, dn/dx, dn/dy).
+ *
+ * the batch kernels evaluate `CGM_SIMD_WIDTH` samples per step with a
+ * polynomial sin/cos for the gradient angle, they agree with the scalar
+ * functions (libm cosf / sinf) to ~1e-6.
+ */
+
+#include "../core.h"
+#include "../ugm/ugm.h"
+#include "../ugm/stream.h"
+#include "../vec2.h"
+#include "../vec3.h"
+#include "../sgm/simd.h"
+#include "../jgm/job.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef CGM_NOISE_GRAIN
+#define CGM_NOISE_GRAIN 4096 /* samples per parallel chunk */
+#endif
+
+/**
+ * @brief lattice hash in [0, 1]
+ */
+CGMINLINE float gmHash(int x, int y)
+{
+    uint32_t h = (uint32_t)x * 374761393u + (uint32_t)y * 668265263u;
+    h = (h ^ (uint32_t)((int32_t)h >> 13)) * 1274126177u;
+    return (float)(int32_t)(h & 0x7fffffffu) / 2147483647.0f;
+}
+
+/**
+ * @brief dot of the lattice gradient at `grid` with `offset`
+ */
+CGMINLINE float gmGrad(vec2 grid, vec2 offset)
+{
+    float angle = gmHash((int)grid.x, (int)grid.y) * 6.2831853f;
+    vec2 g = gmVec2(cosf(angle), sinf(angle));
+    return gmVec2dot(g, offset);
+}
+
+/* unit gradient of lattice point (x, y) */
+CGMINLINE vec2 gmGradVec(int x, int y)
+{
+    float angle = gmHash(x, y) * 6.2831853f;
+    return gmVec2(cosf(angle), sinf(angle));
+}
+
+/* -------------------------------------------------------------------------- */
+/* scalar                                                                      */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief gradient noise, roughly in [-0.7, 0.7]
+ */
+CGMINLINE float gmNoise2d(vec2 p)
+{
+    vec2 i = gmVec2floor(p);
+    vec2 f = gmVec2sub(p, i);
+    vec2 u = gmVec2fade(f);
+
+    float n00 = gmGrad(i, f);
+    float n10 = gmGrad(gmVec2add(i, gmVec2(1.0f, 0.0f)), gmVec2sub(f, gmVec2(1.0f, 0.0f)));
+    float n01 = gmGrad(gmVec2add(i, gmVec2(0.0f, 1.0f)), gmVec2sub(f, gmVec2(0.0f, 1.0f)));
+    float n11 = gmGrad(gmVec2add(i, gmVec2(1.0f, 1.0f)), gmVec2sub(f, gmVec2(1.0f, 1.0f)));
+
+    float nx0 = n00 + u.x * (n10 - n00);
+    float nx1 = n01 + u.x * (n11 - n01);
+    return nx0 + u.y * (nx1 - nx0);
+}
+
+/**
+ * @brief gradient noise and its derivatives
+ * @return (n, dn/dx, dn/dy), n equal to `gmNoise2d` up to rounding
+ */
+CGMINLINE vec3 gmNoise2dGrad(vec2 p)
+{
+    vec2 i = gmVec2floor(p);
+    vec2 f = gmVec2sub(p, i);
+    int x = (int)i.x, y = (int)i.y;
+    float u = gmFade(f.x), v = gmFade(f.y);
+    float du = gmFadeDerivative(f.x), dv = gmFadeDerivative(f.y);
+
+    vec2 g00 = gmGradVec(x, y);
+    vec2 g10 = gmGradVec(x + 1, y);
+    vec2 g01 = gmGradVec(x, y + 1);
+    vec2 g11 = gmGradVec(x + 1, y + 1);
+
+    float n00 = g00.x * f.x + g00.y * f.y;
+    float n10 = g10.x * (f.x - 1.0f) + g10.y * f.y;
+    float n01 = g01.x * f.x + g01.y * (f.y - 1.0f);
+    float n11 = g11.x * (f.x - 1.0f) + g11.y * (f.y - 1.0f);
+
+    float k1 = n10 - n00, k2 = n01 - n00, k3 = n00 - n10 - n01 + n11;
+    vec2 h1 = gmVec2sub(g10, g00), h2 = gmVec2sub(g01, g00);
+    vec2 h3 = gmVec2add(gmVec2sub(g00, g10), gmVec2sub(g11, g01));
+
+    float n = n00 + u * k1 + v * k2 + u * v * k3;
+    float dx = g00.x + u * h1.x + v * h2.x + u * v * h3.x + du * (k1 + k3 * v);
+    float dy = g00.y + u * h1.y + v * h2.y + u * v * h3.y + dv * (k2 + k3 * u);
+    return gmVec3(n, dx, dy);
+}
+
+/**
+ * @brief fractal sum of `gmNoise2dGrad` with accumulated derivatives
+ *
+ * octave k samples p * lacunarity^k with weight gain^k; its gradient is
+ * scaled by both, so the result is the exact gradient of the sum.
+ */
+CGMINLINE vec3 gmFbm2dGrad(vec2 p, int octaves, float lacunarity, float gain)
+{
+    vec3 r = gmVec3(0.0f, 0.0f, 0.0f);
+    float amp = 1.0f, freq = 1.0f;
+
+    for(int o = 0; o < octaves; o++)
+    {
+        vec3 n = gmNoise2dGrad(gmVec2mulScale(p, freq));
+        r.x += amp * n.x;
+        r.y += amp * freq * n.y;
+        r.z += amp * freq * n.z;
+        amp *= gain;
+        freq *= lacunarity;
+    }
+    return r;
+}
+
+/**
+ * @brief unit normal of the height field y = scale * n(x, z)
+ * @param ng (n, dn/dx, dn/dz) from `gmNoise2dGrad` / `gmFbm2dGrad`
+ */
+CGMINLINE vec3 gmNoiseHeightNormal(vec3 ng, float scale)
+{
+    return gmVec3normalize(gmVec3(-scale * ng.y, 1.0f, -scale * ng.z));
+}
+
+/* -------------------------------------------------------------------------- */
+/* lanes                                                                       */
+/* -------------------------------------------------------------------------- */
+
+/* gmHash per lane */
+CGMINLINE simdf gmHashLanes(simdi x, simdi y)
+{
+    simdi h = gmSimdiadd(gmSimdimul(x, gmSimdisplat(374761393)), gmSimdimul(y, gmSimdisplat(668265263)));
+    h = gmSimdimul(gmSimdixor(h, gmSimdisra(h, 13)), gmSimdisplat(1274126177));
+    h = gmSimdiand(h, gmSimdisplat(0x7fffffff));
+    return gmSimddiv(gmSimditof(h), gmSimdsplat(2147483647.0f));
+}
+
+/*
+ * sin and cos of a in [0, 2pi]: quadrant reduction to [-pi/4, pi/4] and
+ * the minimax polynomials of cephes sinf / cosf (error ~1e-7)
+ */
+CGMINLINE void gmSincosLanes(simdf a, simdf *s, simdf *c)
+{
+    simdi q = gmSimdiround(gmSimdmul(a, gmSimdsplat(0.636619772f)));
+    simdf qf = gmSimditof(q);
+    simdf r = gmSimdfma(qf, gmSimdsplat(-1.5703125f), a);
+    r = gmSimdfma(qf, gmSimdsplat(-4.837512969970703125e-4f), r);
+    r = gmSimdfma(qf, gmSimdsplat(-7.54978995489188216e-8f), r);
+    simdf r2 = gmSimdmul(r, r);
+
+    simdf ps = gmSimdfma(r2, gmSimdsplat(-1.9515295891e-4f), gmSimdsplat(8.3321608736e-3f));
+    ps = gmSimdfma(r2, ps, gmSimdsplat(-1.6666654611e-1f));
+    ps = gmSimdfma(gmSimdmul(r2, r), ps, r);
+
+    simdf pc = gmSimdfma(r2, gmSimdsplat(2.443315711809948e-5f), gmSimdsplat(-1.388731625493765e-3f));
+    pc = gmSimdfma(r2, pc, gmSimdsplat(4.166664568298827e-2f));
+    pc = gmSimdfma(r2, pc, gmSimdsplat(-0.5f));
+    pc = gmSimdfma(r2, pc, gmSimdsplat(1.0f));
+
+    /* quadrant q: (sin, cos) = (ps, pc), (pc, -ps), (-ps, -pc), (-pc, ps) */
+    simdf swap = gmSimdasf(gmSimdieq(gmSimdiand(q, gmSimdisplat(1)), gmSimdisplat(1)));
+    simdf ns = gmSimdasf(gmSimdisll(gmSimdiand(q, gmSimdisplat(2)), 30));
+    simdf nc = gmSimdasf(gmSimdisll(gmSimdiand(gmSimdiadd(q, gmSimdisplat(1)), gmSimdisplat(2)), 30));
+    *s = gmSimdxor(gmSimdselect(swap, pc, ps), ns);
+    *c = gmSimdxor(gmSimdselect(swap, ps, pc), nc);
+}
+
+/* gmNoise2dGrad per lane */
+CGMINLINE void gmNoise2dGradLanes(simdf px, simdf py, simdf *n, simdf *dx, simdf *dy)
+{
+    simdf one = gmSimdsplat(1.0f), tau = gmSimdsplat(6.2831853f);
+    simdf ix = gmSimdfloor(px), iy = gmSimdfloor(py);
+    simdf fx = gmSimdsub(px, ix), fy = gmSimdsub(py, iy);
+    simdf gx = gmSimdsub(fx, one), gy = gmSimdsub(fy, one);
+    simdi x0 = gmSimditrunc(ix), y0 = gmSimditrunc(iy);
+    simdi x1 = gmSimdiadd(x0, gmSimdisplat(1)), y1 = gmSimdiadd(y0, gmSimdisplat(1));
+
+    simdf c00, s00, c10, s10, c01, s01, c11, s11;
+    gmSincosLanes(gmSimdmul(gmHashLanes(x0, y0), tau), &s00, &c00);
+    gmSincosLanes(gmSimdmul(gmHashLanes(x1, y0), tau), &s10, &c10);
+    gmSincosLanes(gmSimdmul(gmHashLanes(x0, y1), tau), &s01, &c01);
+    gmSincosLanes(gmSimdmul(gmHashLanes(x1, y1), tau), &s11, &c11);
+
+    simdf n00 = gmSimdfma(c00, fx, gmSimdmul(s00, fy));
+    simdf n10 = gmSimdfma(c10, gx, gmSimdmul(s10, fy));
+    simdf n01 = gmSimdfma(c01, fx, gmSimdmul(s01, gy));
+    simdf n11 = gmSimdfma(c11, gx, gmSimdmul(s11, gy));
+
+    simdf u = gmFadeLanes(fx), v = gmFadeLanes(fy);
+    simdf du = gmFadeDerivativeLanes(fx), dv = gmFadeDerivativeLanes(fy);
+    simdf uv = gmSimdmul(u, v);
+
+    simdf k1 = gmSimdsub(n10, n00), k2 = gmSimdsub(n01, n00);
+    simdf k3 = gmSimdsub(gmSimdsub(n11, n10), k2);
+    simdf h1x = gmSimdsub(c10, c00), h2x = gmSimdsub(c01, c00);
+    simdf h3x = gmSimdsub(gmSimdsub(c11, c10), h2x);
+    simdf h1y = gmSimdsub(s10, s00), h2y = gmSimdsub(s01, s00);
+    simdf h3y = gmSimdsub(gmSimdsub(s11, s10), h2y);
+
+    *n = gmSimdfma(uv, k3, gmSimdfma(v, k2, gmSimdfma(u, k1, n00)));
+    *dx = gmSimdfma(uv, h3x, gmSimdfma(v, h2x, gmSimdfma(u, h1x, c00)));
+    *dx = gmSimdfma(du, gmSimdfma(k3, v, k1), *dx);
+    *dy = gmSimdfma(uv, h3y, gmSimdfma(v, h2y, gmSimdfma(u, h1y, s00)));
+    *dy = gmSimdfma(dv, gmSimdfma(k3, u, k2), *dy);
+}
+
+/* gmFbm2dGrad per lane */
+CGMINLINE void gmFbm2dGradLanes(simdf px, simdf py, int octaves, float lacunarity, float gain,
+                                simdf *n, simdf *dx, simdf *dy)
+{
+    float amp = 1.0f, freq = 1.0f;
+
+    *n = *dx = *dy = gmSimdzero();
+    for(int o = 0; o < octaves; o++)
+    {
+        simdf f = gmSimdsplat(freq), a = gmSimdsplat(amp), af = gmSimdsplat(amp * freq);
+        simdf on, ox, oy;
+        gmNoise2dGradLanes(gmSimdmul(px, f), gmSimdmul(py, f), &on, &ox, &oy);
+        *n = gmSimdfma(a, on, *n);
+        *dx = gmSimdfma(af, ox, *dx);
+        *dy = gmSimdfma(af, oy, *dy);
+        amp *= gain;
+        freq *= lacunarity;
+    }
+}
+
+CGMINLINE void gmNoiseStore(simdf n, simdf dx, simdf dy, size_t k, vec3 *out)
+{
+    float t[3][CGM_SIMD_WIDTH];
+    gmSimdstore(t[0], n);
+    gmSimdstore(t[1], dx);
+    gmSimdstore(t[2], dy);
+    for(size_t l = 0; l < k; l++)
+    {
+        out[l] = gmVec3(t[0][l], t[1][l], t[2][l]);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* batch                                                                       */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief `gmFbm2dGrad` of n points
+ */
+CGMINLINE void gmFbm2dGradBatch(const vec2 *p, size_t n, int octaves, float lacunarity, float gain, vec3 *out)
+{
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, n - i);
+        float t[2][CGM_SIMD_WIDTH];
+        simdf v, dx, dy;
+
+        for(size_t l = 0; l < CGM_SIMD_WIDTH; l++)
+        {
+            t[0][l] = (l < k) ? p[i + l].x : 0.0f;
+            t[1][l] = (l < k) ? p[i + l].y : 0.0f;
+        }
+        gmFbm2dGradLanes(gmSimdload(t[0]), gmSimdload(t[1]), octaves, lacunarity, gain, &v, &dx, &dy);
+        gmNoiseStore(v, dx, dy, k, out + i);
+    }
+}
+
+/**
+ * @brief `gmNoise2dGrad` of n points
+ */
+CGMINLINE void gmNoise2dGradBatch(const vec2 *p, size_t n, vec3 *out)
+{
+    gmFbm2dGradBatch(p, n, 1, 1.0f, 1.0f, out);
+}
+
+typedef struct
+{
+    vec2  origin;     /* sample of pixel (0, 0) */
+    vec2  step;       /* sample spacing along x and y */
+    int   width;
+    int   height;
+    int   octaves;
+    float lacunarity;
+    float gain;
+} gmNoiseGrid;
+
+/**
+ * @brief `gmFbm2dGrad` of rows [y0, y1) of a regular grid
+ *
+ * sample (x, y) is at origin + (x, y) * step, out is row-major.
+ */
+CGMINLINE void gmFbm2dGradGridRows(const gmNoiseGrid *g, int y0, int y1, vec3 *out)
+{
+    float iota[CGM_SIMD_WIDTH];
+    for(int l = 0; l < CGM_SIMD_WIDTH; l++)
+    {
+        iota[l] = (float)l;
+    }
+    simdf lane = gmSimdload(iota);
+    size_t width = (size_t)g->width;
+
+    for(int y = y0; y < y1; y++)
+    {
+        simdf py = gmSimdsplat(g->origin.y + (float)y * g->step.y);
+        vec3 *row = out + (size_t)y * width;
+
+        for(size_t i = 0; i < width; i += CGM_SIMD_WIDTH)
+        {
+            size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, width - i);
+            simdf px = gmSimdfma(gmSimdadd(lane, gmSimdsplat((float)i)), gmSimdsplat(g->step.x), gmSimdsplat(g->origin.x));
+            simdf v, dx, dy;
+
+            gmFbm2dGradLanes(px, py, g->octaves, g->lacunarity, g->gain, &v, &dx, &dy);
+            gmNoiseStore(v, dx, dy, k, row + i);
+        }
+    }
+}
+
+/**
+ * @brief `gmFbm2dGrad` of a whole grid (`g->width` x `g->height`)
+ */
+CGMINLINE void gmFbm2dGradGrid(const gmNoiseGrid *g, vec3 *out)
+{
+    gmFbm2dGradGridRows(g, 0, g->height, out);
+}
+
+typedef struct
+{
+    const gmNoiseGrid *g;
+    vec3              *out;
+} gmNoiseJob;
+
+CGMINLINE void gmFbm2dGradGridTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmNoiseJob *j = (gmNoiseJob *)ctx;
+    (void)thread;
+    gmFbm2dGradGridRows(j->g, (int)b, (int)e, j->out);
+}
+
+/**
+ * @brief `gmFbm2dGradGrid` split by rows across the job pool
+ */
+CGMINLINE void gmFbm2dGradGridParallel(const gmNoiseGrid *g, vec3 *out)
+{
+    gmNoiseJob j = {g, out};
+    size_t rows = CGM_NOISE_GRAIN / (size_t)GMMAX(g->width, 1);
+    gmParallelFor((size_t)g->height, GMMAX(rows, (size_t)1), gmFbm2dGradGridTask, &j);
+}
+
+#endif
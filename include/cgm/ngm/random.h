@@ -0,0 +1,711 @@
+#ifndef RANDOM_GRAPHICS_MATH
+#define RANDOM_GRAPHICS_MATH
+
+/**
+ * @file random.h
+ * @brief counter-based random numbers, low-discrepancy sequences and
+ * sphere / hemisphere / disk samples
+ *
+ * the generator is counter-based: value i of a stream is
+ *
+ *     mix(mix(i + key) ^ key),    key = gmRandomKey(seed, stream)
+ *
+ * with `mix` a bijective xorshift-multiply finalizer. nothing is carried
+ * from one value to the next, so any range of a stream can be produced on
+ * any thread (or `CGM_SIMD_WIDTH` values at a time) and the output never
+ * depends on how the work was split.
+ *
+ * low-discrepancy sequences, all random access by index:
+ *  - `gmSobol`: Sobol dimensions 0 - 7 (Joe-Kuo direction numbers)
+ *  - `gmHalton`: radical inverse in the first 16 prime bases
+ *  - `gmR2`: Roberts' additive sequence on the plastic number, the
+ *    fixed-point form keeps it exact for every index
+ *
+ * `gmSampler` picks one of them (or the random stream) for 2D samples and
+ * randomizes it by seed: a digital shift (xor) for Sobol, a toroidal shift
+ * for Halton and R2. the bulk functions map sample `first + i` to
+ * square, concentric disk, sphere, hemisphere or cosine-weighted
+ * hemisphere points, so results only depend on (sampler, index).
+ *
+ * the lane kernels produce the same bits as the scalar functions for the
+ * integer sequences; the sphere and disk maps use the polynomial sin / cos
+ * of noise.h and agree with libm to ~1e-6. the cosine-weighted hemisphere
+ * takes z from the concentric radius, sqrt((1 - r) (1 + r)), in both
+ * paths, so only its x and y see that error. Halton lanes divide in float
+ * and need index < 2^24.
+ */
+
+#include "../core.h"
+#include "../ugm/ugm.h"
+#include "../vec2.h"
+#include "../vec3.h"
+#include "../sgm/simd.h"
+#include "../jgm/job.h"
+#include "noise.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef CGM_RANDOM_GRAIN
+#define CGM_RANDOM_GRAIN 4096 /* values per parallel chunk */
+#endif
+
+#define CGM_SOBOL_DIMS  8
+#define CGM_HALTON_DIMS 16
+
+#define CGM_SAMPLER_RANDOM 0
+#define CGM_SAMPLER_SOBOL  1
+#define CGM_SAMPLER_HALTON 2
+#define CGM_SAMPLER_R2     3
+
+#define CGM_SAMPLE_SQUARE            0 /* vec2 in [0, 1)^2 */
+#define CGM_SAMPLE_DISK              1 /* vec2 in the unit disk, uniform */
+#define CGM_SAMPLE_SPHERE            2 /* vec3 on the unit sphere, uniform */
+#define CGM_SAMPLE_HEMISPHERE        3 /* vec3 on the +z hemisphere, uniform */
+#define CGM_SAMPLE_HEMISPHERE_COSINE 4 /* vec3 on the +z hemisphere, pdf cos / pi */
+
+/* R2 steps 2^32 / g and 2^32 / g^2, g the plastic number */
+#define CGM_R2_STEP_X 0xc13fa9a9u
+#define CGM_R2_STEP_Y 0x91e10da6u
+
+/* -------------------------------------------------------------------------- */
+/* counter-based generator                                                     */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief bijective 32-bit integer finalizer
+ */
+CGMINLINE uint32_t gmRandomMix(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x21f0aaadu;
+    x ^= x >> 15;
+    x *= 0x735a2d97u;
+    x ^= x >> 15;
+    return x;
+}
+
+/**
+ * @brief key of an independent stream of a seed
+ */
+CGMINLINE uint32_t gmRandomKey(uint32_t seed, uint32_t stream)
+{
+    return gmRandomMix(seed * 0x9e3779b9u + gmRandomMix(stream + 0x6a09e667u));
+}
+
+/**
+ * @brief value `index` of the stream `key`
+ */
+CGMINLINE uint32_t gmRandomU32(uint32_t key, uint32_t index)
+{
+    return gmRandomMix(gmRandomMix(index + key) ^ key);
+}
+
+/* top 24 bits as a float in [0, 1) */
+CGMINLINE float gmRandomUnit(uint32_t x)
+{
+    return (float)(x >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+ * @brief value `index` of the stream `key` in [0, 1)
+ */
+CGMINLINE float gmRandomFloat(uint32_t key, uint32_t index)
+{
+    return gmRandomUnit(gmRandomU32(key, index));
+}
+
+typedef struct
+{
+    uint32_t key;
+    uint32_t counter; /* index of the next value */
+} gmRng;
+
+CGMINLINE gmRng gmRngInit(uint32_t seed, uint32_t stream)
+{
+    gmRng r = {gmRandomKey(seed, stream), 0};
+    return r;
+}
+
+CGMINLINE uint32_t gmRngU32(gmRng *r)
+{
+    return gmRandomU32(r->key, r->counter++);
+}
+
+/**
+ * @brief next value in [0, 1)
+ */
+CGMINLINE float gmRngFloat(gmRng *r)
+{
+    return gmRandomFloat(r->key, r->counter++);
+}
+
+/**
+ * @brief next value in [min, max)
+ */
+CGMINLINE float gmRngRange(gmRng *r, float min, float max)
+{
+    return min + (max - min) * gmRngFloat(r);
+}
+
+/* -------------------------------------------------------------------------- */
+/* low-discrepancy sequences                                                   */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief direction numbers of Sobol dimension `dim` (< CGM_SOBOL_DIMS)
+ */
+CGMINLINE void gmSobolDirections(int dim, uint32_t v[32])
+{
+    /* degree, coefficients and initial m of the primitive polynomials */
+    static const int poly[CGM_SOBOL_DIMS][2] = {{0, 0}, {1, 0}, {2, 1}, {3, 1}, {3, 2}, {4, 1}, {4, 4}, {5, 2}};
+    static const uint32_t init[CGM_SOBOL_DIMS][5] = {
+        {0},       {1},          {1, 3},         {1, 3, 1},
+        {1, 1, 1}, {1, 1, 3, 3}, {1, 3, 5, 13},  {1, 1, 5, 5, 17}
+    };
+    int s = poly[dim][0], a = poly[dim][1];
+
+    for(int k = 0; k < 32; k++)
+    {
+        if(dim == 0)
+        {
+            v[k] = 1u << (31 - k);
+        }
+        else if(k < s)
+        {
+            v[k] = init[dim][k] << (31 - k);
+        }
+        else
+        {
+            v[k] = v[k - s] ^ (v[k - s] >> s);
+            for(int j = 1; j < s; j++)
+            {
+                v[k] ^= ((a >> (s - 1 - j)) & 1) ? v[k - j] : 0u;
+            }
+        }
+    }
+}
+
+/* Sobol point of index from direction numbers, 32-bit fixed point */
+CGMINLINE uint32_t gmSobolU32(uint32_t index, const uint32_t v[32])
+{
+    uint32_t x = 0;
+    for(int k = 0; index; k++, index >>= 1)
+    {
+        x ^= (index & 1u) ? v[k] : 0u;
+    }
+    return x;
+}
+
+/**
+ * @brief coordinate `dim` (< CGM_SOBOL_DIMS) of Sobol point `index` in [0, 1)
+ */
+CGMINLINE float gmSobol(uint32_t index, int dim)
+{
+    uint32_t v[32];
+    gmSobolDirections(dim, v);
+    return gmRandomUnit(gmSobolU32(index, v));
+}
+
+/* prime base of a Halton dimension */
+CGMINLINE uint32_t gmHaltonBase(int dim)
+{
+    static const uint32_t primes[CGM_HALTON_DIMS] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53};
+    return primes[dim];
+}
+
+/**
+ * @brief coordinate `dim` (< CGM_HALTON_DIMS) of Halton point `index` in [0, 1)
+ */
+CGMINLINE float gmHalton(uint32_t index, int dim)
+{
+    uint32_t b = gmHaltonBase(dim);
+    float inv = 1.0f / (float)b, f = 1.0f, x = 0.0f;
+
+    while(index)
+    {
+        f = f * inv;
+        x = x + (float)(index % b) * f;
+        index /= b;
+    }
+    return GMMIN(x, 0.99999994f);
+}
+
+/**
+ * @brief R2 point `index` in [0, 1)^2
+ */
+CGMINLINE vec2 gmR2(uint32_t index)
+{
+    uint32_t x = 0x80000000u + index * CGM_R2_STEP_X;
+    uint32_t y = 0x80000000u + index * CGM_R2_STEP_Y;
+    return gmVec2(gmRandomUnit(x), gmRandomUnit(y));
+}
+
+/* -------------------------------------------------------------------------- */
+/* samples                                                                     */
+/* -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    uint32_t seed;
+    int      type; /* CGM_SAMPLER_* */
+    int      dim;  /* first of the two dimensions used (Sobol, Halton, random streams) */
+} gmSampler;
+
+/**
+ * @brief sampler of dimensions dim and dim + 1
+ *
+ * Sobol needs dim + 1 < CGM_SOBOL_DIMS and Halton dim + 1 < CGM_HALTON_DIMS;
+ * dim is clamped to that range (so the last valid pair is used). the
+ * random stream and R2 only use dim as a seed and take any value.
+ */
+CGMINLINE gmSampler gmSamplerInit(int type, uint32_t seed, int dim)
+{
+    int dims = (type == CGM_SAMPLER_SOBOL) ? CGM_SOBOL_DIMS : (type == CGM_SAMPLER_HALTON) ? CGM_HALTON_DIMS : 0;
+    gmSampler s = {seed, type, dims ? GMMIN(GMMAX(dim, 0), dims - 2) : dim};
+    return s;
+}
+
+/**
+ * @brief sample `index` of a sampler in [0, 1)^2
+ */
+CGMINLINE vec2 gmSamplerPoint(const gmSampler *s, uint32_t index)
+{
+    uint32_t k0 = gmRandomKey(s->seed, (uint32_t)s->dim), k1 = gmRandomKey(s->seed, (uint32_t)s->dim + 1);
+    uint32_t v[32];
+    vec2 p;
+
+    switch(s->type)
+    {
+        case CGM_SAMPLER_SOBOL:
+            gmSobolDirections(s->dim, v);
+            p.x = gmRandomUnit(gmSobolU32(index, v) ^ k0);
+            gmSobolDirections(s->dim + 1, v);
+            p.y = gmRandomUnit(gmSobolU32(index, v) ^ k1);
+            return p;
+        case CGM_SAMPLER_HALTON:
+            p.x = gmHalton(index, s->dim) + gmRandomUnit(k0);
+            p.y = gmHalton(index, s->dim + 1) + gmRandomUnit(k1);
+            p.x = (p.x >= 1.0f) ? p.x - 1.0f : p.x;
+            p.y = (p.y >= 1.0f) ? p.y - 1.0f : p.y;
+            return p;
+        case CGM_SAMPLER_R2:
+            p.x = gmRandomUnit(k0 + index * CGM_R2_STEP_X);
+            p.y = gmRandomUnit(k1 + index * CGM_R2_STEP_Y);
+            return p;
+        default:
+            return gmVec2(gmRandomFloat(k0, index), gmRandomFloat(k1, index));
+    }
+}
+
+/* gmMapDisk, also returning the signed concentric radius */
+CGMINLINE vec2 gmMapDiskRadius(vec2 u, float *rad)
+{
+    float a = 2.0f * u.x - 1.0f, b = 2.0f * u.y - 1.0f, r, phi;
+
+    *rad = 0.0f;
+    if(a == 0.0f && b == 0.0f)
+    {
+        return gmVec2(0.0f, 0.0f);
+    }
+    if(fabsf(a) > fabsf(b))
+    {
+        r = a;
+        phi = 0.785398163f * (b / a);
+    }
+    else
+    {
+        r = b;
+        phi = 1.570796327f - 0.785398163f * (a / b);
+    }
+    *rad = r;
+    return gmVec2(r * cosf(phi), r * sinf(phi));
+}
+
+/**
+ * @brief uniform point of the unit disk (Shirley-Chiu concentric map,
+ * keeps the stratification of low-discrepancy samples)
+ */
+CGMINLINE vec2 gmMapDisk(vec2 u)
+{
+    float r;
+    return gmMapDiskRadius(u, &r);
+}
+
+/**
+ * @brief uniform point of the unit sphere
+ */
+CGMINLINE vec3 gmMapSphere(vec2 u)
+{
+    float z = 1.0f - 2.0f * u.x, r = sqrtf(GMMAX(1.0f - z * z, 0.0f)), phi = 6.2831853f * u.y;
+    return gmVec3(r * cosf(phi), r * sinf(phi), z);
+}
+
+/**
+ * @brief uniform point of the +z unit hemisphere
+ */
+CGMINLINE vec3 gmMapHemisphere(vec2 u)
+{
+    float z = 1.0f - u.x, r = sqrtf(GMMAX(1.0f - z * z, 0.0f)), phi = 6.2831853f * u.y;
+    return gmVec3(r * cosf(phi), r * sinf(phi), z);
+}
+
+/**
+ * @brief cosine-weighted point of the +z unit hemisphere
+ */
+CGMINLINE vec3 gmMapHemisphereCosine(vec2 u)
+{
+    /* z from the radius rather than from x and y after the sin / cos round trip */
+    float r;
+    vec2 d = gmMapDiskRadius(u, &r);
+    return gmVec3(d.x, d.y, sqrtf(GMMAX((1.0f - fabsf(r)) * (1.0f + fabsf(r)), 0.0f)));
+}
+
+/* -------------------------------------------------------------------------- */
+/* lanes                                                                       */
+/* -------------------------------------------------------------------------- */
+
+/* gmRandomMix per lane */
+CGMINLINE simdi gmRandomMixLanes(simdi x)
+{
+    x = gmSimdixor(x, gmSimdisrl(x, 16));
+    x = gmSimdimul(x, gmSimdisplat(0x21f0aaad));
+    x = gmSimdixor(x, gmSimdisrl(x, 15));
+    x = gmSimdimul(x, gmSimdisplat(0x735a2d97));
+    return gmSimdixor(x, gmSimdisrl(x, 15));
+}
+
+/* gmRandomU32 per lane */
+CGMINLINE simdi gmRandomLanes(simdi key, simdi index)
+{
+    return gmRandomMixLanes(gmSimdixor(gmRandomMixLanes(gmSimdiadd(index, key)), key));
+}
+
+/* gmRandomUnit per lane */
+CGMINLINE simdf gmRandomUnitLanes(simdi x)
+{
+    return gmSimdmul(gmSimditof(gmSimdisrl(x, 8)), gmSimdsplat(1.0f / 16777216.0f));
+}
+
+/* gmSobolU32 per lane, for indices below 2^bits */
+CGMINLINE simdi gmSobolLanes(simdi index, const uint32_t v[32], int bits)
+{
+    simdi x = gmSimdisplat(0);
+    for(int k = 0; k < bits; k++)
+    {
+        simdi m = gmSimdisra(gmSimdisll(index, 31 - k), 31);
+        x = gmSimdixor(x, gmSimdiand(m, gmSimdisplat((int32_t)v[k])));
+    }
+    return x;
+}
+
+/* gmHalton per lane, index < 2^24 */
+CGMINLINE simdf gmHaltonLanes(simdi index, uint32_t base)
+{
+    float inv = 1.0f / (float)base;
+    simdi b = gmSimdisplat((int32_t)base), bm = gmSimdisplat((int32_t)base - 1), zero = gmSimdisplat(0);
+    simdf vinv = gmSimdsplat(inv), f = gmSimdsplat(1.0f), x = gmSimdzero();
+    int full = (1 << CGM_SIMD_WIDTH) - 1;
+
+    while(gmSimdmask(gmSimdasf(gmSimdieq(index, zero))) != full)
+    {
+        /* float quotient, off by at most one below 2^24 */
+        simdi q = gmSimditrunc(gmSimdmul(gmSimditof(index), vinv));
+        simdi r = gmSimdisub(index, gmSimdimul(q, b));
+        simdi lo = gmSimdigt(zero, r), hi;
+        q = gmSimdiadd(q, lo);
+        r = gmSimdiadd(r, gmSimdiand(lo, b));
+        hi = gmSimdigt(r, bm);
+        q = gmSimdisub(q, hi);
+        r = gmSimdisub(r, gmSimdiand(hi, b));
+
+        f = gmSimdmul(f, vinv);
+        x = gmSimdadd(x, gmSimdmul(gmSimditof(r), f));
+        index = q;
+    }
+    return gmSimdmin(x, gmSimdsplat(0.99999994f));
+}
+
+/* sampler constants shared by all blocks of a batch */
+typedef struct
+{
+    int      type;
+    uint32_t key[2];
+    uint32_t base[2];
+    float    shift[2];
+    uint32_t dir[2][32];
+    int      bits;
+} gmSamplerState;
+
+CGMINLINE void gmSamplerPrepare(const gmSampler *s, uint32_t last, gmSamplerState *st)
+{
+    st->type = s->type;
+    st->bits = 0;
+    for(int c = 0; c < 2; c++)
+    {
+        st->key[c] = gmRandomKey(s->seed, (uint32_t)(s->dim + c));
+        st->shift[c] = gmRandomUnit(st->key[c]);
+        if(s->type == CGM_SAMPLER_SOBOL)
+        {
+            gmSobolDirections(s->dim + c, st->dir[c]);
+        }
+        if(s->type == CGM_SAMPLER_HALTON)
+        {
+            st->base[c] = gmHaltonBase(s->dim + c);
+        }
+    }
+    while(st->bits < 32 && (last >> st->bits))
+    {
+        st->bits++;
+    }
+}
+
+/* gmSamplerPoint per lane */
+CGMINLINE void gmSamplerLanes(const gmSamplerState *st, simdi index, simdf *u, simdf *v)
+{
+    simdi k0 = gmSimdisplat((int32_t)st->key[0]), k1 = gmSimdisplat((int32_t)st->key[1]);
+    simdf one = gmSimdsplat(1.0f);
+
+    switch(st->type)
+    {
+        case CGM_SAMPLER_SOBOL:
+            *u = gmRandomUnitLanes(gmSimdixor(gmSobolLanes(index, st->dir[0], st->bits), k0));
+            *v = gmRandomUnitLanes(gmSimdixor(gmSobolLanes(index, st->dir[1], st->bits), k1));
+            break;
+        case CGM_SAMPLER_HALTON:
+            *u = gmSimdadd(gmHaltonLanes(index, st->base[0]), gmSimdsplat(st->shift[0]));
+            *v = gmSimdadd(gmHaltonLanes(index, st->base[1]), gmSimdsplat(st->shift[1]));
+            *u = gmSimdsub(*u, gmSimdand(gmSimdle(one, *u), one));
+            *v = gmSimdsub(*v, gmSimdand(gmSimdle(one, *v), one));
+            break;
+        case CGM_SAMPLER_R2:
+            *u = gmRandomUnitLanes(gmSimdiadd(k0, gmSimdimul(index, gmSimdisplat((int32_t)CGM_R2_STEP_X))));
+            *v = gmRandomUnitLanes(gmSimdiadd(k1, gmSimdimul(index, gmSimdisplat((int32_t)CGM_R2_STEP_Y))));
+            break;
+        default:
+            *u = gmRandomUnitLanes(gmRandomLanes(k0, index));
+            *v = gmRandomUnitLanes(gmRandomLanes(k1, index));
+            break;
+    }
+}
+
+/* gmMapDiskRadius per lane */
+CGMINLINE void gmMapDiskLanes(simdf u, simdf v, simdf *x, simdf *y, simdf *rad)
+{
+    simdf one = gmSimdsplat(1.0f), two = gmSimdsplat(2.0f), zero = gmSimdzero();
+    simdf a = gmSimdsub(gmSimdmul(two, u), one), b = gmSimdsub(gmSimdmul(two, v), one);
+    simdf wide = gmSimdlt(gmSimdabs(b), gmSimdabs(a));
+    simdf r = gmSimdselect(wide, a, b);
+
+    /* the ratio is 0 / 0 only at the center, where r = 0 anyway */
+    simdf den = gmSimdselect(gmSimdeq(r, zero), one, r);
+    simdf t = gmSimdmul(gmSimddiv(gmSimdselect(wide, b, a), den), gmSimdsplat(0.785398163f));
+    simdf phi = gmSimdselect(wide, t, gmSimdsub(gmSimdsplat(1.570796327f), t));
+    simdf s, c;
+
+    gmSincosLanes(phi, &s, &c);
+    *x = gmSimdmul(r, c);
+    *y = gmSimdmul(r, s);
+    *rad = r;
+}
+
+/* gmMapSphere (z0 = 1, scale = 2) and gmMapHemisphere (z0 = 1, scale = 1) per lane */
+CGMINLINE void gmMapZoneLanes(simdf u, simdf v, float scale, simdf *x, simdf *y, simdf *z)
+{
+    simdf one = gmSimdsplat(1.0f), s, c;
+    *z = gmSimdsub(one, gmSimdmul(gmSimdsplat(scale), u));
+    simdf r = gmSimdsqrt(gmSimdmax(gmSimdsub(one, gmSimdmul(*z, *z)), gmSimdzero()));
+
+    gmSincosLanes(gmSimdmul(v, gmSimdsplat(6.2831853f)), &s, &c);
+    *x = gmSimdmul(r, c);
+    *y = gmSimdmul(r, s);
+}
+
+/* -------------------------------------------------------------------------- */
+/* batch                                                                       */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief values [first + b, first + e) of the stream `key` into out[b, e)
+ */
+CGMINLINE void gmRandomFloatsRange(uint32_t key, uint32_t first, size_t b, size_t e, float *out)
+{
+    int32_t iota[CGM_SIMD_WIDTH];
+    float t[CGM_SIMD_WIDTH];
+    for(int l = 0; l < CGM_SIMD_WIDTH; l++)
+    {
+        iota[l] = l;
+    }
+    simdi lane = gmSimdiload(iota), k = gmSimdisplat((int32_t)key);
+
+    for(size_t i = b; i < e; i += CGM_SIMD_WIDTH)
+    {
+        size_t m = GMMIN((size_t)CGM_SIMD_WIDTH, e - i);
+        simdi index = gmSimdiadd(lane, gmSimdisplat((int32_t)(first + (uint32_t)i)));
+        simdf x = gmRandomUnitLanes(gmRandomLanes(k, index));
+
+        if(m == CGM_SIMD_WIDTH)
+        {
+            gmSimdstore(out + i, x);
+            continue;
+        }
+        gmSimdstore(t, x);
+        for(size_t l = 0; l < m; l++)
+        {
+            out[i + l] = t[l];
+        }
+    }
+}
+
+/**
+ * @brief n values of the stream `key` from index `first`, in [0, 1)
+ */
+CGMINLINE void gmRandomFloats(uint32_t key, uint32_t first, size_t n, float *out)
+{
+    gmRandomFloatsRange(key, first, 0, n, out);
+}
+
+/**
+ * @brief next n values of a generator
+ */
+CGMINLINE void gmRngFill(gmRng *r, size_t n, float *out)
+{
+    gmRandomFloats(r->key, r->counter, n, out);
+    r->counter += (uint32_t)n;
+}
+
+/**
+ * @brief samples [first + b, first + e) of a sampler mapped to `shape`
+ *
+ * @param shape CGM_SAMPLE_*
+ * @param out 2 floats per sample for square / disk, 3 otherwise
+ */
+CGMINLINE void gmSampleRange(const gmSampler *s, int shape, uint32_t first, size_t b, size_t e, float *out)
+{
+    gmSamplerState st;
+    int32_t iota[CGM_SIMD_WIDTH];
+    float t[3][CGM_SIMD_WIDTH];
+    int d = (shape == CGM_SAMPLE_SQUARE || shape == CGM_SAMPLE_DISK) ? 2 : 3;
+
+    if(b >= e)
+    {
+        return;
+    }
+    gmSamplerPrepare(s, first + (uint32_t)(e - 1), &st);
+    for(int l = 0; l < CGM_SIMD_WIDTH; l++)
+    {
+        iota[l] = l;
+    }
+    simdi lane = gmSimdiload(iota);
+
+    for(size_t i = b; i < e; i += CGM_SIMD_WIDTH)
+    {
+        size_t m = GMMIN((size_t)CGM_SIMD_WIDTH, e - i);
+        simdi index = gmSimdiadd(lane, gmSimdisplat((int32_t)(first + (uint32_t)i)));
+        simdf u, v, x, y, r, z = gmSimdzero();
+
+        gmSamplerLanes(&st, index, &u, &v);
+        switch(shape)
+        {
+            case CGM_SAMPLE_DISK:
+                gmMapDiskLanes(u, v, &x, &y, &r);
+                break;
+            case CGM_SAMPLE_SPHERE:
+                gmMapZoneLanes(u, v, 2.0f, &x, &y, &z);
+                break;
+            case CGM_SAMPLE_HEMISPHERE:
+                gmMapZoneLanes(u, v, 1.0f, &x, &y, &z);
+                break;
+            case CGM_SAMPLE_HEMISPHERE_COSINE:
+                gmMapDiskLanes(u, v, &x, &y, &r);
+                r = gmSimdabs(r);
+                z = gmSimdmul(gmSimdsub(gmSimdsplat(1.0f), r), gmSimdadd(gmSimdsplat(1.0f), r));
+                z = gmSimdsqrt(gmSimdmax(z, gmSimdzero()));
+                break;
+            default:
+                x = u;
+                y = v;
+                break;
+        }
+
+        gmSimdstore(t[0], x);
+        gmSimdstore(t[1], y);
+        gmSimdstore(t[2], z);
+        for(size_t l = 0; l < m; l++)
+        {
+            for(int c = 0; c < d; c++)
+            {
+                out[(i + l) * (size_t)d + (size_t)c] = t[c][l];
+            }
+        }
+    }
+}
+
+CGMINLINE void gmSampleSquare(const gmSampler *s, uint32_t first, size_t n, vec2 *out)
+{
+    gmSampleRange(s, CGM_SAMPLE_SQUARE, first, 0, n, (float *)out);
+}
+
+CGMINLINE void gmSampleDisk(const gmSampler *s, uint32_t first, size_t n, vec2 *out)
+{
+    gmSampleRange(s, CGM_SAMPLE_DISK, first, 0, n, (float *)out);
+}
+
+CGMINLINE void gmSampleSphere(const gmSampler *s, uint32_t first, size_t n, vec3 *out)
+{
+    gmSampleRange(s, CGM_SAMPLE_SPHERE, first, 0, n, (float *)out);
+}
+
+CGMINLINE void gmSampleHemisphere(const gmSampler *s, uint32_t first, size_t n, vec3 *out)
+{
+    gmSampleRange(s, CGM_SAMPLE_HEMISPHERE, first, 0, n, (float *)out);
+}
+
+CGMINLINE void gmSampleHemisphereCosine(const gmSampler *s, uint32_t first, size_t n, vec3 *out)
+{
+    gmSampleRange(s, CGM_SAMPLE_HEMISPHERE_COSINE, first, 0, n, (float *)out);
+}
+
+typedef struct
+{
+    const gmSampler *s;
+    int              shape;
+    uint32_t         key;
+    uint32_t         first;
+    float           *out;
+} gmRandomJob;
+
+CGMINLINE void gmRandomFloatsTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmRandomJob *j = (gmRandomJob *)ctx;
+    (void)thread;
+    gmRandomFloatsRange(j->key, j->first, b, e, j->out);
+}
+
+CGMINLINE void gmSampleTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmRandomJob *j = (gmRandomJob *)ctx;
+    (void)thread;
+    gmSampleRange(j->s, j->shape, j->first, b, e, j->out);
+}
+
+/**
+ * @brief `gmRandomFloats` split across the job pool, same output
+ */
+CGMINLINE void gmRandomFloatsParallel(uint32_t key, uint32_t first, size_t n, float *out)
+{
+    gmRandomJob j = {NULL, 0, key, first, out};
+    gmParallelFor(n, CGM_RANDOM_GRAIN, gmRandomFloatsTask, &j);
+}
+
+/**
+ * @brief n samples of `shape` split across the job pool, same output as
+ * `gmSampleRange(s, shape, first, 0, n, out)`
+ */
+CGMINLINE void gmSampleParallel(const gmSampler *s, int shape, uint32_t first, size_t n, float *out)
+{
+    gmRandomJob j = {s, shape, 0, first, out};
+    gmParallelFor(n, CGM_RANDOM_GRAIN, gmSampleTask, &j);
+}
+
+#endif
@@ -0,0 +1,396 @@
+#ifndef PROFILE_GRAPHICS_MATH
+#define PROFILE_GRAPHICS_MATH
+
+/**
+ * @file profile.h
+ * @brief per-function call counts and cycle totals (`CGM_PROFILE` builds)
+ *
+ * build with `-DCGM_PROFILE -finstrument-functions` (GCC / Clang, ELF).
+ * `CGMINLINE` then places every cgm function in the `cgm_text` section and
+ * the instrumentation hooks below ignore anything outside it, so the rest
+ * of the program only pays one range check per call. the `gmSimd*`
+ * wrappers are `CGMINTRINSIC` and are never instrumented.
+ *
+ * every thread counts into its own table: no locks and no atomics on the
+ * hot path. tables are pushed onto a lock-free list on first use and are
+ * merged by function name when the report is written.
+ *
+ * the report is written at exit, sorted by inclusive cycles, to stderr or
+ * to the file named by the `CGM_PROFILE_OUT` environment variable (JSON
+ * when the name ends in `.json`). `gmProfileReport` writes one on demand;
+ * threads still running at that point are read without synchronisation.
+ *
+ * cycles are `rdtsc` ticks on x86 and nanoseconds elsewhere. `self`
+ * excludes time spent in cgm callees. names come from the executable's
+ * symbol table, so do not strip profiled binaries; functions of shared
+ * libraries are not tracked.
+ *
+ * without `CGM_PROFILE` this header is empty.
+ *
+ * macros:
+ *  `CGM_PROFILE_SLOTS`: functions tracked per thread, power of two (default: 1024)
+ *  `CGM_PROFILE_DEPTH`: deepest tracked call nesting (default: 64)
+ */
+
+#if defined(CGM_PROFILE)
+
+#if !defined(__GNUC__) || !defined(__ELF__)
+#error "CGM_PROFILE needs GCC or Clang on an ELF target"
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <link.h>
+#include <sys/auxv.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CGM_PROFILE_UNIT "rdtsc"
+#else
+#include <time.h>
+#define CGM_PROFILE_UNIT "ns"
+#endif
+
+#ifndef CGM_PROFILE_SLOTS
+#define CGM_PROFILE_SLOTS 1024
+#endif
+
+#ifndef CGM_PROFILE_DEPTH
+#define CGM_PROFILE_DEPTH 64
+#endif
+
+#define CGM_PROFILE_FN static inline __attribute__((no_instrument_function))
+#define CGM_PROFILE_WEAK __attribute__((weak))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    const void *fn;
+    uint64_t    calls;
+    uint64_t    cycles;
+    uint64_t    self;
+} gmProfileSlot;
+
+typedef struct gmProfileThread
+{
+    struct gmProfileThread *next;
+    int                     depth;
+    gmProfileSlot          *frame[CGM_PROFILE_DEPTH];
+    uint64_t                start[CGM_PROFILE_DEPTH];
+    uint64_t                child[CGM_PROFILE_DEPTH];
+    gmProfileSlot           slot[CGM_PROFILE_SLOTS];
+} gmProfileThread;
+
+/* merged report row */
+typedef struct
+{
+    char     name[96];
+    uint64_t calls;
+    uint64_t cycles;
+    uint64_t self;
+    int      threads;
+} gmProfileEntry;
+
+/* bounds of the `cgm_text` section, provided by the linker */
+extern char __start_cgm_text[] CGM_PROFILE_WEAK;
+extern char __stop_cgm_text[] CGM_PROFILE_WEAK;
+
+CGM_PROFILE_WEAK gmProfileThread *gmProfileHead;
+CGM_PROFILE_WEAK int gmProfileStarted;
+CGM_PROFILE_WEAK __thread gmProfileThread *gmProfileLocal;
+
+CGM_PROFILE_FN uint64_t gmProfileNow(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+/* report                                                                      */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * @brief loads the executable image and finds its symbol table
+ *
+ * `bias` is the load address offset (nonzero for PIE), found by locating
+ * the program headers, whose runtime address the kernel passes in auxv.
+ *
+ * @return file buffer (free it) or NULL
+ */
+CGM_PROFILE_FN unsigned char *gmProfileSymbols(const ElfW(Sym) **sym, size_t *count, const char **str,
+                                               uintptr_t *bias)
+{
+    FILE *f = fopen("/proc/self/exe", "rb");
+    unsigned char *img = NULL;
+    long size;
+
+    *count = 0;
+    if(!f)
+    {
+        return NULL;
+    }
+
+    if(fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) > (long)sizeof(ElfW(Ehdr)) && fseek(f, 0, SEEK_SET) == 0)
+    {
+        img = (unsigned char *)malloc((size_t)size);
+        if(img && fread(img, 1, (size_t)size, f) != (size_t)size)
+        {
+            free(img);
+            img = NULL;
+        }
+    }
+    fclose(f);
+
+    if(img)
+    {
+        const ElfW(Ehdr) *eh = (const ElfW(Ehdr) *)img;
+        const ElfW(Shdr) *sh = (const ElfW(Shdr) *)(img + eh->e_shoff);
+        const ElfW(Phdr) *ph = (const ElfW(Phdr) *)(img + eh->e_phoff);
+
+        for(int i = 0; i < eh->e_phnum; i++)
+        {
+            if(ph[i].p_type == PT_LOAD && eh->e_phoff >= ph[i].p_offset &&
+               eh->e_phoff < ph[i].p_offset + ph[i].p_filesz)
+            {
+                *bias = (uintptr_t)getauxval(AT_PHDR) - (ph[i].p_vaddr + (eh->e_phoff - ph[i].p_offset));
+                break;
+            }
+        }
+
+        for(int i = 0; i < eh->e_shnum; i++)
+        {
+            if(sh[i].sh_type == SHT_SYMTAB)
+            {
+                *sym = (const ElfW(Sym) *)(img + sh[i].sh_offset);
+                *count = sh[i].sh_size / sizeof(ElfW(Sym));
+                *str = (const char *)(img + sh[sh[i].sh_link].sh_offset);
+                break;
+            }
+        }
+    }
+
+    return img;
+}
+
+CGM_PROFILE_FN int gmProfileCompare(const void *a, const void *b)
+{
+    uint64_t x = ((const gmProfileEntry *)a)->cycles;
+    uint64_t y = ((const gmProfileEntry *)b)->cycles;
+    return (x < y) - (x > y);
+}
+
+/**
+ * @brief merges all thread tables by name and writes them sorted by cycles
+ *
+ * @param f output stream
+ * @param json nonzero for JSON, otherwise an aligned text table
+ */
+CGM_PROFILE_FN void gmProfileReport(FILE *f, int json)
+{
+    const ElfW(Sym) *sym = NULL;
+    const char *str = NULL;
+    size_t nsym = 0;
+    uintptr_t bias = 0;
+    unsigned char *img = gmProfileSymbols(&sym, &nsym, &str, &bias);
+
+    size_t cap = 0, n = 0;
+    for(gmProfileThread *t = __atomic_load_n(&gmProfileHead, __ATOMIC_ACQUIRE); t; t = t->next)
+    {
+        cap += CGM_PROFILE_SLOTS;
+    }
+
+    gmProfileEntry *e = (gmProfileEntry *)calloc(cap ? cap : 1, sizeof(gmProfileEntry));
+    if(!e)
+    {
+        free(img);
+        return;
+    }
+
+    for(gmProfileThread *t = __atomic_load_n(&gmProfileHead, __ATOMIC_ACQUIRE); t; t = t->next)
+    {
+        for(size_t s = 0; s < CGM_PROFILE_SLOTS; s++)
+        {
+            const gmProfileSlot *p = &t->slot[s];
+            char name[96];
+            size_t k;
+
+            if(!p->fn || !p->calls)
+            {
+                continue;
+            }
+
+            snprintf(name, sizeof(name), "%p", p->fn);
+            for(size_t j = 0; j < nsym; j++)
+            {
+                if(ELF32_ST_TYPE(sym[j].st_info) == STT_FUNC && sym[j].st_value + bias == (uintptr_t)p->fn)
+                {
+                    snprintf(name, sizeof(name), "%s", str + sym[j].st_name);
+                    break;
+                }
+            }
+
+            for(k = 0; k < n && strcmp(e[k].name, name) != 0; k++)
+                ;
+            if(k == n)
+            {
+                memcpy(e[n++].name, name, sizeof(name));
+            }
+            e[k].calls += p->calls;
+            e[k].cycles += p->cycles;
+            e[k].self += p->self;
+            e[k].threads++;
+        }
+    }
+    free(img);
+
+    qsort(e, n, sizeof(gmProfileEntry), gmProfileCompare);
+
+    if(json)
+    {
+        fprintf(f, "{\"unit\":\"%s\",\"functions\":[", CGM_PROFILE_UNIT);
+        for(size_t k = 0; k < n; k++)
+        {
+            fprintf(f, "%s\n{\"name\":\"%s\",\"calls\":%llu,\"cycles\":%llu,\"self\":%llu,\"threads\":%d}",
+                    k ? "," : "", e[k].name, (unsigned long long)e[k].calls,
+                    (unsigned long long)e[k].cycles, (unsigned long long)e[k].self, e[k].threads);
+        }
+        fprintf(f, "\n]}\n");
+    }
+    else
+    {
+        fprintf(f, "%-32s %12s %16s %16s %10s %4s\n", "function", "calls", "cycles", "self",
+                CGM_PROFILE_UNIT "/call", "thr");
+        for(size_t k = 0; k < n; k++)
+        {
+            fprintf(f, "%-32s %12llu %16llu %16llu %10.1f %4d\n", e[k].name,
+                    (unsigned long long)e[k].calls, (unsigned long long)e[k].cycles,
+                    (unsigned long long)e[k].self, (double)e[k].cycles / (double)e[k].calls, e[k].threads);
+        }
+    }
+
+    free(e);
+}
+
+CGM_PROFILE_FN void gmProfileAtExit(void)
+{
+    const char *path = getenv("CGM_PROFILE_OUT");
+    FILE *f = path && *path ? fopen(path, "w") : NULL;
+    size_t len = path ? strlen(path) : 0;
+    int json = f && len >= 5 && strcmp(path + len - 5, ".json") == 0;
+
+    gmProfileReport(f ? f : stderr, json);
+    if(f)
+    {
+        fclose(f);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* instrumentation hooks                                                       */
+/* -------------------------------------------------------------------------- */
+
+CGM_PROFILE_FN gmProfileThread *gmProfileRegister(void)
+{
+    gmProfileThread *t = (gmProfileThread *)calloc(1, sizeof(gmProfileThread));
+    if(!t)
+    {
+        return NULL;
+    }
+
+    t->next = __atomic_load_n(&gmProfileHead, __ATOMIC_RELAXED);
+    while(!__atomic_compare_exchange_n(&gmProfileHead, &t->next, t, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        ;
+
+    if(!__atomic_exchange_n(&gmProfileStarted, 1, __ATOMIC_ACQ_REL))
+    {
+        atexit(gmProfileAtExit);
+    }
+
+    gmProfileLocal = t;
+    return t;
+}
+
+CGM_PROFILE_WEAK __attribute__((no_instrument_function))
+void __cyg_profile_func_enter(void *fn, void *site)
+{
+    gmProfileThread *t = gmProfileLocal;
+    gmProfileSlot *s = NULL;
+    (void)site;
+
+    if((char *)fn < __start_cgm_text || (char *)fn >= __stop_cgm_text)
+    {
+        return;
+    }
+    if(!t && !(t = gmProfileRegister()))
+    {
+        return;
+    }
+
+    if(t->depth < CGM_PROFILE_DEPTH)
+    {
+        size_t h = ((uintptr_t)fn >> 4) * 0x9e3779b1u;
+        for(size_t i = 0; i < CGM_PROFILE_SLOTS; i++)
+        {
+            gmProfileSlot *p = &t->slot[(h + i) & (CGM_PROFILE_SLOTS - 1)];
+            if(p->fn == fn || !p->fn)
+            {
+                p->fn = fn;
+                s = p;
+                break;
+            }
+        }
+
+        t->frame[t->depth] = s;
+        t->child[t->depth] = 0;
+        t->start[t->depth] = gmProfileNow();
+    }
+    t->depth++;
+}
+
+CGM_PROFILE_WEAK __attribute__((no_instrument_function))
+void __cyg_profile_func_exit(void *fn, void *site)
+{
+    gmProfileThread *t = gmProfileLocal;
+    (void)site;
+
+    if((char *)fn < __start_cgm_text || (char *)fn >= __stop_cgm_text || !t || t->depth == 0)
+    {
+        return;
+    }
+
+    if(--t->depth < CGM_PROFILE_DEPTH)
+    {
+        int d = t->depth;
+        uint64_t dt = gmProfileNow() - t->start[d];
+        gmProfileSlot *s = t->frame[d];
+
+        if(s)
+        {
+            s->calls++;
+            s->cycles += dt;
+            s->self += dt - t->child[d];
+        }
+        if(d > 0)
+        {
+            t->child[d - 1] += dt;
+        }
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif
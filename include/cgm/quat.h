@@ -76,6 +76,7 @@ CGMINLINE quat gmQuatmul(quat q0, quat q1)
  * @param a  rotation angle in radians
  *
  * @note if `CGM_ASSUME_NORMALIZED` is 0, the axis is normalized internally.
+ * `gmQuatAngleUnit` (unit.h) takes a `unitvec3` and never normalizes.
  */
 CGMINLINE quat gmQuatAngle(vec3 va, float a)
 {
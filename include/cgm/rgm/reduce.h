@@ -0,0 +1,534 @@
+#ifndef REDUCE_GRAPHICS_MATH
+#define REDUCE_GRAPHICS_MATH
+
+/**
+ * @file reduce.h
+ * @brief reductions over vec3 point clouds (sum, centroid, bounds,
+ * covariance, extent along a direction)
+ *
+ * the cloud is cut into chunks that run through `gmParallelFor`. inside a
+ * chunk, sums are accumulated linearly in SIMD lanes over blocks of
+ * `CGM_REDUCE_BLOCK` points and the block results are added pairwise, so
+ * the rounding error grows with log(n) instead of n. chunk results are
+ * combined pairwise as well, in chunk order: the result only depends on
+ * `n`, never on the thread count.
+ *
+ * macros:
+ *  `CGM_REDUCE_BLOCK`: points summed linearly before pairwise combining (default: 256)
+ *  `CGM_REDUCE_GRAIN`: minimum points per chunk (default: 65536)
+ *  `CGM_REDUCE_CHUNKS`: maximum number of chunks, the chunk size grows for
+ *  bigger clouds (default: 256)
+ */
+
+#include "../core.h"
+#include "../ugm/ugm.h"
+#include "../vec3.h"
+#include "../mat3.h"
+#include "../sgm/simd.h"
+#include "../jgm/job.h"
+#include <float.h>
+#include <stddef.h>
+
+#ifndef CGM_REDUCE_BLOCK
+#define CGM_REDUCE_BLOCK 256
+#endif
+
+#ifndef CGM_REDUCE_GRAIN
+#define CGM_REDUCE_GRAIN 65536
+#endif
+
+#ifndef CGM_REDUCE_CHUNKS
+#define CGM_REDUCE_CHUNKS 256
+#endif
+
+/* floats per partial result (6 for the covariance) */
+#define CGM_REDUCE_SLOTS 6
+
+/*
+ * @brief block kernel: accumulates `k` floats over at most
+ * `CGM_REDUCE_BLOCK` points into `acc` (overwritten)
+ */
+typedef void (*gmReduceBlockFn)(const vec3 *p, size_t n, const void *arg, float *acc);
+
+/* -------------------------------------------------------------------------- */
+/* pairwise driver                                                             */
+/* -------------------------------------------------------------------------- */
+
+CGMINLINE size_t gmReduceGrain(size_t n)
+{
+    size_t g = (n + CGM_REDUCE_CHUNKS - 1) / CGM_REDUCE_CHUNKS;
+    g = (g + CGM_REDUCE_BLOCK - 1) / CGM_REDUCE_BLOCK * CGM_REDUCE_BLOCK;
+    return (g > CGM_REDUCE_GRAIN) ? g : CGM_REDUCE_GRAIN;
+}
+
+CGMINLINE void gmReducePairwise(const vec3 *p, size_t n, gmReduceBlockFn fn, const void *arg, int k, float *acc)
+{
+    if(n <= CGM_REDUCE_BLOCK)
+    {
+        fn(p, n, arg, acc);
+        return;
+    }
+
+    float r[CGM_REDUCE_SLOTS];
+    size_t h = n / 2;
+    gmReducePairwise(p, h, fn, arg, k, acc);
+    gmReducePairwise(p + h, n - h, fn, arg, k, r);
+    for(int i = 0; i < k; i++)
+    {
+        acc[i] += r[i];
+    }
+}
+
+/* pairwise sum of chunk results [b, e) */
+CGMINLINE void gmReduceCombine(float (*part)[CGM_REDUCE_SLOTS], size_t b, size_t e, int k, float *acc)
+{
+    if(e - b == 1)
+    {
+        for(int i = 0; i < k; i++)
+        {
+            acc[i] = part[b][i];
+        }
+        return;
+    }
+
+    float r[CGM_REDUCE_SLOTS];
+    size_t h = b + (e - b) / 2;
+    gmReduceCombine(part, b, h, k, acc);
+    gmReduceCombine(part, h, e, k, r);
+    for(int i = 0; i < k; i++)
+    {
+        acc[i] += r[i];
+    }
+}
+
+typedef struct
+{
+    const vec3 *p;
+    size_t grain;
+    gmReduceBlockFn fn;
+    const void *arg;
+    int k;
+    float part[CGM_REDUCE_CHUNKS][CGM_REDUCE_SLOTS];
+} gmReduceJob;
+
+CGMINLINE void gmReduceTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmReduceJob *j = (gmReduceJob *)ctx;
+    (void)thread;
+    gmReducePairwise(j->p + b, e - b, j->fn, j->arg, j->k, j->part[b / j->grain]);
+}
+
+/*
+ * @brief runs `fn` over the whole cloud and adds the results pairwise
+ */
+CGMINLINE void gmReduce(const vec3 *p, size_t n, gmReduceBlockFn fn, const void *arg, int k, float *out)
+{
+    gmReduceJob j;
+    j.p = p;
+    j.grain = gmReduceGrain(n);
+    j.fn = fn;
+    j.arg = arg;
+    j.k = k;
+
+    if(n == 0)
+    {
+        for(int i = 0; i < k; i++)
+        {
+            out[i] = 0.0f;
+        }
+        return;
+    }
+
+    gmParallelFor(n, j.grain, gmReduceTask, &j);
+    gmReduceCombine(j.part, 0, (n + j.grain - 1) / j.grain, k, out);
+}
+
+/*
+ * @brief copies up to `CGM_REDUCE_BLOCK` points to SoA
+ */
+CGMINLINE void gmReduceLoadBlock(const vec3 *p, size_t n, float *x, float *y, float *z)
+{
+    for(size_t i = 0; i < n; i++)
+    {
+        x[i] = p[i].x;
+        y[i] = p[i].y;
+        z[i] = p[i].z;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* sum / centroid                                                              */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * the points are read as a flat float stream: `CGM_SIMD_WIDTH` points are
+ * three registers, and lane l of register r always holds component
+ * (r * CGM_SIMD_WIDTH + l) % 3, so no shuffles are needed until the end.
+ */
+CGMINLINE void gmPointsSumBlock(const vec3 *p, size_t n, const void *arg, float *acc)
+{
+    const float *f = (const float *)p;
+    simdf a0 = gmSimdzero();
+    simdf a1 = gmSimdzero();
+    simdf a2 = gmSimdzero();
+    float l[3 * CGM_SIMD_WIDTH];
+    size_t i = 0;
+    (void)arg;
+
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        a0 = gmSimdadd(a0, gmSimdload(f + 3 * i));
+        a1 = gmSimdadd(a1, gmSimdload(f + 3 * i + CGM_SIMD_WIDTH));
+        a2 = gmSimdadd(a2, gmSimdload(f + 3 * i + 2 * CGM_SIMD_WIDTH));
+    }
+
+    gmSimdstore(l, a0);
+    gmSimdstore(l + CGM_SIMD_WIDTH, a1);
+    gmSimdstore(l + 2 * CGM_SIMD_WIDTH, a2);
+    acc[0] = acc[1] = acc[2] = 0.0f;
+    for(int c = 0; c < 3 * CGM_SIMD_WIDTH; c++)
+    {
+        acc[c % 3] += l[c];
+    }
+
+    for(; i < n; i++)
+    {
+        acc[0] += p[i].x;
+        acc[1] += p[i].y;
+        acc[2] += p[i].z;
+    }
+}
+
+/**
+ * @brief sum of all points
+ */
+CGMINLINE vec3 gmPointsSum(const vec3 *p, size_t n)
+{
+    float s[CGM_REDUCE_SLOTS];
+    gmReduce(p, n, gmPointsSumBlock, NULL, 3, s);
+    return gmVec3(s[0], s[1], s[2]);
+}
+
+/**
+ * @brief mean of all points, `CGM_VEC3_ZERO` if `n` is 0
+ */
+CGMINLINE vec3 gmPointsCentroid(const vec3 *p, size_t n)
+{
+    return (n == 0) ? CGM_VEC3_ZERO : gmVec3mulScale(gmPointsSum(p, n), 1.0f / (float)n);
+}
+
+/* -------------------------------------------------------------------------- */
+/* covariance                                                                  */
+/* -------------------------------------------------------------------------- */
+
+/* acc = sum of xx, xy, xz, yy, yz, zz around the centroid in `arg` */
+CGMINLINE void gmPointsCovarianceBlock(const vec3 *p, size_t n, const void *arg, float *acc)
+{
+    const vec3 *c = (const vec3 *)arg;
+    float x[CGM_REDUCE_BLOCK], y[CGM_REDUCE_BLOCK], z[CGM_REDUCE_BLOCK];
+    simdf cx = gmSimdsplat(c->x), cy = gmSimdsplat(c->y), cz = gmSimdsplat(c->z);
+    simdf s[6];
+    float l[CGM_SIMD_WIDTH];
+    size_t i = 0;
+
+    gmReduceLoadBlock(p, n, x, y, z);
+    for(int k = 0; k < 6; k++)
+    {
+        s[k] = gmSimdzero();
+    }
+
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        simdf dx = gmSimdsub(gmSimdload(x + i), cx);
+        simdf dy = gmSimdsub(gmSimdload(y + i), cy);
+        simdf dz = gmSimdsub(gmSimdload(z + i), cz);
+        s[0] = gmSimdfma(dx, dx, s[0]);
+        s[1] = gmSimdfma(dx, dy, s[1]);
+        s[2] = gmSimdfma(dx, dz, s[2]);
+        s[3] = gmSimdfma(dy, dy, s[3]);
+        s[4] = gmSimdfma(dy, dz, s[4]);
+        s[5] = gmSimdfma(dz, dz, s[5]);
+    }
+
+    for(int k = 0; k < 6; k++)
+    {
+        gmSimdstore(l, s[k]);
+        acc[k] = 0.0f;
+        for(int m = 0; m < CGM_SIMD_WIDTH; m++)
+        {
+            acc[k] += l[m];
+        }
+    }
+
+    for(; i < n; i++)
+    {
+        float dx = x[i] - c->x, dy = y[i] - c->y, dz = z[i] - c->z;
+        acc[0] += dx * dx;
+        acc[1] += dx * dy;
+        acc[2] += dx * dz;
+        acc[3] += dy * dy;
+        acc[4] += dy * dz;
+        acc[5] += dz * dz;
+    }
+}
+
+/**
+ * @brief covariance matrix of the points (divided by n)
+ *
+ * two passes: the centroid first, then the products of the centered
+ * points, which avoids the cancellation of the one-pass formula on clouds
+ * far from the origin.
+ *
+ * @param centroid optional output for the mean (may be NULL)
+ */
+CGMINLINE mat3 gmPointsCovariance(const vec3 *p, size_t n, vec3 *centroid)
+{
+    vec3 c = gmPointsCentroid(p, n);
+    float s[CGM_REDUCE_SLOTS];
+    float inv = (n == 0) ? 0.0f : 1.0f / (float)n;
+
+    gmReduce(p, n, gmPointsCovarianceBlock, &c, 6, s);
+    if(centroid)
+    {
+        *centroid = c;
+    }
+
+    return gmMat3fromCols(
+        gmVec3(s[0] * inv, s[1] * inv, s[2] * inv),
+        gmVec3(s[1] * inv, s[3] * inv, s[4] * inv),
+        gmVec3(s[2] * inv, s[4] * inv, s[5] * inv)
+    );
+}
+
+/* -------------------------------------------------------------------------- */
+/* bounds                                                                      */
+/* -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    const vec3 *p;
+    size_t grain;
+    float lo[CGM_REDUCE_CHUNKS][3];
+    float hi[CGM_REDUCE_CHUNKS][3];
+} gmPointsBoundsJob;
+
+CGMINLINE void gmPointsBoundsTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmPointsBoundsJob *j = (gmPointsBoundsJob *)ctx;
+    const float *f = (const float *)(j->p + b);
+    size_t n = e - b, c = b / j->grain, i = 0;
+    simdf l0 = gmSimdsplat(FLT_MAX), l1 = l0, l2 = l0;
+    simdf h0 = gmSimdsplat(-FLT_MAX), h1 = h0, h2 = h0;
+    float l[3 * CGM_SIMD_WIDTH], h[3 * CGM_SIMD_WIDTH];
+    (void)thread;
+
+    /* same lane layout as gmPointsSumBlock */
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        simdf v0 = gmSimdload(f + 3 * i);
+        simdf v1 = gmSimdload(f + 3 * i + CGM_SIMD_WIDTH);
+        simdf v2 = gmSimdload(f + 3 * i + 2 * CGM_SIMD_WIDTH);
+        l0 = gmSimdmin(l0, v0);
+        l1 = gmSimdmin(l1, v1);
+        l2 = gmSimdmin(l2, v2);
+        h0 = gmSimdmax(h0, v0);
+        h1 = gmSimdmax(h1, v1);
+        h2 = gmSimdmax(h2, v2);
+    }
+
+    gmSimdstore(l, l0);
+    gmSimdstore(l + CGM_SIMD_WIDTH, l1);
+    gmSimdstore(l + 2 * CGM_SIMD_WIDTH, l2);
+    gmSimdstore(h, h0);
+    gmSimdstore(h + CGM_SIMD_WIDTH, h1);
+    gmSimdstore(h + 2 * CGM_SIMD_WIDTH, h2);
+    for(int k = 0; k < 3; k++)
+    {
+        j->lo[c][k] = FLT_MAX;
+        j->hi[c][k] = -FLT_MAX;
+    }
+    for(int k = 0; k < 3 * CGM_SIMD_WIDTH; k++)
+    {
+        j->lo[c][k % 3] = GMMIN(j->lo[c][k % 3], l[k]);
+        j->hi[c][k % 3] = GMMAX(j->hi[c][k % 3], h[k]);
+    }
+
+    for(; i < n; i++)
+    {
+        const float *q = f + 3 * i;
+        for(int k = 0; k < 3; k++)
+        {
+            j->lo[c][k] = GMMIN(j->lo[c][k], q[k]);
+            j->hi[c][k] = GMMAX(j->hi[c][k], q[k]);
+        }
+    }
+}
+
+/**
+ * @brief axis-aligned bounding box of the points
+ *
+ * for `n` == 0, `min` is FLT_MAX and `max` is -FLT_MAX on every axis.
+ */
+CGMINLINE void gmPointsBounds(const vec3 *p, size_t n, vec3 *min, vec3 *max)
+{
+    gmPointsBoundsJob j;
+    float lo[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+    float hi[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    j.p = p;
+    j.grain = gmReduceGrain(n);
+
+    gmParallelFor(n, j.grain, gmPointsBoundsTask, &j);
+    for(size_t c = 0; c < (n + j.grain - 1) / j.grain; c++)
+    {
+        for(int k = 0; k < 3; k++)
+        {
+            lo[k] = GMMIN(lo[k], j.lo[c][k]);
+            hi[k] = GMMAX(hi[k], j.hi[c][k]);
+        }
+    }
+
+    *min = gmVec3(lo[0], lo[1], lo[2]);
+    *max = gmVec3(hi[0], hi[1], hi[2]);
+}
+
+/* -------------------------------------------------------------------------- */
+/* extent along a direction                                                    */
+/* -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    const vec3 *p;
+    size_t grain;
+    vec3 d;
+    float lo[CGM_REDUCE_CHUNKS];
+    float hi[CGM_REDUCE_CHUNKS];
+    size_t ilo[CGM_REDUCE_CHUNKS];
+    size_t ihi[CGM_REDUCE_CHUNKS];
+} gmPointsExtentJob;
+
+CGMINLINE void gmPointsExtentTask(void *ctx, size_t b, size_t e, int thread)
+{
+    static const int32_t iota[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    gmPointsExtentJob *j = (gmPointsExtentJob *)ctx;
+    float x[CGM_REDUCE_BLOCK], y[CGM_REDUCE_BLOCK], z[CGM_REDUCE_BLOCK];
+    float lv[CGM_SIMD_WIDTH], hv[CGM_SIMD_WIDTH];
+    int32_t li[CGM_SIMD_WIDTH], hi[CGM_SIMD_WIDTH];
+    simdf dx = gmSimdsplat(j->d.x), dy = gmSimdsplat(j->d.y), dz = gmSimdsplat(j->d.z);
+    simdf lo = gmSimdsplat(FLT_MAX), up = gmSimdsplat(-FLT_MAX);
+    simdi ilo = gmSimdisplat(0), ihi = gmSimdisplat(0);
+    size_t c = b / j->grain;
+    float slo = FLT_MAX, shi = -FLT_MAX;
+    size_t sli = b, shi_i = b;
+    (void)thread;
+
+    /* indices are relative to `b`, one chunk is far below 2^31 points */
+    for(size_t o = b; o < e; o += CGM_REDUCE_BLOCK)
+    {
+        size_t n = GMMIN((size_t)CGM_REDUCE_BLOCK, e - o), i = 0;
+        simdi idx = gmSimdiadd(gmSimdiload(iota), gmSimdisplat((int32_t)(o - b)));
+        gmReduceLoadBlock(j->p + o, n, x, y, z);
+
+        for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+        {
+            simdf v = gmSimdmul(gmSimdload(x + i), dx);
+            v = gmSimdfma(gmSimdload(y + i), dy, v);
+            v = gmSimdfma(gmSimdload(z + i), dz, v);
+
+            simdf ml = gmSimdlt(v, lo);
+            simdf mh = gmSimdlt(up, v);
+            lo = gmSimdselect(ml, v, lo);
+            up = gmSimdselect(mh, v, up);
+            ilo = gmSimdiselect(gmSimdasi(ml), idx, ilo);
+            ihi = gmSimdiselect(gmSimdasi(mh), idx, ihi);
+            idx = gmSimdiadd(idx, gmSimdisplat(CGM_SIMD_WIDTH));
+        }
+
+        for(; i < n; i++)
+        {
+            float v = x[i] * j->d.x + y[i] * j->d.y + z[i] * j->d.z;
+            if(v < slo)
+            {
+                slo = v;
+                sli = o + i;
+            }
+            if(v > shi)
+            {
+                shi = v;
+                shi_i = o + i;
+            }
+        }
+    }
+
+    /* fold lanes, ties go to the lowest index */
+    gmSimdstore(lv, lo);
+    gmSimdstore(hv, up);
+    gmSimdistore(li, ilo);
+    gmSimdistore(hi, ihi);
+    for(int k = 0; k < CGM_SIMD_WIDTH; k++)
+    {
+        size_t il = b + (size_t)li[k], ih = b + (size_t)hi[k];
+        if(lv[k] < slo || (lv[k] == slo && il < sli))
+        {
+            slo = lv[k];
+            sli = il;
+        }
+        if(hv[k] > shi || (hv[k] == shi && ih < shi_i))
+        {
+            shi = hv[k];
+            shi_i = ih;
+        }
+    }
+
+    j->lo[c] = slo;
+    j->hi[c] = shi;
+    j->ilo[c] = sli;
+    j->ihi[c] = shi_i;
+}
+
+/**
+ * @brief minimum and maximum of dot(p[i], d)
+ *
+ * gives the extent of the cloud along `d` (projection interval, support
+ * points for GJK / OBB fitting). ties resolve to the lowest index.
+ *
+ * @param d direction (not required to be normalized)
+ * @param min, max projected extent
+ * @param imin, imax optional indices of the extreme points (may be NULL)
+ */
+CGMINLINE void gmPointsExtent(const vec3 *p, size_t n, vec3 d, float *min, float *max, size_t *imin, size_t *imax)
+{
+    gmPointsExtentJob j;
+    float lo = FLT_MAX, hi = -FLT_MAX;
+    size_t il = 0, ih = 0;
+    j.p = p;
+    j.grain = gmReduceGrain(n);
+    j.d = d;
+
+    gmParallelFor(n, j.grain, gmPointsExtentTask, &j);
+    for(size_t c = 0; c < (n + j.grain - 1) / j.grain; c++)
+    {
+        if(j.lo[c] < lo)
+        {
+            lo = j.lo[c];
+            il = j.ilo[c];
+        }
+        if(j.hi[c] > hi)
+        {
+            hi = j.hi[c];
+            ih = j.ihi[c];
+        }
+    }
+
+    *min = lo;
+    *max = hi;
+    if(imin)
+    {
+        *imin = il;
+    }
+    if(imax)
+    {
+        *imax = ih;
+    }
+}
+
+#endif
@@ -0,0 +1,354 @@
+#ifndef SIMD_GRAPHICS_MATH
+#define SIMD_GRAPHICS_MATH
+
+/**
+ * @file simd.h
+ * @brief thin wrapper over the widest vector unit enabled at compile time
+ *
+ * `simdf` / `simdi` hold `CGM_SIMD_WIDTH` floats / int32 lanes:
+ *  8 with AVX2, 4 with SSE2, 1 otherwise (plain scalar code).
+ * masks are `simdf` values with all bits set in the true lanes.
+ *
+ * `simd4f` is always 4 lanes (one mat4 column / vec4).
+ *
+ * macros:
+ *  `CGM_NO_SIMD`: force the scalar path
+ */
+
+#include "../core.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#if !defined(CGM_NO_SIMD) && defined(__AVX2__)
+#define CGM_SIMD_AVX2 1
+#define CGM_SIMD_SSE  1
+#define CGM_SIMD_WIDTH 8
+#include <immintrin.h>
+#elif !defined(CGM_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define CGM_SIMD_SSE  1
+#define CGM_SIMD_WIDTH 4
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#if defined(__FMA__)
+#include <immintrin.h> /* FMA without AVX2, e.g. -march=bdver2 */
+#endif
+#else
+#define CGM_SIMD_WIDTH 1
+#endif
+
+#if defined(__GNUC__)
+#define CGM_PREFETCH(p) __builtin_prefetch((p))
+#else
+#define CGM_PREFETCH(p) ((void)(p))
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* wide float / int lanes                                                      */
+/* -------------------------------------------------------------------------- */
+
+#if defined(CGM_SIMD_AVX2)
+
+typedef __m256  simdf;
+typedef __m256i simdi;
+
+CGMINTRINSIC simdf gmSimdload(const float *p)          { return _mm256_loadu_ps(p); }
+CGMINTRINSIC void  gmSimdstore(float *p, simdf v)      { _mm256_storeu_ps(p, v); }
+CGMINTRINSIC void  gmSimdstream(float *p, simdf v)     { _mm256_stream_ps(p, v); }
+CGMINTRINSIC simdf gmSimdsplat(float v)                { return _mm256_set1_ps(v); }
+CGMINTRINSIC simdf gmSimdzero(void)                    { return _mm256_setzero_ps(); }
+CGMINTRINSIC simdf gmSimdadd(simdf a, simdf b)         { return _mm256_add_ps(a, b); }
+CGMINTRINSIC simdf gmSimdsub(simdf a, simdf b)         { return _mm256_sub_ps(a, b); }
+CGMINTRINSIC simdf gmSimdmul(simdf a, simdf b)         { return _mm256_mul_ps(a, b); }
+CGMINTRINSIC simdf gmSimddiv(simdf a, simdf b)         { return _mm256_div_ps(a, b); }
+CGMINTRINSIC simdf gmSimdmin(simdf a, simdf b)         { return _mm256_min_ps(a, b); }
+CGMINTRINSIC simdf gmSimdmax(simdf a, simdf b)         { return _mm256_max_ps(a, b); }
+CGMINTRINSIC simdf gmSimdsqrt(simdf a)                 { return _mm256_sqrt_ps(a); }
+CGMINTRINSIC simdf gmSimdrsqrtest(simdf a)             { return _mm256_rsqrt_ps(a); }
+CGMINTRINSIC simdf gmSimdfloor(simdf a)                { return _mm256_floor_ps(a); }
+CGMINTRINSIC simdf gmSimdand(simdf a, simdf b)         { return _mm256_and_ps(a, b); }
+CGMINTRINSIC simdf gmSimdor(simdf a, simdf b)          { return _mm256_or_ps(a, b); }
+CGMINTRINSIC simdf gmSimdxor(simdf a, simdf b)         { return _mm256_xor_ps(a, b); }
+CGMINTRINSIC simdf gmSimdandnot(simdf a, simdf b)      { return _mm256_andnot_ps(a, b); }
+CGMINTRINSIC simdf gmSimdlt(simdf a, simdf b)          { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+CGMINTRINSIC simdf gmSimdle(simdf a, simdf b)          { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+CGMINTRINSIC simdf gmSimdeq(simdf a, simdf b)          { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+CGMINTRINSIC simdf gmSimdselect(simdf m, simdf a, simdf b) { return _mm256_blendv_ps(b, a, m); }
+CGMINTRINSIC int   gmSimdmask(simdf m)                 { return _mm256_movemask_ps(m); }
+
+CGMINTRINSIC simdf gmSimdfma(simdf a, simdf b, simdf c)
+{
+#if defined(__FMA__)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+CGMINTRINSIC simdi gmSimdiload(const int32_t *p)       { return _mm256_loadu_si256((const __m256i *)p); }
+CGMINTRINSIC void  gmSimdistore(int32_t *p, simdi v)   { _mm256_storeu_si256((__m256i *)p, v); }
+CGMINTRINSIC simdi gmSimdisplat(int32_t v)             { return _mm256_set1_epi32(v); }
+CGMINTRINSIC simdi gmSimdiadd(simdi a, simdi b)        { return _mm256_add_epi32(a, b); }
+CGMINTRINSIC simdi gmSimdisub(simdi a, simdi b)        { return _mm256_sub_epi32(a, b); }
+CGMINTRINSIC simdi gmSimdimul(simdi a, simdi b)        { return _mm256_mullo_epi32(a, b); }
+CGMINTRINSIC simdi gmSimdiand(simdi a, simdi b)        { return _mm256_and_si256(a, b); }
+CGMINTRINSIC simdi gmSimdior(simdi a, simdi b)         { return _mm256_or_si256(a, b); }
+CGMINTRINSIC simdi gmSimdixor(simdi a, simdi b)        { return _mm256_xor_si256(a, b); }
+CGMINTRINSIC simdi gmSimdisra(simdi a, int s)          { return _mm256_sra_epi32(a, _mm_cvtsi32_si128(s)); }
+CGMINTRINSIC simdi gmSimdisrl(simdi a, int s)          { return _mm256_srl_epi32(a, _mm_cvtsi32_si128(s)); }
+CGMINTRINSIC simdi gmSimdisll(simdi a, int s)          { return _mm256_sll_epi32(a, _mm_cvtsi32_si128(s)); }
+CGMINTRINSIC simdi gmSimdiandnot(simdi a, simdi b)     { return _mm256_andnot_si256(a, b); }
+CGMINTRINSIC simdi gmSimdieq(simdi a, simdi b)         { return _mm256_cmpeq_epi32(a, b); }
+CGMINTRINSIC simdi gmSimdigt(simdi a, simdi b)         { return _mm256_cmpgt_epi32(a, b); }
+CGMINTRINSIC simdi gmSimditrunc(simdf a)               { return _mm256_cvttps_epi32(a); }
+CGMINTRINSIC simdi gmSimdiround(simdf a)               { return _mm256_cvtps_epi32(a); }
+CGMINTRINSIC simdf gmSimditof(simdi a)                 { return _mm256_cvtepi32_ps(a); }
+CGMINTRINSIC simdf gmSimdasf(simdi a)                  { return _mm256_castsi256_ps(a); }
+CGMINTRINSIC simdi gmSimdasi(simdf a)                  { return _mm256_castps_si256(a); }
+
+#elif defined(CGM_SIMD_SSE)
+
+typedef __m128  simdf;
+typedef __m128i simdi;
+
+CGMINTRINSIC simdf gmSimdload(const float *p)          { return _mm_loadu_ps(p); }
+CGMINTRINSIC void  gmSimdstore(float *p, simdf v)      { _mm_storeu_ps(p, v); }
+CGMINTRINSIC void  gmSimdstream(float *p, simdf v)     { _mm_stream_ps(p, v); }
+CGMINTRINSIC simdf gmSimdsplat(float v)                { return _mm_set1_ps(v); }
+CGMINTRINSIC simdf gmSimdzero(void)                    { return _mm_setzero_ps(); }
+CGMINTRINSIC simdf gmSimdadd(simdf a, simdf b)         { return _mm_add_ps(a, b); }
+CGMINTRINSIC simdf gmSimdsub(simdf a, simdf b)         { return _mm_sub_ps(a, b); }
+CGMINTRINSIC simdf gmSimdmul(simdf a, simdf b)         { return _mm_mul_ps(a, b); }
+CGMINTRINSIC simdf gmSimddiv(simdf a, simdf b)         { return _mm_div_ps(a, b); }
+CGMINTRINSIC simdf gmSimdmin(simdf a, simdf b)         { return _mm_min_ps(a, b); }
+CGMINTRINSIC simdf gmSimdmax(simdf a, simdf b)         { return _mm_max_ps(a, b); }
+CGMINTRINSIC simdf gmSimdsqrt(simdf a)                 { return _mm_sqrt_ps(a); }
+CGMINTRINSIC simdf gmSimdrsqrtest(simdf a)             { return _mm_rsqrt_ps(a); }
+CGMINTRINSIC simdf gmSimdand(simdf a, simdf b)         { return _mm_and_ps(a, b); }
+CGMINTRINSIC simdf gmSimdor(simdf a, simdf b)          { return _mm_or_ps(a, b); }
+CGMINTRINSIC simdf gmSimdxor(simdf a, simdf b)         { return _mm_xor_ps(a, b); }
+CGMINTRINSIC simdf gmSimdandnot(simdf a, simdf b)      { return _mm_andnot_ps(a, b); }
+CGMINTRINSIC simdf gmSimdlt(simdf a, simdf b)          { return _mm_cmplt_ps(a, b); }
+CGMINTRINSIC simdf gmSimdle(simdf a, simdf b)          { return _mm_cmple_ps(a, b); }
+CGMINTRINSIC simdf gmSimdeq(simdf a, simdf b)          { return _mm_cmpeq_ps(a, b); }
+CGMINTRINSIC int   gmSimdmask(simdf m)                 { return _mm_movemask_ps(m); }
+
+CGMINTRINSIC simdf gmSimdselect(simdf m, simdf a, simdf b)
+{
+#if defined(__SSE4_1__)
+    return _mm_blendv_ps(b, a, m);
+#else
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+#endif
+}
+
+CGMINTRINSIC simdf gmSimdfloor(simdf a)
+{
+#if defined(__SSE4_1__)
+    return _mm_floor_ps(a);
+#else
+    /* valid for |a| < 2^31 */
+    simdf t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(1.0f)));
+#endif
+}
+
+CGMINTRINSIC simdf gmSimdfma(simdf a, simdf b, simdf c)
+{
+#if defined(__FMA__)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+CGMINTRINSIC simdi gmSimdiload(const int32_t *p)       { return _mm_loadu_si128((const __m128i *)p); }
+CGMINTRINSIC void  gmSimdistore(int32_t *p, simdi v)   { _mm_storeu_si128((__m128i *)p, v); }
+CGMINTRINSIC simdi gmSimdisplat(int32_t v)             { return _mm_set1_epi32(v); }
+CGMINTRINSIC simdi gmSimdiadd(simdi a, simdi b)        { return _mm_add_epi32(a, b); }
+CGMINTRINSIC simdi gmSimdisub(simdi a, simdi b)        { return _mm_sub_epi32(a, b); }
+CGMINTRINSIC simdi gmSimdiand(simdi a, simdi b)        { return _mm_and_si128(a, b); }
+CGMINTRINSIC simdi gmSimdior(simdi a, simdi b)         { return _mm_or_si128(a, b); }
+CGMINTRINSIC simdi gmSimdixor(simdi a, simdi b)        { return _mm_xor_si128(a, b); }
+CGMINTRINSIC simdi gmSimdisra(simdi a, int s)          { return _mm_sra_epi32(a, _mm_cvtsi32_si128(s)); }
+CGMINTRINSIC simdi gmSimdisrl(simdi a, int s)          { return _mm_srl_epi32(a, _mm_cvtsi32_si128(s)); }
+CGMINTRINSIC simdi gmSimdisll(simdi a, int s)          { return _mm_sll_epi32(a, _mm_cvtsi32_si128(s)); }
+CGMINTRINSIC simdi gmSimdiandnot(simdi a, simdi b)     { return _mm_andnot_si128(a, b); }
+CGMINTRINSIC simdi gmSimdieq(simdi a, simdi b)         { return _mm_cmpeq_epi32(a, b); }
+CGMINTRINSIC simdi gmSimdigt(simdi a, simdi b)         { return _mm_cmpgt_epi32(a, b); }
+CGMINTRINSIC simdi gmSimditrunc(simdf a)               { return _mm_cvttps_epi32(a); }
+CGMINTRINSIC simdi gmSimdiround(simdf a)               { return _mm_cvtps_epi32(a); }
+CGMINTRINSIC simdf gmSimditof(simdi a)                 { return _mm_cvtepi32_ps(a); }
+CGMINTRINSIC simdf gmSimdasf(simdi a)                  { return _mm_castsi128_ps(a); }
+CGMINTRINSIC simdi gmSimdasi(simdf a)                  { return _mm_castps_si128(a); }
+
+CGMINTRINSIC simdi gmSimdimul(simdi a, simdi b)
+{
+#if defined(__SSE4_1__)
+    return _mm_mullo_epi32(a, b);
+#else
+    __m128i ev = _mm_mul_epu32(a, b);
+    __m128i od = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(ev, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(od, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+}
+
+#else
+
+typedef float   simdf;
+typedef int32_t simdi;
+
+CGMINTRINSIC simdf gmSimdasf(simdi a)                  { simdf r; memcpy(&r, &a, 4); return r; }
+CGMINTRINSIC simdi gmSimdasi(simdf a)                  { simdi r; memcpy(&r, &a, 4); return r; }
+
+CGMINTRINSIC simdf gmSimdload(const float *p)          { return *p; }
+CGMINTRINSIC void  gmSimdstore(float *p, simdf v)      { *p = v; }
+CGMINTRINSIC void  gmSimdstream(float *p, simdf v)     { *p = v; }
+CGMINTRINSIC simdf gmSimdsplat(float v)                { return v; }
+CGMINTRINSIC simdf gmSimdzero(void)                    { return 0.0f; }
+CGMINTRINSIC simdf gmSimdadd(simdf a, simdf b)         { return a + b; }
+CGMINTRINSIC simdf gmSimdsub(simdf a, simdf b)         { return a - b; }
+CGMINTRINSIC simdf gmSimdmul(simdf a, simdf b)         { return a * b; }
+CGMINTRINSIC simdf gmSimddiv(simdf a, simdf b)         { return a / b; }
+CGMINTRINSIC simdf gmSimdmin(simdf a, simdf b)         { return (a < b) ? a : b; }
+CGMINTRINSIC simdf gmSimdmax(simdf a, simdf b)         { return (a > b) ? a : b; }
+CGMINTRINSIC simdf gmSimdsqrt(simdf a)                 { return sqrtf(a); }
+CGMINTRINSIC simdf gmSimdrsqrtest(simdf a)             { return 1.0f / sqrtf(a); }
+CGMINTRINSIC simdf gmSimdfloor(simdf a)                { return floorf(a); }
+CGMINTRINSIC simdf gmSimdfma(simdf a, simdf b, simdf c) { return a * b + c; }
+CGMINTRINSIC simdf gmSimdand(simdf a, simdf b)         { return gmSimdasf(gmSimdasi(a) & gmSimdasi(b)); }
+CGMINTRINSIC simdf gmSimdor(simdf a, simdf b)          { return gmSimdasf(gmSimdasi(a) | gmSimdasi(b)); }
+CGMINTRINSIC simdf gmSimdxor(simdf a, simdf b)         { return gmSimdasf(gmSimdasi(a) ^ gmSimdasi(b)); }
+CGMINTRINSIC simdf gmSimdandnot(simdf a, simdf b)      { return gmSimdasf(~gmSimdasi(a) & gmSimdasi(b)); }
+CGMINTRINSIC simdf gmSimdlt(simdf a, simdf b)          { return gmSimdasf((a < b) ? -1 : 0); }
+CGMINTRINSIC simdf gmSimdle(simdf a, simdf b)          { return gmSimdasf((a <= b) ? -1 : 0); }
+CGMINTRINSIC simdf gmSimdeq(simdf a, simdf b)          { return gmSimdasf((a == b) ? -1 : 0); }
+CGMINTRINSIC simdf gmSimdselect(simdf m, simdf a, simdf b) { return gmSimdasi(m) ? a : b; }
+CGMINTRINSIC int   gmSimdmask(simdf m)                 { return gmSimdasi(m) < 0; }
+
+CGMINTRINSIC simdi gmSimdiload(const int32_t *p)       { return *p; }
+CGMINTRINSIC void  gmSimdistore(int32_t *p, simdi v)   { *p = v; }
+CGMINTRINSIC simdi gmSimdisplat(int32_t v)             { return v; }
+CGMINTRINSIC simdi gmSimdiadd(simdi a, simdi b)        { return (simdi)((uint32_t)a + (uint32_t)b); }
+CGMINTRINSIC simdi gmSimdisub(simdi a, simdi b)        { return (simdi)((uint32_t)a - (uint32_t)b); }
+CGMINTRINSIC simdi gmSimdimul(simdi a, simdi b)        { return (simdi)((uint32_t)a * (uint32_t)b); }
+CGMINTRINSIC simdi gmSimdiand(simdi a, simdi b)        { return a & b; }
+CGMINTRINSIC simdi gmSimdior(simdi a, simdi b)         { return a | b; }
+CGMINTRINSIC simdi gmSimdixor(simdi a, simdi b)        { return a ^ b; }
+CGMINTRINSIC simdi gmSimdisra(simdi a, int s)          { return a >> s; }
+CGMINTRINSIC simdi gmSimdisrl(simdi a, int s)          { return (simdi)((uint32_t)a >> s); }
+CGMINTRINSIC simdi gmSimdisll(simdi a, int s)          { return (simdi)((uint32_t)a << s); }
+CGMINTRINSIC simdi gmSimdiandnot(simdi a, simdi b)     { return ~a & b; }
+CGMINTRINSIC simdi gmSimdieq(simdi a, simdi b)         { return (a == b) ? -1 : 0; }
+CGMINTRINSIC simdi gmSimdigt(simdi a, simdi b)         { return (a > b) ? -1 : 0; }
+CGMINTRINSIC simdi gmSimditrunc(simdf a)               { return (simdi)a; }
+CGMINTRINSIC simdi gmSimdiround(simdf a)               { return (simdi)lrintf(a); }
+CGMINTRINSIC simdf gmSimditof(simdi a)                 { return (simdf)a; }
+
+#endif
+
+/**
+ * @brief absolute value per lane
+ */
+CGMINTRINSIC simdf gmSimdabs(simdf a)
+{
+    return gmSimdandnot(gmSimdsplat(-0.0f), a);
+}
+
+/**
+ * @brief 1 / sqrt(a) per lane: the hardware estimate (12 bits) refined by
+ * one Newton step, within a few ulp for normal inputs. on SIMD backends
+ * a zero input gives NaN, so select such lanes away.
+ */
+CGMINTRINSIC simdf gmSimdrsqrt(simdf a)
+{
+    simdf r = gmSimdrsqrtest(a);
+#if CGM_SIMD_WIDTH > 1
+    simdf h = gmSimdmul(gmSimdmul(gmSimdsplat(0.5f), a), r);
+    r = gmSimdmul(r, gmSimdsub(gmSimdsplat(1.5f), gmSimdmul(h, r)));
+#endif
+    return r;
+}
+
+/**
+ * @brief copies the sign of `s` onto the magnitude of `a`
+ */
+CGMINTRINSIC simdf gmSimdcopysign(simdf a, simdf s)
+{
+    simdf m = gmSimdsplat(-0.0f);
+    return gmSimdor(gmSimdandnot(m, a), gmSimdand(m, s));
+}
+
+/**
+ * @brief lane-wise select on integers: m ? a : b
+ */
+CGMINTRINSIC simdi gmSimdiselect(simdi m, simdi a, simdi b)
+{
+    return gmSimdior(gmSimdiand(m, a), gmSimdiandnot(m, b));
+}
+
+/**
+ * @brief orders non-temporal stores issued with `gmSimdstream`
+ */
+CGMINTRINSIC void gmSimdfence(void)
+{
+#if defined(CGM_SIMD_SSE)
+    _mm_sfence();
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+/* fixed 4 lanes                                                               */
+/* -------------------------------------------------------------------------- */
+
+#if defined(CGM_SIMD_SSE)
+
+typedef __m128 simd4f;
+
+CGMINTRINSIC simd4f gmSimd4load(const float *p)        { return _mm_loadu_ps(p); }
+CGMINTRINSIC void   gmSimd4store(float *p, simd4f v)   { _mm_storeu_ps(p, v); }
+CGMINTRINSIC void   gmSimd4stream(float *p, simd4f v)  { _mm_stream_ps(p, v); }
+CGMINTRINSIC simd4f gmSimd4splat(float v)              { return _mm_set1_ps(v); }
+CGMINTRINSIC simd4f gmSimd4add(simd4f a, simd4f b)     { return _mm_add_ps(a, b); }
+CGMINTRINSIC simd4f gmSimd4mul(simd4f a, simd4f b)     { return _mm_mul_ps(a, b); }
+
+CGMINTRINSIC simd4f gmSimd4fma(simd4f a, simd4f b, simd4f c)
+{
+#if defined(__FMA__)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+#else
+
+typedef struct { float v[4]; } simd4f;
+
+CGMINTRINSIC simd4f gmSimd4load(const float *p)        { simd4f r; memcpy(r.v, p, sizeof(r.v)); return r; }
+CGMINTRINSIC void   gmSimd4store(float *p, simd4f v)   { memcpy(p, v.v, sizeof(v.v)); }
+CGMINTRINSIC void   gmSimd4stream(float *p, simd4f v)  { memcpy(p, v.v, sizeof(v.v)); }
+CGMINTRINSIC simd4f gmSimd4splat(float s)              { return (simd4f){{s, s, s, s}}; }
+
+CGMINTRINSIC simd4f gmSimd4add(simd4f a, simd4f b)
+{
+    return (simd4f){{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+}
+
+CGMINTRINSIC simd4f gmSimd4mul(simd4f a, simd4f b)
+{
+    return (simd4f){{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+}
+
+CGMINTRINSIC simd4f gmSimd4fma(simd4f a, simd4f b, simd4f c)
+{
+    return gmSimd4add(gmSimd4mul(a, b), c);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef STRUCT_HVEC_H
+#define STRUCT_HVEC_H
+
+#include <stdint.h>
+
+/**
+ * @brief IEEE 754 binary16 value (storage only)
+ * 
+ */
+typedef uint16_t half;
+
+typedef struct
+{
+    half x;
+    half y;
+} hvec2;
+
+typedef struct
+{
+    half x;
+    half y;
+    half z;
+} hvec3;
+
+typedef struct
+{
+    half x;
+    half y;
+    half z;
+    half w;
+} hvec4;
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef STRUCT_MAT3_H
+#define STRUCT_MAT3_H
+
+/**
+ * @brief mat3 struct (column major)
+ * 
+ */
+typedef struct 
+{
+    float m[9];
+} mat3;
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef STRUCT_MAT4X3_H
+#define STRUCT_MAT4X3_H
+
+/**
+ * @brief affine matrix: 4 columns of 3 rows (column major)
+ * 
+ * the implicit last row is (0, 0, 0, 1).
+ */
+typedef struct 
+{
+    float m[12];
+} mat4x3;
+
+#endif
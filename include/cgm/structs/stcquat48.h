@@ -0,0 +1,15 @@
+#ifndef STRUCT_QUAT48_H
+#define STRUCT_QUAT48_H
+
+#include <stdint.h>
+
+/**
+ * @brief 48 bit smallest-three quaternion (3 x 16 bit words)
+ * 
+ */
+typedef struct
+{
+    uint16_t v[3];
+} quat48;
+
+#endif
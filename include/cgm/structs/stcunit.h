@@ -0,0 +1,24 @@
+#ifndef STRUCT_UNIT_H
+#define STRUCT_UNIT_H
+
+#include "stcvec2.h"
+#include "stcvec3.h"
+
+/**
+ * @brief unit-length vectors
+ *
+ * wrapping the vector in a struct makes these distinct types: a plain
+ * vec2/vec3 is not accepted where a unit vector is expected. build them
+ * with the normalizing constructors in unit.h, read the vector through `.v`.
+ */
+typedef struct
+{
+    vec2 v;
+} unitvec2;
+
+typedef struct
+{
+    vec3 v;
+} unitvec3;
+
+#endif
\ No newline at end of file
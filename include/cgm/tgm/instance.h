@@ -0,0 +1,325 @@
+#ifndef INSTANCE_GRAPHICS_MATH
+#define INSTANCE_GRAPHICS_MATH
+
+/**
+ * @file instance.h
+ * batch matrix generation for instanced rendering
+ */
+
+#include "../mat3.h"
+#include "../mat4.h"
+#include "../quat.h"
+#include "../sgm/simd.h"
+#include "../jgm/job.h"
+#include "../structs/stcmat4x3.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef CGM_STREAM_THRESHOLD
+/*
+ * @brief `CGM_STREAM_THRESHOLD`
+ * number of output matrices above which batch kernels write with
+ * non-temporal stores, so large uploads do not evict the cache.
+ *
+ * default: 16384 (1 MiB of mat4)
+ */
+#define CGM_STREAM_THRESHOLD 16384
+#endif
+
+/**
+ * @brief model matrix from translation, rotation and scale (T * R * S)
+ * @param t translation
+ * @param r rotation (unit quaternion)
+ * @param s scale
+ */
+CGMINLINE mat4 gmMat4fromTRS(vec3 t, quat r, vec3 s)
+{
+    mat3 rm = gmMat3fromQuat(r);
+    mat4 m = CGM_MAT4_INIT;
+
+    m.m[0]  = rm.m[0] * s.x; m.m[1]  = rm.m[1] * s.x; m.m[2]  = rm.m[2] * s.x;
+    m.m[4]  = rm.m[3] * s.y; m.m[5]  = rm.m[4] * s.y; m.m[6]  = rm.m[5] * s.y;
+    m.m[8]  = rm.m[6] * s.z; m.m[9]  = rm.m[7] * s.z; m.m[10] = rm.m[8] * s.z;
+    m.m[12] = t.x;
+    m.m[13] = t.y;
+    m.m[14] = t.z;
+    m.m[15] = 1.0f;
+    return m;
+}
+
+/**
+ * @brief affine matrix from a mat4 (drops the last row)
+ */
+CGMINLINE mat4x3 gmMat4x3fromMat4(mat4 m)
+{
+    return (mat4x3){{
+        m.m[0],  m.m[1],  m.m[2],
+        m.m[4],  m.m[5],  m.m[6],
+        m.m[8],  m.m[9],  m.m[10],
+        m.m[12], m.m[13], m.m[14]
+    }};
+}
+
+/**
+ * @brief mat4 from an affine matrix
+ */
+CGMINLINE mat4 gmMat4fromMat4x3(mat4x3 a)
+{
+    return (mat4){{
+        a.m[0], a.m[1],  a.m[2],  0.0f,
+        a.m[3], a.m[4],  a.m[5],  0.0f,
+        a.m[6], a.m[7],  a.m[8],  0.0f,
+        a.m[9], a.m[10], a.m[11], 1.0f
+    }};
+}
+
+/*
+ * @brief `gmMat4mulBatch` on one range, `stream` selects non-temporal stores
+ */
+CGMINLINE void gmMat4mulBatchRange(mat4 vp, const mat4 *m, size_t n, mat4 *out, int stream)
+{
+    simd4f c0 = gmSimd4load(vp.m + 0);
+    simd4f c1 = gmSimd4load(vp.m + 4);
+    simd4f c2 = gmSimd4load(vp.m + 8);
+    simd4f c3 = gmSimd4load(vp.m + 12);
+
+    for(size_t i = 0; i < n; i++)
+    {
+        const float *a = m[i].m;
+        float *o = out[i].m;
+        CGM_PREFETCH(a + 64);
+
+        for(int j = 0; j < 4; j++)
+        {
+            simd4f r = gmSimd4mul(c0, gmSimd4splat(a[j * 4 + 0]));
+            r = gmSimd4fma(c1, gmSimd4splat(a[j * 4 + 1]), r);
+            r = gmSimd4fma(c2, gmSimd4splat(a[j * 4 + 2]), r);
+            r = gmSimd4fma(c3, gmSimd4splat(a[j * 4 + 3]), r);
+            if(stream)
+            {
+                gmSimd4stream(o + j * 4, r);
+            }
+            else
+            {
+                gmSimd4store(o + j * 4, r);
+            }
+        }
+    }
+}
+
+/**
+ * @brief multiplies one matrix by n matrices (out[i] = vp * m[i])
+ *
+ * the columns of `vp` stay in registers for the whole batch and every
+ * output column is a 4-lane multiply-add chain. when `n` reaches
+ * `CGM_STREAM_THRESHOLD` and `out` is 16-byte aligned the results are
+ * written with non-temporal stores, so the buffer can be handed to a
+ * mapped GPU upload without first polluting the cache.
+ *
+ * @param vp view-projection matrix (proj * view)
+ * @param m model matrices
+ * @param n number of matrices
+ * @param out output, tightly packed mat4 (must not alias `m`)
+ */
+CGMINLINE void gmMat4mulBatch(mat4 vp, const mat4 *m, size_t n, mat4 *out)
+{
+    int stream = n >= CGM_STREAM_THRESHOLD && ((uintptr_t)out & 15) == 0;
+    gmMat4mulBatchRange(vp, m, n, out, stream);
+    if(stream)
+    {
+        gmSimdfence();
+    }
+}
+
+/*
+ * @brief `gmMat4x3mulBatch` on one range, `stream` selects non-temporal stores
+ */
+CGMINLINE void gmMat4x3mulBatchRange(mat4 vp, const mat4x3 *m, size_t n, mat4 *out, int stream)
+{
+    simd4f c0 = gmSimd4load(vp.m + 0);
+    simd4f c1 = gmSimd4load(vp.m + 4);
+    simd4f c2 = gmSimd4load(vp.m + 8);
+    simd4f c3 = gmSimd4load(vp.m + 12);
+
+    for(size_t i = 0; i < n; i++)
+    {
+        const float *a = m[i].m;
+        float *o = out[i].m;
+        CGM_PREFETCH(a + 48);
+
+        for(int j = 0; j < 4; j++)
+        {
+            simd4f r = gmSimd4mul(c0, gmSimd4splat(a[j * 3 + 0]));
+            r = gmSimd4fma(c1, gmSimd4splat(a[j * 3 + 1]), r);
+            r = gmSimd4fma(c2, gmSimd4splat(a[j * 3 + 2]), r);
+            if(j == 3)
+            {
+                r = gmSimd4add(r, c3);
+            }
+            if(stream)
+            {
+                gmSimd4stream(o + j * 4, r);
+            }
+            else
+            {
+                gmSimd4store(o + j * 4, r);
+            }
+        }
+    }
+}
+
+/**
+ * @brief multiplies one matrix by n affine matrices (out[i] = vp * m[i])
+ *
+ * same as `gmMat4mulBatch`, but the implicit (0, 0, 0, 1) row of the
+ * affine input saves a quarter of the multiplies and of the bandwidth.
+ *
+ * @param vp view-projection matrix (proj * view)
+ * @param m affine model matrices
+ * @param n number of matrices
+ * @param out output, tightly packed mat4
+ */
+CGMINLINE void gmMat4x3mulBatch(mat4 vp, const mat4x3 *m, size_t n, mat4 *out)
+{
+    int stream = n >= CGM_STREAM_THRESHOLD && ((uintptr_t)out & 15) == 0;
+    gmMat4x3mulBatchRange(vp, m, n, out, stream);
+    if(stream)
+    {
+        gmSimdfence();
+    }
+}
+
+/**
+ * @brief model, MVP and normal matrices for n instances in one pass
+ *
+ * the normal matrix of T * R * S is R * S^-1, so it falls out of the
+ * rotation already built for the model matrix without any inverse.
+ * a zero scale component yields a zero column in the normal matrix.
+ *
+ * @param vp view-projection matrix (proj * view)
+ * @param t translations
+ * @param r rotations (unit quaternions)
+ * @param s scales
+ * @param n number of instances
+ * @param model output model matrices (may be NULL)
+ * @param mvp output model-view-projection matrices (may be NULL)
+ * @param normal output normal matrices (may be NULL)
+ */
+CGMINLINE void gmInstanceMatrices(mat4 vp, const vec3 *t, const quat *r, const vec3 *s, size_t n,
+                                  mat4 *model, mat4 *mvp, mat3 *normal)
+{
+    for(size_t i = 0; i < n; i++)
+    {
+        vec3 sc = s[i];
+        mat4 m = gmMat4fromTRS(t[i], r[i], sc);
+
+        if(model)
+        {
+            model[i] = m;
+        }
+        if(mvp)
+        {
+            mvp[i] = gmMat4mul(vp, m);
+        }
+        if(normal)
+        {
+            float ix = (sc.x == 0.0f) ? 0.0f : 1.0f / sc.x;
+            float iy = (sc.y == 0.0f) ? 0.0f : 1.0f / sc.y;
+            float iz = (sc.z == 0.0f) ? 0.0f : 1.0f / sc.z;
+            mat3 nm = gmMat3fromQuat(r[i]);
+            nm.m[0] *= ix; nm.m[1] *= ix; nm.m[2] *= ix;
+            nm.m[3] *= iy; nm.m[4] *= iy; nm.m[5] *= iy;
+            nm.m[6] *= iz; nm.m[7] *= iz; nm.m[8] *= iz;
+            normal[i] = nm;
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* parallel (jgm/job.h)                                                        */
+/* -------------------------------------------------------------------------- */
+
+#ifndef CGM_INSTANCE_GRAIN
+#define CGM_INSTANCE_GRAIN 1024 /* matrices per chunk */
+#endif
+
+typedef struct
+{
+    mat4 vp;
+    const void *m;
+    mat4 *out;
+    int stream;
+} gmMat4mulBatchJob;
+
+CGMINLINE void gmMat4mulBatchTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmMat4mulBatchJob *j = (gmMat4mulBatchJob *)ctx;
+    (void)thread;
+    gmMat4mulBatchRange(j->vp, (const mat4 *)j->m + b, e - b, j->out + b, j->stream);
+    if(j->stream)
+    {
+        gmSimdfence();
+    }
+}
+
+CGMINLINE void gmMat4x3mulBatchTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmMat4mulBatchJob *j = (gmMat4mulBatchJob *)ctx;
+    (void)thread;
+    gmMat4x3mulBatchRange(j->vp, (const mat4x3 *)j->m + b, e - b, j->out + b, j->stream);
+    if(j->stream)
+    {
+        gmSimdfence();
+    }
+}
+
+/**
+ * @brief `gmMat4mulBatch` split across the job pool
+ */
+CGMINLINE void gmMat4mulBatchParallel(mat4 vp, const mat4 *m, size_t n, mat4 *out)
+{
+    gmMat4mulBatchJob j = {vp, m, out, n >= CGM_STREAM_THRESHOLD && ((uintptr_t)out & 15) == 0};
+    gmParallelFor(n, CGM_INSTANCE_GRAIN, gmMat4mulBatchTask, &j);
+}
+
+/**
+ * @brief `gmMat4x3mulBatch` split across the job pool
+ */
+CGMINLINE void gmMat4x3mulBatchParallel(mat4 vp, const mat4x3 *m, size_t n, mat4 *out)
+{
+    gmMat4mulBatchJob j = {vp, m, out, n >= CGM_STREAM_THRESHOLD && ((uintptr_t)out & 15) == 0};
+    gmParallelFor(n, CGM_INSTANCE_GRAIN, gmMat4x3mulBatchTask, &j);
+}
+
+typedef struct
+{
+    mat4 vp;
+    const vec3 *t;
+    const quat *r;
+    const vec3 *s;
+    mat4 *model;
+    mat4 *mvp;
+    mat3 *normal;
+} gmInstanceMatricesJob;
+
+CGMINLINE void gmInstanceMatricesTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmInstanceMatricesJob *j = (gmInstanceMatricesJob *)ctx;
+    (void)thread;
+    gmInstanceMatrices(j->vp, j->t + b, j->r + b, j->s + b, e - b,
+                       j->model ? j->model + b : NULL,
+                       j->mvp ? j->mvp + b : NULL,
+                       j->normal ? j->normal + b : NULL);
+}
+
+/**
+ * @brief `gmInstanceMatrices` split across the job pool
+ */
+CGMINLINE void gmInstanceMatricesParallel(mat4 vp, const vec3 *t, const quat *r, const vec3 *s, size_t n,
+                                          mat4 *model, mat4 *mvp, mat3 *normal)
+{
+    gmInstanceMatricesJob j = {vp, t, r, s, model, mvp, normal};
+    gmParallelFor(n, CGM_INSTANCE_GRAIN, gmInstanceMatricesTask, &j);
+}
+
+#endif
@@ -1,7 +1,9 @@
 #ifndef TRANSFORM_GRAPHICS_MATH
 #define TRANSFORM_GRAPHICS_MATH
 
+#include "../ugm/ugm.h"
 #include "../vec3.h"
+#include "../vec4.h"
 #include "../mat4.h"
 #include <math.h>
 
@@ -98,6 +100,90 @@ CGMINLINE mat4 gmMat4perspective(float mv, float ma, float mn, float mf)
     return m;
 }
 
+/**
+ * @brief reversed-Z perspective projection matrix
+ *
+ * maps the close plane to depth 1 and the distant plane to 0 in a [0, 1]
+ * depth range (glClipControl / D3D / Vulkan), which spreads float depth
+ * precision evenly over distance.
+ *
+ * @param mv vertical field in radians
+ * @param ma width/height ratio
+ * @param mn close plane
+ * @param mf distant plane
+ */
+CGMINLINE mat4 gmMat4perspectiveReversed(float mv, float ma, float mn, float mf)
+{
+    float mt = tanf(mv * 0.5f);
+    mat4 m = CGM_MAT4_INIT;
+    m.m[0] = 1.0f / (ma * mt);
+    m.m[5] = 1.0f / mt;
+    m.m[10] = mn / (mf - mn);
+    m.m[11] = -1.0f;
+    m.m[14] = (mf * mn) / (mf - mn);
+    return m;
+}
+
+/**
+ * @brief perspective projection matrix with the distant plane at infinity
+ *
+ * the limit of `gmMat4perspective` for mf -> inf ([-1, 1] depth range).
+ *
+ * @param mv vertical field in radians
+ * @param ma width/height ratio
+ * @param mn close plane
+ */
+CGMINLINE mat4 gmMat4perspectiveInfinite(float mv, float ma, float mn)
+{
+    float mt = tanf(mv * 0.5f);
+    mat4 m = CGM_MAT4_INIT;
+    m.m[0] = 1.0f / (ma * mt);
+    m.m[5] = 1.0f / mt;
+    m.m[10] = -1.0f;
+    m.m[11] = -1.0f;
+    m.m[14] = -2.0f * mn;
+    return m;
+}
+
+/**
+ * @brief reversed-Z perspective projection matrix with the distant plane
+ * at infinity: the close plane maps to depth 1, infinity to 0
+ *
+ * @param mv vertical field in radians
+ * @param ma width/height ratio
+ * @param mn close plane
+ */
+CGMINLINE mat4 gmMat4perspectiveInfiniteReversed(float mv, float ma, float mn)
+{
+    float mt = tanf(mv * 0.5f);
+    mat4 m = CGM_MAT4_INIT;
+    m.m[0] = 1.0f / (ma * mt);
+    m.m[5] = 1.0f / mt;
+    m.m[11] = -1.0f;
+    m.m[14] = mn;
+    return m;
+}
+
+/**
+ * @brief inverse of a perspective projection matrix
+ *
+ * works for every `gmMat4perspective*` variant (and off-center frusta):
+ * only m[0], m[5], m[8], m[9], m[10] and m[14] are read, m[11] must be -1.
+ * exact up to rounding and much cheaper than `gmMat4inverse`.
+ */
+CGMINLINE mat4 gmMat4perspectiveInverse(mat4 p)
+{
+    mat4 m = CGM_MAT4_INIT;
+    m.m[0] = 1.0f / p.m[0];
+    m.m[5] = 1.0f / p.m[5];
+    m.m[11] = 1.0f / p.m[14];
+    m.m[12] = p.m[8] / p.m[0];
+    m.m[13] = p.m[9] / p.m[5];
+    m.m[14] = -1.0f;
+    m.m[15] = p.m[10] / p.m[14];
+    return m;
+}
+
 /**
  * @brief lookat matrix
  * @param mey camera position
@@ -129,4 +215,37 @@ CGMINLINE mat4 gmMat4lookAt(vec3 mey, vec3 mc, vec3 mup)
     return m;
 }
 
+/**
+ * @brief inverse of `gmMat4lookAt`: camera to world
+ *
+ * the rotation part is transposed, the translation is the eye position.
+ * @param mey camera position
+ * @param mc point to look at
+ * @param mup up vector
+ */
+CGMINLINE mat4 gmMat4lookAtInverse(vec3 mey, vec3 mc, vec3 mup)
+{
+    vec3 f = gmVec3normalize(gmVec3sub(mc, mey));
+    vec3 s = gmVec3normalize(gmVec3cross(f, mup));
+    vec3 u = gmVec3cross(s, f);
+    mat4 m = gmMat4identity();
+
+    m.m[0] = s.x;
+    m.m[1] = s.y;
+    m.m[2] = s.z;
+
+    m.m[4] = u.x;
+    m.m[5] = u.y;
+    m.m[6] = u.z;
+
+    m.m[8] =  -f.x;
+    m.m[9] =  -f.y;
+    m.m[10] = -f.z;
+
+    m.m[12] = mey.x;
+    m.m[13] = mey.y;
+    m.m[14] = mey.z;
+    return m;
+}
+
 #endif
\ No newline at end of file
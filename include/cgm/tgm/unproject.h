@@ -0,0 +1,272 @@
+#ifndef UNPROJECT_GRAPHICS_MATH
+#define UNPROJECT_GRAPHICS_MATH
+
+/**
+ * @file unproject.h
+ * @brief depth buffer to view / world positions
+ *
+ * instead of `gmMat4inverse(proj * view)` and one `gmMat4mulVec4` per
+ * pixel, the perspective projection is inverted analytically: for a pixel
+ * with NDC (x, y, z)
+ *
+ *     w = d / (z + c)               distance along -Z in view space
+ *     p = (w (x + m8) / m0, w (y + m9) / m5, -w)
+ *
+ * with c = m[10], d = m[14] of any `gmMat4perspective*` matrix. a row of
+ * pixels shares y, and x is linear in the pixel index, so the batch
+ * kernels cost one division and a few multiply-adds per pixel (plus an
+ * affine transform for world space).
+ *
+ * rows are split across the job pool with `gmParallelFor` (jgm/job.h).
+ */
+
+#include "../core.h"
+#include "../ugm/ugm.h"
+#include "../vec2.h"
+#include "../vec3.h"
+#include "../vec4.h"
+#include "../mat4.h"
+#include "../sgm/simd.h"
+#include "../jgm/job.h"
+#include "transform.h"
+#include <stddef.h>
+
+#ifndef CGM_UNPROJECT_GRAIN
+#define CGM_UNPROJECT_GRAIN 16384 /* pixels per parallel chunk */
+#endif
+
+/* depth buffer stores NDC z directly ([0, 1], reversed-Z), not (z + 1) / 2 */
+#define CGM_UNPROJECT_ZERO_TO_ONE 1
+/* row 0 of the buffer is the top of the image (D3D / Vulkan) */
+#define CGM_UNPROJECT_TOP_DOWN    2
+
+typedef struct
+{
+    float ax, bx;   /* NDC x of pixel column i: (i + 0.5) * ax + bx, folded with 1 / m0 and m8 */
+    float ay, by;   /* same for rows */
+    float zs, zb;   /* z + c = depth * zs + zb */
+    float d;        /* w = d / (z + c) */
+    int   width;
+    int   height;
+} gmUnproject;
+
+/**
+ * @brief unprojection setup for a perspective matrix and viewport
+ *
+ * @param proj any `gmMat4perspective*` matrix (m[11] == -1)
+ * @param width, height viewport in pixels
+ * @param flags CGM_UNPROJECT_ZERO_TO_ONE, CGM_UNPROJECT_TOP_DOWN
+ */
+CGMINLINE gmUnproject gmUnprojectInit(mat4 proj, int width, int height, int flags)
+{
+    gmUnproject u;
+    float sx = 1.0f / proj.m[0], sy = 1.0f / proj.m[5];
+    float ys = (flags & CGM_UNPROJECT_TOP_DOWN) ? -1.0f : 1.0f;
+
+    /* x_ndc = 2 (i + 0.5) / width - 1, then (x_ndc + m8) / m0 */
+    u.ax = 2.0f * sx / (float)width;
+    u.bx = (proj.m[8] - 1.0f) * sx;
+    u.ay = ys * 2.0f * sy / (float)height;
+    u.by = (proj.m[9] - ys) * sy;
+    if(flags & CGM_UNPROJECT_ZERO_TO_ONE)
+    {
+        u.zs = 1.0f;
+        u.zb = proj.m[10];
+    }
+    else
+    {
+        u.zs = 2.0f;
+        u.zb = proj.m[10] - 1.0f;
+    }
+    u.d = proj.m[14];
+    u.width = width;
+    u.height = height;
+    return u;
+}
+
+/**
+ * @brief view space position of a pixel
+ * @param x, y pixel coordinates (pixel centers at i + 0.5)
+ * @param depth depth buffer value
+ */
+CGMINLINE vec3 gmUnprojectView(const gmUnproject *u, float x, float y, float depth)
+{
+    float w = u->d / (depth * u->zs + u->zb);
+    return gmVec3(w * (x * u->ax + u->bx), w * (y * u->ay + u->by), -w);
+}
+
+/**
+ * @brief view distance (-z) of a depth buffer value
+ */
+CGMINLINE float gmUnprojectDistance(const gmUnproject *u, float depth)
+{
+    return u->d / (depth * u->zs + u->zb);
+}
+
+/* -------------------------------------------------------------------------- */
+/* batch kernels                                                               */
+/* -------------------------------------------------------------------------- */
+
+/* stores lanes as AoS vec3, optionally through the affine part of m */
+CGMINLINE void gmUnprojectStore(simdf x, simdf y, simdf z, const mat4 *m, size_t k, vec3 *out)
+{
+    float t[3][CGM_SIMD_WIDTH];
+
+    if(m)
+    {
+        simdf wx = gmSimdfma(gmSimdsplat(m->m[0]), x, gmSimdfma(gmSimdsplat(m->m[4]), y,
+                   gmSimdfma(gmSimdsplat(m->m[8]), z, gmSimdsplat(m->m[12]))));
+        simdf wy = gmSimdfma(gmSimdsplat(m->m[1]), x, gmSimdfma(gmSimdsplat(m->m[5]), y,
+                   gmSimdfma(gmSimdsplat(m->m[9]), z, gmSimdsplat(m->m[13]))));
+        simdf wz = gmSimdfma(gmSimdsplat(m->m[2]), x, gmSimdfma(gmSimdsplat(m->m[6]), y,
+                   gmSimdfma(gmSimdsplat(m->m[10]), z, gmSimdsplat(m->m[14]))));
+        x = wx;
+        y = wy;
+        z = wz;
+    }
+    gmSimdstore(t[0], x);
+    gmSimdstore(t[1], y);
+    gmSimdstore(t[2], z);
+    for(size_t l = 0; l < k; l++)
+    {
+        out[l] = gmVec3(t[0][l], t[1][l], t[2][l]);
+    }
+}
+
+/**
+ * @brief positions of rows [y0, y1) of a depth buffer
+ *
+ * @param depth row-major, `u->width` values per row
+ * @param toWorld camera to world (`gmMat4lookAtInverse`, affine), NULL for view space
+ * @param out one vec3 per pixel, same layout as `depth`
+ */
+CGMINLINE void gmUnprojectRows(const gmUnproject *u, const float *depth, const mat4 *toWorld,
+                               int y0, int y1, vec3 *out)
+{
+    float iota[CGM_SIMD_WIDTH];
+    for(int l = 0; l < CGM_SIMD_WIDTH; l++)
+    {
+        iota[l] = (float)l + 0.5f;
+    }
+
+    simdf lane = gmSimdmul(gmSimdload(iota), gmSimdsplat(u->ax));
+    simdf zs = gmSimdsplat(u->zs), zb = gmSimdsplat(u->zb), d = gmSimdsplat(u->d);
+    size_t width = (size_t)u->width;
+
+    for(int y = y0; y < y1; y++)
+    {
+        const float *row = depth + (size_t)y * width;
+        vec3 *dst = out + (size_t)y * width;
+        simdf ny = gmSimdsplat(((float)y + 0.5f) * u->ay + u->by);
+
+        for(size_t i = 0; i < width; i += CGM_SIMD_WIDTH)
+        {
+            size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, width - i);
+            simdf z;
+            if(k == CGM_SIMD_WIDTH)
+            {
+                z = gmSimdload(row + i);
+            }
+            else
+            {
+                float t[CGM_SIMD_WIDTH];
+                for(size_t l = 0; l < CGM_SIMD_WIDTH; l++)
+                {
+                    t[l] = (l < k) ? row[i + l] : 0.5f;
+                }
+                z = gmSimdload(t);
+            }
+
+            simdf nx = gmSimdadd(lane, gmSimdsplat((float)i * u->ax + u->bx));
+            simdf w = gmSimddiv(d, gmSimdfma(z, zs, zb));
+            gmUnprojectStore(gmSimdmul(w, nx), gmSimdmul(w, ny), gmSimdsub(gmSimdzero(), w), toWorld, k, dst + i);
+        }
+    }
+}
+
+/**
+ * @brief positions of a whole depth buffer (`u->width` x `u->height`)
+ *
+ * @param toWorld camera to world (affine), NULL for view space
+ */
+CGMINLINE void gmUnprojectDepth(const gmUnproject *u, const float *depth, const mat4 *toWorld, vec3 *out)
+{
+    gmUnprojectRows(u, depth, toWorld, 0, u->height, out);
+}
+
+/**
+ * @brief positions of n scattered pixels (picking, sparse samples)
+ *
+ * @param pixel pixel coordinates, centers at i + 0.5
+ * @param depth depth buffer value of every pixel
+ * @param toWorld camera to world (affine), NULL for view space
+ */
+CGMINLINE void gmUnprojectPoints(const gmUnproject *u, const vec2 *pixel, const float *depth, size_t n,
+                                 const mat4 *toWorld, vec3 *out)
+{
+    simdf ax = gmSimdsplat(u->ax), bx = gmSimdsplat(u->bx);
+    simdf ay = gmSimdsplat(u->ay), by = gmSimdsplat(u->by);
+    simdf zs = gmSimdsplat(u->zs), zb = gmSimdsplat(u->zb), d = gmSimdsplat(u->d);
+
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, n - i);
+        float t[3][CGM_SIMD_WIDTH];
+        for(size_t l = 0; l < CGM_SIMD_WIDTH; l++)
+        {
+            t[0][l] = (l < k) ? pixel[i + l].x : 0.0f;
+            t[1][l] = (l < k) ? pixel[i + l].y : 0.0f;
+            t[2][l] = (l < k) ? depth[i + l] : 0.5f;
+        }
+
+        simdf w = gmSimddiv(d, gmSimdfma(gmSimdload(t[2]), zs, zb));
+        simdf x = gmSimdmul(w, gmSimdfma(gmSimdload(t[0]), ax, bx));
+        simdf y = gmSimdmul(w, gmSimdfma(gmSimdload(t[1]), ay, by));
+        gmUnprojectStore(x, y, gmSimdsub(gmSimdzero(), w), toWorld, k, out + i);
+    }
+}
+
+/**
+ * @brief view distances (-z) of n depth values, e.g. a linear depth pass
+ */
+CGMINLINE void gmUnprojectDistanceArray(const gmUnproject *u, const float *depth, size_t n, float *out)
+{
+    simdf zs = gmSimdsplat(u->zs), zb = gmSimdsplat(u->zb), d = gmSimdsplat(u->d);
+    size_t i = 0;
+
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        gmSimdstore(out + i, gmSimddiv(d, gmSimdfma(gmSimdload(depth + i), zs, zb)));
+    }
+    for(; i < n; i++)
+    {
+        out[i] = gmUnprojectDistance(u, depth[i]);
+    }
+}
+
+typedef struct
+{
+    const gmUnproject *u;
+    const float       *depth;
+    const mat4        *toWorld;
+    vec3              *out;
+} gmUnprojectJob;
+
+CGMINLINE void gmUnprojectDepthTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmUnprojectJob *j = (gmUnprojectJob *)ctx;
+    (void)thread;
+    gmUnprojectRows(j->u, j->depth, j->toWorld, (int)b, (int)e, j->out);
+}
+
+/**
+ * @brief `gmUnprojectDepth` split by rows across the job pool
+ */
+CGMINLINE void gmUnprojectDepthParallel(const gmUnproject *u, const float *depth, const mat4 *toWorld, vec3 *out)
+{
+    gmUnprojectJob j = {u, depth, toWorld, out};
+    size_t rows = CGM_UNPROJECT_GRAIN / (size_t)GMMAX(u->width, 1);
+    gmParallelFor((size_t)u->height, GMMAX(rows, (size_t)1), gmUnprojectDepthTask, &j);
+}
+
+#endif
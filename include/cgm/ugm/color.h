@@ -0,0 +1,564 @@
+#ifndef COLOR_GRAPHICS_MATH
+#define COLOR_GRAPHICS_MATH
+
+/**
+ * @file color.h
+ * @brief color space conversion: sRGB transfer, HSV, luminance, unorm8
+ *
+ * precision of the sRGB transfer variants (inputs in [0, 1], measured
+ * against a double precision reference):
+ *  - `gmSrgbtoLinear` / `gmLineartoSrgb`: powf, the reference itself
+ *  - `*Array`: SIMD log2 / exp2 polynomials, relative error < 1e-6,
+ *    every unorm8 value round-trips exactly
+ *  - `*FastArray`: polynomial / sqrt fits, absolute error < 2e-3
+ *    (sRGB -> linear) and < 1e-3 (linear -> sRGB), about half an 8-bit step
+ *  - `gmSrgb8toLinear` / `gmSrgb8toLinearArray`: 256-entry table, exact
+ *
+ * vec3 buffers are plain float arrays for the per-channel kernels:
+ * pass `(float *)v` and `3 * n`. the vec4 kernels leave alpha untouched.
+ */
+
+#include "../core.h"
+#include "ugm.h"
+#include "../vec3.h"
+#include "../vec4.h"
+#include "../sgm/simd.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* scalar                                                                      */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief sRGB encoded channel to linear (IEC 61966-2-1)
+ */
+CGMINLINE float gmSrgbtoLinear(float c)
+{
+    return (c <= 0.04045f) ? c * (1.0f / 12.92f) : powf((c + 0.055f) * (1.0f / 1.055f), 2.4f);
+}
+
+/**
+ * @brief linear channel to sRGB encoding
+ */
+CGMINLINE float gmLineartoSrgb(float c)
+{
+    return (c <= 0.0031308f) ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+}
+
+/**
+ * @brief cubic fit of `gmSrgbtoLinear`, absolute error < 2e-3 on [0, 1]
+ */
+CGMINLINE float gmSrgbtoLinearFast(float c)
+{
+    return c * (c * (c * 0.305306011f + 0.682171111f) + 0.012522878f);
+}
+
+/**
+ * @brief fit of `gmLineartoSrgb` from nested square roots, absolute error
+ * < 1e-3 on [0, 1]
+ */
+CGMINLINE float gmLineartoSrgbFast(float c)
+{
+    if(c <= 0.0031308f)
+    {
+        return c * 12.92f;
+    }
+    float s1 = sqrtf(c), s2 = sqrtf(s1), s3 = sqrtf(s2);
+    return 0.662002687f * s1 + 0.684122060f * s2 - 0.323583601f * s3 - 0.0225411470f * c;
+}
+
+CGMINLINE vec3 gmVec3srgbtoLinear(vec3 c)
+{
+    return gmVec3(gmSrgbtoLinear(c.x), gmSrgbtoLinear(c.y), gmSrgbtoLinear(c.z));
+}
+
+CGMINLINE vec3 gmVec3lineartoSrgb(vec3 c)
+{
+    return gmVec3(gmLineartoSrgb(c.x), gmLineartoSrgb(c.y), gmLineartoSrgb(c.z));
+}
+
+/**
+ * @brief `gmVec3srgbtoLinear`, alpha unchanged
+ */
+CGMINLINE vec4 gmVec4srgbtoLinear(vec4 c)
+{
+    return gmVec4(gmSrgbtoLinear(c.x), gmSrgbtoLinear(c.y), gmSrgbtoLinear(c.z), c.w);
+}
+
+/**
+ * @brief `gmVec3lineartoSrgb`, alpha unchanged
+ */
+CGMINLINE vec4 gmVec4lineartoSrgb(vec4 c)
+{
+    return gmVec4(gmLineartoSrgb(c.x), gmLineartoSrgb(c.y), gmLineartoSrgb(c.z), c.w);
+}
+
+/**
+ * @brief relative luminance of a linear Rec.709 / sRGB color
+ */
+CGMINLINE float gmLuminance(vec3 c)
+{
+    return 0.2126f * c.x + 0.7152f * c.y + 0.0722f * c.z;
+}
+
+/**
+ * @brief RGB to HSV, all components in [0, 1] (hue 1 = 360 degrees)
+ */
+CGMINLINE vec3 gmVec3rgbtoHsv(vec3 c)
+{
+    float max = GMMAX(c.x, GMMAX(c.y, c.z));
+    float min = GMMIN(c.x, GMMIN(c.y, c.z));
+    float d = max - min;
+    float h = 0.0f;
+
+    if(d > 0.0f)
+    {
+        if(max == c.x)
+        {
+            h = (c.y - c.z) / d;
+        }
+        else if(max == c.y)
+        {
+            h = (c.z - c.x) / d + 2.0f;
+        }
+        else
+        {
+            h = (c.x - c.y) / d + 4.0f;
+        }
+        h *= 1.0f / 6.0f;
+        h = (h < 0.0f) ? h + 1.0f : h;
+    }
+    return gmVec3(h, (max > 0.0f) ? d / max : 0.0f, max);
+}
+
+/**
+ * @brief HSV to RGB, inverse of `gmVec3rgbtoHsv`
+ *
+ * channel n (5, 3, 1 for r, g, b) is v - v s clamp(min(k, 4 - k), 0, 1)
+ * with k = (n + 6 h) mod 6.
+ */
+CGMINLINE vec3 gmVec3hsvtoRgb(vec3 c)
+{
+    float r[3];
+    for(int i = 0; i < 3; i++)
+    {
+        float k = fmodf(5.0f - 2.0f * (float)i + c.x * 6.0f, 6.0f);
+        r[i] = c.z - c.z * c.y * gmClamp(GMMIN(k, 4.0f - k), 0.0f, 1.0f);
+    }
+    return gmVec3(r[0], r[1], r[2]);
+}
+
+/**
+ * @brief [0, 1] float to unorm8, clamped and rounded to nearest
+ */
+CGMINLINE uint8_t gmUnorm8(float c)
+{
+    return (uint8_t)(gmClamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+CGMINLINE float gmUnorm8toFloat(uint8_t c)
+{
+    return (float)c * (1.0f / 255.0f);
+}
+
+/**
+ * @brief sRGB encoded unorm8 to linear float, exact (table lookup)
+ */
+CGMINLINE float gmSrgb8toLinear(uint8_t c)
+{
+    /* correctly rounded floats of the double precision decode */
+    static const float lut[256] = {
+        0.0f, 0.000303526991f, 0.000607053982f, 0.000910580973f, 0.00121410796f, 0.00151763496f,
+        0.00182116195f, 0.00212468882f, 0.00242821593f, 0.0027317428f, 0.00303526991f, 0.00334653584f,
+        0.00367650739f, 0.00402471703f, 0.00439144205f, 0.00477695325f, 0.00518151652f, 0.00560539169f,
+        0.00604883302f, 0.00651209056f, 0.00699541019f, 0.00749903219f, 0.00802319311f, 0.00856812578f,
+        0.00913405884f, 0.00972121768f, 0.010329823f, 0.0109600937f, 0.0116122449f, 0.012286488f,
+        0.0129830325f, 0.0137020834f, 0.0144438436f, 0.0152085144f, 0.0159962941f, 0.0168073755f,
+        0.0176419541f, 0.01850022f, 0.0193823613f, 0.0202885624f, 0.0212190095f, 0.0221738853f,
+        0.0231533665f, 0.0241576321f, 0.0251868591f, 0.0262412224f, 0.0273208916f, 0.02842604f,
+        0.0295568351f, 0.0307134446f, 0.0318960324f, 0.0331047662f, 0.0343398079f, 0.0356013142f,
+        0.0368894488f, 0.0382043719f, 0.0395462364f, 0.0409151986f, 0.0423114114f, 0.043735031f,
+        0.045186203f, 0.0466650873f, 0.0481718257f, 0.0497065671f, 0.0512694567f, 0.0528606474f,
+        0.054480277f, 0.0561284907f, 0.0578054301f, 0.0595112368f, 0.0612460524f, 0.0630100146f,
+        0.064803265f, 0.0666259378f, 0.0684781671f, 0.0703600943f, 0.0722718537f, 0.0742135718f,
+        0.0761853829f, 0.078187421f, 0.0802198201f, 0.0822827071f, 0.0843762085f, 0.0865004584f,
+        0.0886555836f, 0.0908417106f, 0.0930589661f, 0.0953074694f, 0.097587347f, 0.0998987257f,
+        0.102241732f, 0.104616486f, 0.107023105f, 0.10946171f, 0.111932427f, 0.114435375f,
+        0.116970666f, 0.119538426f, 0.122138776f, 0.124771819f, 0.127437681f, 0.130136475f,
+        0.13286832f, 0.135633335f, 0.138431609f, 0.141263291f, 0.144128472f, 0.147027269f,
+        0.149959788f, 0.152926147f, 0.155926466f, 0.158960834f, 0.162029371f, 0.165132195f,
+        0.168269396f, 0.171441108f, 0.174647406f, 0.177888423f, 0.18116425f, 0.18447499f,
+        0.187820777f, 0.191201687f, 0.194617838f, 0.198069319f, 0.20155625f, 0.205078736f,
+        0.208636865f, 0.212230757f, 0.215860501f, 0.219526201f, 0.223227963f, 0.226965874f,
+        0.230740055f, 0.23455058f, 0.238397568f, 0.242281124f, 0.246201321f, 0.25015828f,
+        0.254152089f, 0.258182853f, 0.262250662f, 0.266355604f, 0.270497799f, 0.274677306f,
+        0.278894275f, 0.283148736f, 0.287440836f, 0.291770637f, 0.296138257f, 0.300543785f,
+        0.304987311f, 0.309468925f, 0.313988715f, 0.318546772f, 0.323143214f, 0.327778101f,
+        0.332451522f, 0.337163627f, 0.341914415f, 0.346704066f, 0.351532608f, 0.356400132f,
+        0.361306787f, 0.366252601f, 0.371237695f, 0.376262128f, 0.38132602f, 0.386429429f,
+        0.391572475f, 0.396755219f, 0.401977777f, 0.407240212f, 0.412542611f, 0.417885065f,
+        0.423267663f, 0.428690493f, 0.434153646f, 0.439657182f, 0.445201188f, 0.450785786f,
+        0.456411034f, 0.462076992f, 0.467783809f, 0.473531485f, 0.479320168f, 0.48514995f,
+        0.491020858f, 0.496932983f, 0.502886474f, 0.50888133f, 0.514917672f, 0.520995557f,
+        0.527115107f, 0.533276379f, 0.539479494f, 0.545724452f, 0.55201143f, 0.558340371f,
+        0.564711511f, 0.571124852f, 0.577580452f, 0.584078431f, 0.590618849f, 0.597201765f,
+        0.603827357f, 0.610495567f, 0.617206573f, 0.623960376f, 0.630757153f, 0.637596846f,
+        0.644479692f, 0.651405632f, 0.658374846f, 0.665387273f, 0.672443151f, 0.679542482f,
+        0.686685324f, 0.693871737f, 0.701101899f, 0.708375752f, 0.715693474f, 0.723055124f,
+        0.730460763f, 0.73791039f, 0.745404184f, 0.752942204f, 0.760524511f, 0.768151164f,
+        0.775822222f, 0.783537805f, 0.791297913f, 0.799102724f, 0.806952238f, 0.814846575f,
+        0.822785735f, 0.830769897f, 0.838799f, 0.846873224f, 0.854992628f, 0.863157213f,
+        0.871367097f, 0.8796224f, 0.887923121f, 0.896269381f, 0.904661179f, 0.913098633f,
+        0.921581864f, 0.930110872f, 0.938685715f, 0.947306514f, 0.955973327f, 0.964686275f,
+        0.973445296f, 0.982250571f, 0.991102099f, 1.0f
+    };
+    return lut[c];
+}
+
+/* -------------------------------------------------------------------------- */
+/* lanes                                                                       */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * log2 of positive normal lanes: exponent from the bits, mantissa folded
+ * into [sqrt(1/2), sqrt(2)) and log2(m) = 2 / ln 2 * atanh((m - 1) / (m + 1))
+ * as an odd series up to t^9 (|t| <= 0.172, error < 1e-9 before rounding)
+ */
+CGMINLINE simdf gmLog2Lanes(simdf x)
+{
+    simdi bits = gmSimdasi(x);
+    simdi e = gmSimdisub(gmSimdisrl(bits, 23), gmSimdisplat(127));
+    simdf m = gmSimdasf(gmSimdior(gmSimdiand(bits, gmSimdisplat(0x007fffff)), gmSimdisplat(0x3f800000)));
+
+    simdf big = gmSimdlt(gmSimdsplat(1.41421356f), m);
+    m = gmSimdselect(big, gmSimdmul(m, gmSimdsplat(0.5f)), m);
+    simdf ef = gmSimdadd(gmSimditof(e), gmSimdand(big, gmSimdsplat(1.0f)));
+
+    simdf one = gmSimdsplat(1.0f);
+    simdf t = gmSimddiv(gmSimdsub(m, one), gmSimdadd(m, one));
+    simdf t2 = gmSimdmul(t, t);
+    simdf p = gmSimdfma(t2, gmSimdsplat(1.0f / 9.0f), gmSimdsplat(1.0f / 7.0f));
+    p = gmSimdfma(t2, p, gmSimdsplat(1.0f / 5.0f));
+    p = gmSimdfma(t2, p, gmSimdsplat(1.0f / 3.0f));
+    p = gmSimdfma(t2, p, one);
+    return gmSimdfma(gmSimdmul(t, p), gmSimdsplat(2.885390082f), ef);
+}
+
+/*
+ * 2^y for y in about [-126, 127]: round to the nearest integer n, 2^f on
+ * [-0.5, 0.5] by the degree 6 Taylor polynomial (error ~1e-7), 2^n added
+ * into the exponent bits
+ */
+CGMINLINE simdf gmExp2Lanes(simdf y)
+{
+    simdi n = gmSimdiround(y);
+    simdf f = gmSimdmul(gmSimdsub(y, gmSimditof(n)), gmSimdsplat(0.693147181f));
+    simdf p = gmSimdfma(f, gmSimdsplat(1.0f / 720.0f), gmSimdsplat(1.0f / 120.0f));
+    p = gmSimdfma(f, p, gmSimdsplat(1.0f / 24.0f));
+    p = gmSimdfma(f, p, gmSimdsplat(1.0f / 6.0f));
+    p = gmSimdfma(f, p, gmSimdsplat(0.5f));
+    p = gmSimdfma(f, p, gmSimdsplat(1.0f));
+    p = gmSimdfma(f, p, gmSimdsplat(1.0f));
+    return gmSimdasf(gmSimdiadd(gmSimdasi(p), gmSimdisll(n, 23)));
+}
+
+CGMINLINE simdf gmSrgbtoLinearLanes(simdf c)
+{
+    simdf lo = gmSimdmul(c, gmSimdsplat(1.0f / 12.92f));
+    simdf b = gmSimdmax(gmSimdmul(gmSimdadd(c, gmSimdsplat(0.055f)), gmSimdsplat(1.0f / 1.055f)),
+                        gmSimdsplat(1e-3f));
+    simdf hi = gmExp2Lanes(gmSimdmul(gmLog2Lanes(b), gmSimdsplat(2.4f)));
+    return gmSimdselect(gmSimdle(c, gmSimdsplat(0.04045f)), lo, hi);
+}
+
+CGMINLINE simdf gmLineartoSrgbLanes(simdf c)
+{
+    simdf lo = gmSimdmul(c, gmSimdsplat(12.92f));
+    simdf b = gmSimdmax(c, gmSimdsplat(1e-4f));
+    simdf hi = gmSimdfma(gmExp2Lanes(gmSimdmul(gmLog2Lanes(b), gmSimdsplat(1.0f / 2.4f))),
+                         gmSimdsplat(1.055f), gmSimdsplat(-0.055f));
+    return gmSimdselect(gmSimdle(c, gmSimdsplat(0.0031308f)), lo, hi);
+}
+
+CGMINLINE simdf gmSrgbtoLinearFastLanes(simdf c)
+{
+    simdf p = gmSimdfma(c, gmSimdsplat(0.305306011f), gmSimdsplat(0.682171111f));
+    p = gmSimdfma(c, p, gmSimdsplat(0.012522878f));
+    return gmSimdmul(c, p);
+}
+
+CGMINLINE simdf gmLineartoSrgbFastLanes(simdf c)
+{
+    simdf lo = gmSimdmul(c, gmSimdsplat(12.92f));
+    simdf x = gmSimdmax(c, gmSimdzero());
+    simdf s1 = gmSimdsqrt(x), s2 = gmSimdsqrt(s1), s3 = gmSimdsqrt(s2);
+    simdf r = gmSimdmul(gmSimdsplat(0.662002687f), s1);
+    r = gmSimdfma(gmSimdsplat(0.684122060f), s2, r);
+    r = gmSimdfma(gmSimdsplat(-0.323583601f), s3, r);
+    r = gmSimdfma(gmSimdsplat(-0.0225411470f), x, r);
+    return gmSimdselect(gmSimdle(c, gmSimdsplat(0.0031308f)), lo, r);
+}
+
+CGMINLINE simdf gmRgbtoHsvLanes(simdf r, simdf g, simdf b, simdf *s, simdf *v)
+{
+    simdf zero = gmSimdzero(), one = gmSimdsplat(1.0f);
+    simdf max = gmSimdmax(r, gmSimdmax(g, b));
+    simdf d = gmSimdsub(max, gmSimdmin(r, gmSimdmin(g, b)));
+    simdf chroma = gmSimdlt(zero, d);
+    simdf inv = gmSimddiv(one, gmSimdselect(chroma, d, one));
+
+    simdf hr = gmSimdmul(gmSimdsub(g, b), inv);
+    simdf hg = gmSimdfma(gmSimdsub(b, r), inv, gmSimdsplat(2.0f));
+    simdf hb = gmSimdfma(gmSimdsub(r, g), inv, gmSimdsplat(4.0f));
+    simdf h = gmSimdselect(gmSimdeq(max, r), hr, gmSimdselect(gmSimdeq(max, g), hg, hb));
+    h = gmSimdmul(h, gmSimdsplat(1.0f / 6.0f));
+    h = gmSimdadd(h, gmSimdand(gmSimdlt(h, zero), one));
+
+    simdf lit = gmSimdlt(zero, max);
+    *s = gmSimdand(lit, gmSimddiv(d, gmSimdselect(lit, max, one)));
+    *v = max;
+    return gmSimdand(chroma, h);
+}
+
+CGMINLINE simdf gmHsvChannelLanes(simdf h6, float n, simdf s, simdf v)
+{
+    simdf x = gmSimdadd(h6, gmSimdsplat(n));
+    simdf k = gmSimdsub(x, gmSimdmul(gmSimdsplat(6.0f), gmSimdfloor(gmSimdmul(x, gmSimdsplat(1.0f / 6.0f)))));
+    simdf c = gmSimdmin(k, gmSimdsub(gmSimdsplat(4.0f), k));
+    c = gmSimdmax(gmSimdzero(), gmSimdmin(c, gmSimdsplat(1.0f)));
+    return gmSimdsub(v, gmSimdmul(gmSimdmul(v, s), c));
+}
+
+/* -------------------------------------------------------------------------- */
+/* buffers                                                                     */
+/* -------------------------------------------------------------------------- */
+
+/* lanes (i + l) % 4 == 3 are alpha when a register starts at float i of a vec4 array */
+CGMINLINE simdf gmColorAlphaMask(size_t i)
+{
+    float m[CGM_SIMD_WIDTH];
+    for(size_t l = 0; l < CGM_SIMD_WIDTH; l++)
+    {
+        m[l] = ((i + l) % 4 == 3) ? 1.0f : 0.0f;
+    }
+    return gmSimdlt(gmSimdzero(), gmSimdload(m));
+}
+
+/*
+ * a float array kernel and its vec4 twin (alpha copied) for a lane
+ * function; the last partial register goes through a zero-padded copy
+ */
+#define CGM_COLOR_ARRAY(name, vname, lanes)                                    \
+CGMINLINE void name(const float *c, size_t n, float *out)                      \
+{                                                                              \
+    size_t i = 0;                                                              \
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)                        \
+    {                                                                          \
+        gmSimdstore(out + i, lanes(gmSimdload(c + i)));                        \
+    }                                                                          \
+    if(i < n)                                                                  \
+    {                                                                          \
+        float t[CGM_SIMD_WIDTH] = {0};                                         \
+        memcpy(t, c + i, (n - i) * sizeof(float));                            \
+        gmSimdstore(t, lanes(gmSimdload(t)));                                  \
+        memcpy(out + i, t, (n - i) * sizeof(float));                           \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+CGMINLINE void vname(const vec4 *c, size_t n, vec4 *out)                       \
+{                                                                              \
+    const float *src = &c[0].x;                                                \
+    float *dst = &out[0].x;                                                    \
+    size_t i = 0, count = 4 * n;                                               \
+    simdf alpha = gmColorAlphaMask(0);                                         \
+    for(; i + CGM_SIMD_WIDTH <= count; i += CGM_SIMD_WIDTH)                    \
+    {                                                                          \
+        simdf v = gmSimdload(src + i);                                         \
+        if(CGM_SIMD_WIDTH % 4 != 0)                                            \
+        {                                                                      \
+            alpha = gmColorAlphaMask(i);                                       \
+        }                                                                      \
+        gmSimdstore(dst + i, gmSimdselect(alpha, v, lanes(v)));                \
+    }                                                                          \
+    if(i < count)                                                              \
+    {                                                                          \
+        float t[CGM_SIMD_WIDTH] = {0};                                         \
+        memcpy(t, src + i, (count - i) * sizeof(float));                       \
+        simdf v = gmSimdload(t);                                               \
+        gmSimdstore(t, gmSimdselect(gmColorAlphaMask(i), v, lanes(v)));        \
+        memcpy(dst + i, t, (count - i) * sizeof(float));                       \
+    }                                                                          \
+}
+
+/**
+ * @brief out[i] = sRGB to linear of c[i], relative error < 1e-6
+ * `gmVec4srgbtoLinearArray`: the same for n vec4 colors
+ */
+CGM_COLOR_ARRAY(gmSrgbtoLinearArray, gmVec4srgbtoLinearArray, gmSrgbtoLinearLanes)
+
+/**
+ * @brief out[i] = linear to sRGB of c[i], relative error < 1e-6
+ * `gmVec4lineartoSrgbArray`: the same for n vec4 colors
+ */
+CGM_COLOR_ARRAY(gmLineartoSrgbArray, gmVec4lineartoSrgbArray, gmLineartoSrgbLanes)
+
+/**
+ * @brief out[i] = `gmSrgbtoLinearFast`(c[i]), and the vec4 twin
+ */
+CGM_COLOR_ARRAY(gmSrgbtoLinearFastArray, gmVec4srgbtoLinearFastArray, gmSrgbtoLinearFastLanes)
+
+/**
+ * @brief out[i] = `gmLineartoSrgbFast`(c[i]), and the vec4 twin
+ */
+CGM_COLOR_ARRAY(gmLineartoSrgbFastArray, gmVec4lineartoSrgbFastArray, gmLineartoSrgbFastLanes)
+
+#undef CGM_COLOR_ARRAY
+
+/* up to CGM_SIMD_WIDTH vec3 as channel lanes, missing lanes zero */
+CGMINLINE void gmColorLoad3(const vec3 *c, size_t k, simdf *x, simdf *y, simdf *z)
+{
+    float t[3][CGM_SIMD_WIDTH] = {{0}};
+    for(size_t l = 0; l < k; l++)
+    {
+        t[0][l] = c[l].x;
+        t[1][l] = c[l].y;
+        t[2][l] = c[l].z;
+    }
+    *x = gmSimdload(t[0]);
+    *y = gmSimdload(t[1]);
+    *z = gmSimdload(t[2]);
+}
+
+CGMINLINE void gmColorStore3(simdf x, simdf y, simdf z, size_t k, vec3 *out)
+{
+    float t[3][CGM_SIMD_WIDTH];
+    gmSimdstore(t[0], x);
+    gmSimdstore(t[1], y);
+    gmSimdstore(t[2], z);
+    for(size_t l = 0; l < k; l++)
+    {
+        out[l] = gmVec3(t[0][l], t[1][l], t[2][l]);
+    }
+}
+
+/**
+ * @brief out[i] = gmLuminance(c[i])
+ */
+CGMINLINE void gmLuminanceArray(const vec3 *c, size_t n, float *out)
+{
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, n - i);
+        float t[CGM_SIMD_WIDTH];
+        simdf r, g, b;
+
+        gmColorLoad3(c + i, k, &r, &g, &b);
+        simdf y = gmSimdmul(gmSimdsplat(0.2126f), r);
+        y = gmSimdfma(gmSimdsplat(0.7152f), g, y);
+        y = gmSimdfma(gmSimdsplat(0.0722f), b, y);
+        gmSimdstore(t, y);
+        memcpy(out + i, t, k * sizeof(float));
+    }
+}
+
+/**
+ * @brief out[i] = gmVec3rgbtoHsv(c[i])
+ */
+CGMINLINE void gmRgbtoHsvArray(const vec3 *c, size_t n, vec3 *out)
+{
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, n - i);
+        simdf r, g, b, s, v;
+
+        gmColorLoad3(c + i, k, &r, &g, &b);
+        simdf h = gmRgbtoHsvLanes(r, g, b, &s, &v);
+        gmColorStore3(h, s, v, k, out + i);
+    }
+}
+
+/**
+ * @brief out[i] = gmVec3hsvtoRgb(c[i])
+ */
+CGMINLINE void gmHsvtoRgbArray(const vec3 *c, size_t n, vec3 *out)
+{
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, n - i);
+        simdf h, s, v;
+
+        gmColorLoad3(c + i, k, &h, &s, &v);
+        simdf h6 = gmSimdmul(h, gmSimdsplat(6.0f));
+        gmColorStore3(gmHsvChannelLanes(h6, 5.0f, s, v), gmHsvChannelLanes(h6, 3.0f, s, v),
+                      gmHsvChannelLanes(h6, 1.0f, s, v), k, out + i);
+    }
+}
+
+CGMINLINE void gmColorPack8(simdf c, size_t k, uint8_t *out)
+{
+    int32_t t[CGM_SIMD_WIDTH];
+    c = gmSimdmax(gmSimdzero(), gmSimdmin(c, gmSimdsplat(1.0f)));
+    gmSimdistore(t, gmSimditrunc(gmSimdfma(c, gmSimdsplat(255.0f), gmSimdsplat(0.5f))));
+    for(size_t l = 0; l < k; l++)
+    {
+        out[l] = (uint8_t)t[l];
+    }
+}
+
+/**
+ * @brief out[i] = gmUnorm8(c[i])
+ */
+CGMINLINE void gmPackUnorm8Array(const float *c, size_t n, uint8_t *out)
+{
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, n - i);
+        float t[CGM_SIMD_WIDTH] = {0};
+        memcpy(t, c + i, k * sizeof(float));
+        gmColorPack8(gmSimdload(t), k, out + i);
+    }
+}
+
+/**
+ * @brief out[i] = gmUnorm8toFloat(c[i])
+ */
+CGMINLINE void gmUnpackUnorm8Array(const uint8_t *c, size_t n, float *out)
+{
+    for(size_t i = 0; i < n; i++)
+    {
+        out[i] = (float)c[i] * (1.0f / 255.0f);
+    }
+}
+
+/**
+ * @brief linear floats to sRGB encoded unorm8 (texture bake / export)
+ *
+ * matches gmUnorm8(gmLineartoSrgb(c)) except within ~1e-5 of a rounding
+ * boundary.
+ */
+CGMINLINE void gmLineartoSrgb8Array(const float *c, size_t n, uint8_t *out)
+{
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, n - i);
+        float t[CGM_SIMD_WIDTH] = {0};
+        memcpy(t, c + i, k * sizeof(float));
+        gmColorPack8(gmLineartoSrgbLanes(gmSimdload(t)), k, out + i);
+    }
+}
+
+/**
+ * @brief sRGB encoded unorm8 to linear floats, exact (table lookup)
+ */
+CGMINLINE void gmSrgb8toLinearArray(const uint8_t *c, size_t n, float *out)
+{
+    for(size_t i = 0; i < n; i++)
+    {
+        out[i] = gmSrgb8toLinear(c[i]);
+    }
+}
+
+#endif
@@ -0,0 +1,428 @@
+#ifndef STREAM_GRAPHICS_MATH
+#define STREAM_GRAPHICS_MATH
+
+/**
+ * @file stream.h
+ * @brief `ugm.h` scalar helpers applied to contiguous float buffers
+ *
+ * every `*Array` function processes `CGM_SIMD_WIDTH` floats per step and
+ * finishes the remainder with scalar code. with AVX-512F (`-mavx512f`)
+ * the loops first take 16 floats per step on zmm registers; none of these
+ * kernels need masks beyond `gmStep`'s compare, so the 16-wide path is
+ * the same arithmetic as the `simd.h` one. `out` may be equal to any of
+ * the inputs (in-place), but must not partially overlap them.
+ *
+ * the fused variants evaluate a whole chain per lane (e.g. fract -> fade
+ * -> mix) so the buffer is read and written once instead of once per step.
+ */
+
+#include "../core.h"
+#include "ugm.h"
+#include "../sgm/simd.h"
+#include <stddef.h>
+
+#if defined(__AVX512F__) && !defined(CGM_NO_SIMD)
+#define CGM_STREAM_AVX512 1
+#include <immintrin.h>
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* lane helpers                                                                */
+/* -------------------------------------------------------------------------- */
+
+CGMINLINE simdf gmClampLanes(simdf x, simdf lo, simdf hi)
+{
+    return gmSimdmax(lo, gmSimdmin(x, hi));
+}
+
+CGMINLINE simdf gmFractLanes(simdf x)
+{
+    return gmSimdsub(x, gmSimdfloor(x));
+}
+
+CGMINLINE simdf gmMixLanes(simdf a, simdf b, simdf t)
+{
+    return gmSimdfma(gmSimdsub(b, a), t, a);
+}
+
+CGMINLINE simdf gmStepLanes(simdf e, simdf x)
+{
+    return gmSimdandnot(gmSimdlt(x, e), gmSimdsplat(1.0f));
+}
+
+CGMINLINE simdf gmSmoothLanes(simdf t)
+{
+    simdf p = gmSimdfma(gmSimdsplat(-2.0f), t, gmSimdsplat(3.0f));
+    return gmSimdmul(gmSimdmul(t, t), p);
+}
+
+CGMINLINE simdf gmFadeLanes(simdf t)
+{
+    simdf p = gmSimdfma(t, gmSimdsplat(6.0f), gmSimdsplat(-15.0f));
+    p = gmSimdfma(t, p, gmSimdsplat(10.0f));
+    return gmSimdmul(gmSimdmul(gmSimdmul(t, t), t), p);
+}
+
+CGMINLINE simdf gmFadeDerivativeLanes(simdf t)
+{
+    simdf w = gmSimdmul(t, gmSimdsub(t, gmSimdsplat(1.0f)));
+    return gmSimdmul(gmSimdsplat(30.0f), gmSimdmul(w, w));
+}
+
+/*
+ * @brief `gmSmoothstep` with the edge range pre-inverted
+ *
+ * @param e0 lower edge
+ * @param s 1 / (e1 - e0)
+ */
+CGMINLINE simdf gmSmoothstepLanes(simdf e0, simdf s, simdf x)
+{
+    simdf t = gmSimdmul(gmSimdsub(x, e0), s);
+    return gmSmoothLanes(gmClampLanes(t, gmSimdzero(), gmSimdsplat(1.0f)));
+}
+
+#if defined(CGM_STREAM_AVX512)
+
+/* 16-wide twins of the lane helpers, fused only where `gmSimdfma` is */
+
+CGMINLINE __m512 gmFmaLanes16(__m512 a, __m512 b, __m512 c)
+{
+#if defined(__FMA__)
+    return _mm512_fmadd_ps(a, b, c);
+#else
+    return _mm512_add_ps(_mm512_mul_ps(a, b), c);
+#endif
+}
+
+CGMINLINE __m512 gmClampLanes16(__m512 x, __m512 lo, __m512 hi)
+{
+    return _mm512_max_ps(lo, _mm512_min_ps(x, hi));
+}
+
+CGMINLINE __m512 gmFractLanes16(__m512 x)
+{
+    return _mm512_sub_ps(x, _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+}
+
+CGMINLINE __m512 gmMixLanes16(__m512 a, __m512 b, __m512 t)
+{
+    return gmFmaLanes16(_mm512_sub_ps(b, a), t, a);
+}
+
+CGMINLINE __m512 gmStepLanes16(__m512 e, __m512 x)
+{
+    /* not-less-than, unordered true: NaN gives 1 like gmStep */
+    return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(x, e, _CMP_NLT_UQ), _mm512_set1_ps(1.0f));
+}
+
+CGMINLINE __m512 gmSmoothLanes16(__m512 t)
+{
+    __m512 p = gmFmaLanes16(_mm512_set1_ps(-2.0f), t, _mm512_set1_ps(3.0f));
+    return _mm512_mul_ps(_mm512_mul_ps(t, t), p);
+}
+
+CGMINLINE __m512 gmFadeLanes16(__m512 t)
+{
+    __m512 p = gmFmaLanes16(t, _mm512_set1_ps(6.0f), _mm512_set1_ps(-15.0f));
+    p = gmFmaLanes16(t, p, _mm512_set1_ps(10.0f));
+    return _mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(t, t), t), p);
+}
+
+CGMINLINE __m512 gmSmoothstepLanes16(__m512 e0, __m512 s, __m512 x)
+{
+    __m512 t = _mm512_mul_ps(_mm512_sub_ps(x, e0), s);
+    return gmSmoothLanes16(gmClampLanes16(t, _mm512_setzero_ps(), _mm512_set1_ps(1.0f)));
+}
+
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* element-wise                                                                */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief out[i] = gmClamp(x[i], min, max)
+ */
+CGMINLINE void gmClampArray(const float *x, size_t n, float min, float max, float *out)
+{
+    simdf lo = gmSimdsplat(min);
+    simdf hi = gmSimdsplat(max);
+    size_t i = 0;
+
+#if defined(CGM_STREAM_AVX512)
+    for(; i + 16 <= n; i += 16)
+    {
+        _mm512_storeu_ps(out + i, gmClampLanes16(_mm512_loadu_ps(x + i), _mm512_set1_ps(min), _mm512_set1_ps(max)));
+    }
+#endif
+
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        gmSimdstore(out + i, gmClampLanes(gmSimdload(x + i), lo, hi));
+    }
+
+    for(; i < n; i++)
+    {
+        out[i] = gmClamp(x[i], min, max);
+    }
+}
+
+/**
+ * @brief out[i] = gmFract(x[i])
+ */
+CGMINLINE void gmFractArray(const float *x, size_t n, float *out)
+{
+    size_t i = 0;
+
+#if defined(CGM_STREAM_AVX512)
+    for(; i + 16 <= n; i += 16)
+    {
+        _mm512_storeu_ps(out + i, gmFractLanes16(_mm512_loadu_ps(x + i)));
+    }
+#endif
+
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        gmSimdstore(out + i, gmFractLanes(gmSimdload(x + i)));
+    }
+
+    for(; i < n; i++)
+    {
+        out[i] = gmFract(x[i]);
+    }
+}
+
+/**
+ * @brief out[i] = gmMix(a[i], b[i], t[i])
+ */
+CGMINLINE void gmMixArray(const float *a, const float *b, const float *t, size_t n, float *out)
+{
+    size_t i = 0;
+
+#if defined(CGM_STREAM_AVX512)
+    for(; i + 16 <= n; i += 16)
+    {
+        _mm512_storeu_ps(out + i, gmMixLanes16(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), _mm512_loadu_ps(t + i)));
+    }
+#endif
+
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        gmSimdstore(out + i, gmMixLanes(gmSimdload(a + i), gmSimdload(b + i), gmSimdload(t + i)));
+    }
+
+    for(; i < n; i++)
+    {
+        out[i] = gmMix(a[i], b[i], t[i]);
+    }
+}
+
+/**
+ * @brief out[i] = gmMix(a, b, t[i]), remaps a [0, 1] mask to [a, b]
+ */
+CGMINLINE void gmMixArrayRange(float a, float b, const float *t, size_t n, float *out)
+{
+    simdf va = gmSimdsplat(a);
+    simdf vb = gmSimdsplat(b);
+    size_t i = 0;
+
+#if defined(CGM_STREAM_AVX512)
+    for(; i + 16 <= n; i += 16)
+    {
+        _mm512_storeu_ps(out + i, gmMixLanes16(_mm512_set1_ps(a), _mm512_set1_ps(b), _mm512_loadu_ps(t + i)));
+    }
+#endif
+
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        gmSimdstore(out + i, gmMixLanes(va, vb, gmSimdload(t + i)));
+    }
+
+    for(; i < n; i++)
+    {
+        out[i] = gmMix(a, b, t[i]);
+    }
+}
+
+/**
+ * @brief out[i] = gmStep(e, x[i])
+ */
+CGMINLINE void gmStepArray(float e, const float *x, size_t n, float *out)
+{
+    simdf ve = gmSimdsplat(e);
+    size_t i = 0;
+
+#if defined(CGM_STREAM_AVX512)
+    for(; i + 16 <= n; i += 16)
+    {
+        _mm512_storeu_ps(out + i, gmStepLanes16(_mm512_set1_ps(e), _mm512_loadu_ps(x + i)));
+    }
+#endif
+
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        gmSimdstore(out + i, gmStepLanes(ve, gmSimdload(x + i)));
+    }
+
+    for(; i < n; i++)
+    {
+        out[i] = gmStep(e, x[i]);
+    }
+}
+
+/**
+ * @brief out[i] = gmSmoothstep(e0, e1, x[i])
+ *
+ * the division by (e1 - e0) is hoisted into one reciprocal, so results
+ * can differ from `gmSmoothstep` by an ulp.
+ */
+CGMINLINE void gmSmoothstepArray(float e0, float e1, const float *x, size_t n, float *out)
+{
+    float s = 1.0f / (e1 - e0);
+    simdf ve = gmSimdsplat(e0);
+    simdf vs = gmSimdsplat(s);
+    size_t i = 0;
+
+#if defined(CGM_STREAM_AVX512)
+    for(; i + 16 <= n; i += 16)
+    {
+        _mm512_storeu_ps(out + i, gmSmoothstepLanes16(_mm512_set1_ps(e0), _mm512_set1_ps(s), _mm512_loadu_ps(x + i)));
+    }
+#endif
+
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        gmSimdstore(out + i, gmSmoothstepLanes(ve, vs, gmSimdload(x + i)));
+    }
+
+    for(; i < n; i++)
+    {
+        out[i] = gmSmooth(gmClamp((x[i] - e0) * s, 0.0f, 1.0f));
+    }
+}
+
+/**
+ * @brief out[i] = gmFade(t[i])
+ */
+CGMINLINE void gmFadeArray(const float *t, size_t n, float *out)
+{
+    size_t i = 0;
+
+#if defined(CGM_STREAM_AVX512)
+    for(; i + 16 <= n; i += 16)
+    {
+        _mm512_storeu_ps(out + i, gmFadeLanes16(_mm512_loadu_ps(t + i)));
+    }
+#endif
+
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        gmSimdstore(out + i, gmFadeLanes(gmSimdload(t + i)));
+    }
+
+    for(; i < n; i++)
+    {
+        out[i] = gmFade(t[i]);
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* fused chains                                                                */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief out[i] = gmMix(a[i], b[i], gmFade(gmFract(t[i])))
+ *
+ * the usual value-noise / tiling blend in one pass.
+ */
+CGMINLINE void gmFractFadeMixArray(const float *a, const float *b, const float *t, size_t n, float *out)
+{
+    size_t i = 0;
+
+#if defined(CGM_STREAM_AVX512)
+    for(; i + 16 <= n; i += 16)
+    {
+        __m512 f = gmFadeLanes16(gmFractLanes16(_mm512_loadu_ps(t + i)));
+        _mm512_storeu_ps(out + i, gmMixLanes16(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), f));
+    }
+#endif
+
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        simdf f = gmFadeLanes(gmFractLanes(gmSimdload(t + i)));
+        gmSimdstore(out + i, gmMixLanes(gmSimdload(a + i), gmSimdload(b + i), f));
+    }
+
+    for(; i < n; i++)
+    {
+        out[i] = gmMix(a[i], b[i], gmFade(gmFract(t[i])));
+    }
+}
+
+/**
+ * @brief out[i] = gmMix(a[i], b[i], gmSmoothstep(e0, e1, x[i]))
+ *
+ * blends two layers by a soft threshold on a mask / height field.
+ */
+CGMINLINE void gmSmoothstepMixArray(const float *a, const float *b, float e0, float e1, const float *x,
+                                    size_t n, float *out)
+{
+    float s = 1.0f / (e1 - e0);
+    simdf ve = gmSimdsplat(e0);
+    simdf vs = gmSimdsplat(s);
+    size_t i = 0;
+
+#if defined(CGM_STREAM_AVX512)
+    for(; i + 16 <= n; i += 16)
+    {
+        __m512 f = gmSmoothstepLanes16(_mm512_set1_ps(e0), _mm512_set1_ps(s), _mm512_loadu_ps(x + i));
+        _mm512_storeu_ps(out + i, gmMixLanes16(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), f));
+    }
+#endif
+
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        simdf f = gmSmoothstepLanes(ve, vs, gmSimdload(x + i));
+        gmSimdstore(out + i, gmMixLanes(gmSimdload(a + i), gmSimdload(b + i), f));
+    }
+
+    for(; i < n; i++)
+    {
+        out[i] = gmMix(a[i], b[i], gmSmooth(gmClamp((x[i] - e0) * s, 0.0f, 1.0f)));
+    }
+}
+
+/**
+ * @brief out[i] = gmClamp(x[i] * scale + bias, min, max)
+ *
+ * range remap of a height field / image channel followed by saturation.
+ */
+CGMINLINE void gmScaleBiasClampArray(const float *x, size_t n, float scale, float bias, float min, float max,
+                                     float *out)
+{
+    simdf vs = gmSimdsplat(scale);
+    simdf vb = gmSimdsplat(bias);
+    simdf lo = gmSimdsplat(min);
+    simdf hi = gmSimdsplat(max);
+    size_t i = 0;
+
+#if defined(CGM_STREAM_AVX512)
+    for(; i + 16 <= n; i += 16)
+    {
+        __m512 v = gmFmaLanes16(_mm512_loadu_ps(x + i), _mm512_set1_ps(scale), _mm512_set1_ps(bias));
+        _mm512_storeu_ps(out + i, gmClampLanes16(v, _mm512_set1_ps(min), _mm512_set1_ps(max)));
+    }
+#endif
+
+    for(; i + CGM_SIMD_WIDTH <= n; i += CGM_SIMD_WIDTH)
+    {
+        gmSimdstore(out + i, gmClampLanes(gmSimdfma(gmSimdload(x + i), vs, vb), lo, hi));
+    }
+
+    for(; i < n; i++)
+    {
+        out[i] = gmClamp(x[i] * scale + bias, min, max);
+    }
+}
+
+#endif
@@ -11,6 +11,8 @@
 #include <math.h>
 
 #define CGM_EPSILON 1e-8f
+#define CGM_SQRT2     1.41421356f
+#define CGM_INV_SQRT2 0.70710678f
 #ifndef CGM_ASSUME_NORMALIZED
 /*
  * @brief `CGM_ASSUME_NORMALIZED`
@@ -104,4 +106,13 @@ CGMINLINE float gmFade(float t)
     return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
 }
 
+/*
+ * @brief derivative of `gmFade`: 30 t^2 (t - 1)^2
+ */
+CGMINLINE float gmFadeDerivative(float t)
+{
+    float w = t * (t - 1.0f);
+    return 30.0f * w * w;
+}
+
 #endif
\ No newline at end of file
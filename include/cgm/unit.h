@@ -0,0 +1,144 @@
+#ifndef CGM_UNIT_H
+#define CGM_UNIT_H
+
+/**
+ * @file unit.h
+ * unit vectors as distinct types, so functions that need a normalized input
+ * can skip the normalization without trusting every caller.
+ *
+ * `CGM_ASSUME_NORMALIZED` decides for the whole program whether
+ * `gmVec3reflect` & co. normalize; the `*Unit` variants below never do,
+ * and are safe because a `unitvec3` can only come from a normalizing
+ * constructor or an operation that preserves length.
+ */
+
+#include "core.h"
+#include "ugm/ugm.h"
+#include "structs/stcunit.h"
+#include "vec2.h"
+#include "vec3.h"
+#include "quat.h"
+
+#define CGM_UNITVEC2_X ((unitvec2){{1.0f, 0.0f}})
+#define CGM_UNITVEC2_Y ((unitvec2){{0.0f, 1.0f}})
+#define CGM_UNITVEC3_X ((unitvec3){{1.0f, 0.0f, 0.0f}})
+#define CGM_UNITVEC3_Y ((unitvec3){{0.0f, 1.0f, 0.0f}})
+#define CGM_UNITVEC3_Z ((unitvec3){{0.0f, 0.0f, 1.0f}})
+
+/*
+ * @brief normalizes `v`
+ *
+ * @return unit vector, `CGM_UNITVEC2_X` if `v` has length 0
+ */
+CGMINLINE unitvec2 gmUnitVec2(vec2 v)
+{
+    float l = gmVec2length(v);
+    return (l == 0.0f) ? CGM_UNITVEC2_X : (unitvec2){gmVec2mulScale(v, 1.0f / l)};
+}
+
+/*
+ * @brief normalizes `v`
+ *
+ * @return unit vector, `CGM_UNITVEC3_Z` if `v` has length 0
+ */
+CGMINLINE unitvec3 gmUnitVec3(vec3 v)
+{
+    float l = gmVec3length(v);
+    return (l == 0.0f) ? CGM_UNITVEC3_Z : (unitvec3){gmVec3mulScale(v, 1.0f / l)};
+}
+
+/*
+ * @brief normalizes `v`, returns `fallback` if `v` has length 0
+ */
+CGMINLINE unitvec3 gmUnitVec3or(vec3 v, unitvec3 fallback)
+{
+    float l = gmVec3length(v);
+    return (l == 0.0f) ? fallback : (unitvec3){gmVec3mulScale(v, 1.0f / l)};
+}
+
+CGMINLINE unitvec2 gmUnitVec2neg(unitvec2 u)
+{
+    return (unitvec2){gmVec2(-u.v.x, -u.v.y)};
+}
+
+CGMINLINE unitvec3 gmUnitVec3neg(unitvec3 u)
+{
+    return (unitvec3){gmVec3(-u.v.x, -u.v.y, -u.v.z)};
+}
+
+/*
+ * @brief direction from `a` to `b`
+ */
+CGMINLINE unitvec3 gmUnitVec3dir(vec3 a, vec3 b)
+{
+    return gmUnitVec3(gmVec3sub(b, a));
+}
+
+/*
+ * @brief `gmVec2reflect` without normalizing `n`
+ */
+CGMINLINE vec2 gmVec2reflectUnit(vec2 v, unitvec2 n)
+{
+    float d = gmVec2dot(v, n.v);
+    return gmVec2sub(v, gmVec2mulScale(n.v, 2.0f * d));
+}
+
+/*
+ * @brief `gmVec2refract` without normalizing `n`
+ */
+CGMINLINE vec2 gmVec2refractUnit(vec2 v, unitvec2 n, float e)
+{
+    float d = gmVec2dot(n.v, v);
+    float k = 1.0f - e * e * (1.0f - d * d);
+
+    return (k < 0.0f) ? CGM_VEC2_ZERO :
+    gmVec2sub(
+        gmVec2mulScale(v, e),
+        gmVec2mulScale(n.v, e * d + sqrtf(k))
+    );
+}
+
+/*
+ * @brief `gmVec3reflect` without normalizing `n`
+ */
+CGMINLINE vec3 gmVec3reflectUnit(vec3 v, unitvec3 n)
+{
+    float d = gmVec3dot(v, n.v);
+    return gmVec3sub(v, gmVec3mulScale(n.v, 2.0f * d));
+}
+
+/*
+ * @brief `gmVec3refract` without normalizing `n`
+ */
+CGMINLINE vec3 gmVec3refractUnit(vec3 v, unitvec3 n, float e)
+{
+    float d = gmVec3dot(n.v, v);
+    float k = 1.0f - e * e * (1.0f - d * d);
+
+    return (k < 0.0f) ? CGM_VEC3_ZERO :
+    gmVec3sub(
+        gmVec3mulScale(v, e),
+        gmVec3mulScale(n.v, e * d + sqrtf(k))
+    );
+}
+
+/*
+ * @brief `gmQuatAngle` without normalizing the axis
+ *
+ * @param va rotation axis
+ * @param a rotation angle in radians
+ */
+CGMINLINE quat gmQuatAngleUnit(unitvec3 va, float a)
+{
+    float h = a * 0.5f;
+    float s = sinf(h);
+
+    return gmQuat(
+        va.v.x * s,
+        va.v.y * s,
+        va.v.z * s,
+        cosf(h)
+    );
+}
+
+#endif
\ No newline at end of file
@@ -161,6 +161,7 @@ CGMINLINE float gmVec2distance(vec2 a, vec2 b)
  * 
  * @note if `CGM_ASSUME_NORMALIZED` is 0,
  * normal is automatically normalized
+ * `gmVec2reflectUnit` (unit.h) takes a `unitvec2` and never normalizes
  */
 CGMINLINE vec2 gmVec2reflect(vec2 v, vec2 n)
 {
@@ -180,6 +181,7 @@ CGMINLINE vec2 gmVec2reflect(vec2 v, vec2 n)
  * 
  * @note if `CGM_ASSUME_NORMALIZED` is 0,
  * normal is automatically normalized
+ * `gmVec2refractUnit` (unit.h) takes a `unitvec2` and never normalizes
  */
 CGMINLINE vec2 gmVec2refract(vec2 v, vec2 n, float e)
 {
@@ -186,6 +186,7 @@ CGMINLINE float gmVec3distance(vec3 a, vec3 b)
  * 
  * @note if `CGM_ASSUME_NORMALIZED` is 0,
  * normal is automatically normalized
+ * `gmVec3reflectUnit` (unit.h) takes a `unitvec3` and never normalizes
  */
 CGMINLINE vec3 gmVec3reflect(vec3 v, vec3 n)
 {
@@ -205,6 +206,7 @@ CGMINLINE vec3 gmVec3reflect(vec3 v, vec3 n)
  * 
  * @note if `CGM_ASSUME_NORMALIZED` is 0,
  * normal is automatically normalized
+ * `gmVec3refractUnit` (unit.h) takes a `unitvec3` and never normalizes
  */
 CGMINLINE vec3 gmVec3refract(vec3 v, vec3 n, float e)
 {
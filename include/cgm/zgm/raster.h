@@ -0,0 +1,727 @@
+#ifndef RASTER_GRAPHICS_MATH
+#define RASTER_GRAPHICS_MATH
+
+/**
+ * @file raster.h
+ * @brief tile-binned software depth rasterizer (occlusion buffers, thumbnails)
+ *
+ * pipeline of one `gmRasterTriangles` call:
+ *  1. setup (parallel over triangles): frustum reject, back-face culling,
+ *     snapping to 1/16 pixel, integer edge functions and a depth plane.
+ *     triangles crossing the near / far planes or the guard band are
+ *     flagged for clipping.
+ *  2. binning (serial, in submission order): flagged triangles are clipped
+ *     in homogeneous space and fanned into up to `CGM_RASTER_CLIP_TRIS`
+ *     pieces, then every triangle is counting-sorted into the
+ *     `CGM_RASTER_TILE` square tiles its bounding box touches.
+ *  3. raster (parallel over tiles): each tile walks its bin in order and
+ *     tests `CGM_SIMD_WIDTH` pixels at a time with the three edge
+ *     functions, interpolates depth, depth-tests and writes depth and
+ *     coverage.
+ *
+ * every tile is owned by one thread and sees its triangles in submission
+ * order, so the buffers do not depend on the number of threads. pixels
+ * are sampled at their centers; pixels on an edge shared by two
+ * triangles belong to exactly one of them.
+ *
+ * edge functions are evaluated in int32. coordinates are kept within a
+ * guard band of `CGM_RASTER_GUARD` pixels around the viewport center,
+ * which bounds every edge value by 2^30, so viewports are limited to
+ * `CGM_RASTER_GUARD` pixels on each side.
+ *
+ * memory is supplied by the caller (`gmRasterBytes`). draws larger than
+ * the `batch` given at init are processed in several rounds.
+ *
+ * `depth` is row-major with `width` floats per row, the layout of
+ * `gmUnprojectDepth` (tgm/unproject.h) when both use the same flags;
+ * `gmPackUnorm8Array` (ugm/color.h) turns it into an 8-bit image.
+ */
+
+#include "../core.h"
+#include "../ugm/ugm.h"
+#include "../vec3.h"
+#include "../vec4.h"
+#include "../mat4.h"
+#include "../sgm/simd.h"
+#include "../jgm/job.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef CGM_RASTER_TILE
+#define CGM_RASTER_TILE 32 /* tile edge in pixels, multiple of 8 */
+#endif
+
+#ifndef CGM_RASTER_GRAIN
+#define CGM_RASTER_GRAIN 4096 /* triangles / vertices per parallel chunk */
+#endif
+
+#ifndef CGM_RASTER_REFS
+#define CGM_RASTER_REFS 4 /* bin entries reserved per triangle of a batch */
+#endif
+
+#define CGM_RASTER_GUARD     2048 /* guard band extent in pixels */
+#define CGM_RASTER_SUBPIXEL  16   /* fixed point steps per pixel */
+#define CGM_RASTER_CLIP_TRIS 7    /* triangles out of one clipped triangle */
+
+/* init flags, same values as the CGM_UNPROJECT_* flags */
+#define CGM_RASTER_ZERO_TO_ONE 1  /* clip z in [0, w] (D3D / Vulkan), else [-w, w] */
+#define CGM_RASTER_TOP_DOWN    2  /* row 0 is the top of the image */
+#define CGM_RASTER_REVERSED_Z  4  /* greater depth wins, cleared to 0 */
+
+/* draw flags */
+#define CGM_RASTER_CULL_BACK   8  /* drop clockwise triangles (in NDC) */
+#define CGM_RASTER_CULL_FRONT  16 /* drop counter-clockwise triangles */
+
+/* setup state of a triangle */
+#define CGM_RASTER_EMPTY 0
+#define CGM_RASTER_READY 1
+#define CGM_RASTER_CLIP  2
+
+typedef struct
+{
+    int32_t a[3], b[3], c[3]; /* edge i at pixel (x, y): a x + b y + c >= 0 inside */
+    float   z, zx, zy;        /* depth at pixel (x0, y0) and its slopes */
+    int32_t x0, y0, x1, y1;   /* pixel bounds, x1 / y1 exclusive */
+    int32_t state;
+} gmRasterTri;
+
+typedef struct
+{
+    float       *depth;    /* width x height, row-major */
+    uint32_t    *coverage; /* draw id of every pixel, 0 where nothing was drawn */
+    int          width;
+    int          height;
+    int          flags;
+    int          tilesX;
+    int          tilesY;
+    float        gx, gy;   /* guard band half extent in NDC */
+    size_t       batch;    /* triangles set up per round */
+    size_t       refCount; /* capacity of `refs` */
+    gmRasterTri *tris;     /* batch setup slots, then as many clipped pieces */
+    uint32_t    *order;    /* slots of a round in submission order */
+    uint32_t    *start;    /* tiles + 1 bin offsets into refs */
+    uint32_t    *cursor;   /* tiles */
+    uint32_t    *refs;     /* triangle slots in bin order */
+} gmRaster;
+
+/* -------------------------------------------------------------------------- */
+/* init                                                                        */
+/* -------------------------------------------------------------------------- */
+
+CGMINLINE size_t gmRasterBatch(size_t batch)
+{
+    return GMMAX(batch, (size_t)CGM_RASTER_CLIP_TRIS);
+}
+
+CGMINLINE size_t gmRasterTiles(int width, int height)
+{
+    return (size_t)((width + CGM_RASTER_TILE - 1) / CGM_RASTER_TILE) *
+           (size_t)((height + CGM_RASTER_TILE - 1) / CGM_RASTER_TILE);
+}
+
+CGMINLINE size_t gmRasterRefs(int width, int height, size_t batch)
+{
+    return CGM_RASTER_REFS * gmRasterBatch(batch) + CGM_RASTER_CLIP_TRIS * gmRasterTiles(width, height);
+}
+
+/**
+ * @brief bytes of memory needed for a `width` x `height` target
+ * @param batch triangles set up per round (e.g. 65536)
+ */
+CGMINLINE size_t gmRasterBytes(int width, int height, size_t batch)
+{
+    size_t pixels = (size_t)width * (size_t)height;
+    size_t tiles = gmRasterTiles(width, height);
+    batch = gmRasterBatch(batch);
+    return pixels * (sizeof(float) + sizeof(uint32_t)) +
+           2 * batch * (sizeof(gmRasterTri) + sizeof(uint32_t)) +
+           (2 * tiles + 1 + gmRasterRefs(width, height, batch)) * sizeof(uint32_t);
+}
+
+/**
+ * @brief sets up a render target on caller memory; call `gmRasterClear`
+ * before the first draw
+ *
+ * @param mem at least `gmRasterBytes(width, height, batch)` bytes, 4-byte aligned
+ * @param width, height target size, at most `CGM_RASTER_GUARD`
+ * @param batch triangles set up per round
+ * @param flags CGM_RASTER_ZERO_TO_ONE, CGM_RASTER_TOP_DOWN, CGM_RASTER_REVERSED_Z
+ */
+CGMINLINE gmRaster gmRasterInit(void *mem, int width, int height, size_t batch, int flags)
+{
+    gmRaster r;
+    size_t pixels = (size_t)width * (size_t)height;
+    size_t tiles = gmRasterTiles(width, height);
+
+    r.width = width;
+    r.height = height;
+    r.flags = flags;
+    r.tilesX = (width + CGM_RASTER_TILE - 1) / CGM_RASTER_TILE;
+    r.tilesY = (height + CGM_RASTER_TILE - 1) / CGM_RASTER_TILE;
+    r.gx = (float)CGM_RASTER_GUARD / (float)width;
+    r.gy = (float)CGM_RASTER_GUARD / (float)height;
+    r.batch = gmRasterBatch(batch);
+    r.refCount = gmRasterRefs(width, height, batch);
+    r.depth = (float *)mem;
+    r.coverage = (uint32_t *)(r.depth + pixels);
+    r.tris = (gmRasterTri *)(r.coverage + pixels);
+    r.order = (uint32_t *)(r.tris + 2 * r.batch);
+    r.start = r.order + 2 * r.batch;
+    r.cursor = r.start + tiles + 1;
+    r.refs = r.cursor + tiles;
+    return r;
+}
+
+/**
+ * @brief resets depth to the far value and coverage to 0
+ */
+CGMINLINE void gmRasterClear(gmRaster *r)
+{
+    size_t pixels = (size_t)r->width * (size_t)r->height;
+    float clear = (r->flags & CGM_RASTER_REVERSED_Z) ? 0.0f : 1.0f;
+
+    for(size_t i = 0; i < pixels; i++)
+    {
+        r->depth[i] = clear;
+    }
+    memset(r->coverage, 0, pixels * sizeof(uint32_t));
+}
+
+/* -------------------------------------------------------------------------- */
+/* vertex transform                                                            */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief clip space positions m * (p, 1) of n points
+ * @param m projection * view * model
+ */
+CGMINLINE void gmRasterTransform(mat4 m, const vec3 *p, size_t n, vec4 *out)
+{
+    for(size_t i = 0; i < n; i += CGM_SIMD_WIDTH)
+    {
+        size_t k = GMMIN((size_t)CGM_SIMD_WIDTH, n - i);
+        float t[4][CGM_SIMD_WIDTH];
+
+        for(size_t l = 0; l < CGM_SIMD_WIDTH; l++)
+        {
+            t[0][l] = (l < k) ? p[i + l].x : 0.0f;
+            t[1][l] = (l < k) ? p[i + l].y : 0.0f;
+            t[2][l] = (l < k) ? p[i + l].z : 0.0f;
+        }
+
+        simdf x = gmSimdload(t[0]), y = gmSimdload(t[1]), z = gmSimdload(t[2]);
+        for(int r = 0; r < 4; r++)
+        {
+            gmSimdstore(t[r], gmSimdfma(gmSimdsplat(m.m[r]), x, gmSimdfma(gmSimdsplat(m.m[4 + r]), y,
+                              gmSimdfma(gmSimdsplat(m.m[8 + r]), z, gmSimdsplat(m.m[12 + r])))));
+        }
+        for(size_t l = 0; l < k; l++)
+        {
+            out[i + l] = gmVec4(t[0][l], t[1][l], t[2][l], t[3][l]);
+        }
+    }
+}
+
+typedef struct
+{
+    mat4        m;
+    const vec3 *p;
+    vec4       *out;
+} gmRasterTransformJob;
+
+CGMINLINE void gmRasterTransformTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmRasterTransformJob *j = (gmRasterTransformJob *)ctx;
+    (void)thread;
+    gmRasterTransform(j->m, j->p + b, e - b, j->out + b);
+}
+
+/**
+ * @brief `gmRasterTransform` split across the job pool
+ */
+CGMINLINE void gmRasterTransformParallel(mat4 m, const vec3 *p, size_t n, vec4 *out)
+{
+    gmRasterTransformJob j = {m, p, out};
+    gmParallelFor(n, CGM_RASTER_GRAIN, gmRasterTransformTask, &j);
+}
+
+/* -------------------------------------------------------------------------- */
+/* clipping                                                                    */
+/* -------------------------------------------------------------------------- */
+
+/*
+ * @brief signed distances of v to the near, far, left, right, bottom and
+ * top planes, with the x / y planes on the guard band
+ */
+CGMINLINE void gmRasterPlanes(const gmRaster *r, vec4 v, float *d)
+{
+    d[0] = (r->flags & CGM_RASTER_ZERO_TO_ONE) ? v.z : v.z + v.w;
+    d[1] = v.w - v.z;
+    d[2] = r->gx * v.w + v.x;
+    d[3] = r->gx * v.w - v.x;
+    d[4] = r->gy * v.w + v.y;
+    d[5] = r->gy * v.w - v.y;
+}
+
+/*
+ * @brief bit i set when v is outside plane i of the view frustum, `guard`
+ * gets the same bits for the guard band
+ */
+CGMINLINE int gmRasterOutcode(const gmRaster *r, vec4 v, int *guard)
+{
+    float d[6];
+    gmRasterPlanes(r, v, d);
+
+    int z = (d[0] < 0.0f) | (d[1] < 0.0f) << 1;
+    *guard = z | (d[2] < 0.0f) << 2 | (d[3] < 0.0f) << 3 | (d[4] < 0.0f) << 4 | (d[5] < 0.0f) << 5;
+    return z | (v.w + v.x < 0.0f) << 2 | (v.w - v.x < 0.0f) << 3 | (v.w + v.y < 0.0f) << 4 | (v.w - v.y < 0.0f) << 5;
+}
+
+/*
+ * @brief clips the polygon against the planes in `mask` (Sutherland-Hodgman)
+ * @param v polygon, room for 3 + 6 vertices
+ * @return vertex count, < 3 when nothing is left
+ */
+CGMINLINE int gmRasterClipPolygon(const gmRaster *r, vec4 *v, int n, int mask)
+{
+    vec4 tmp[9];
+
+    for(int p = 0; p < 6 && n >= 3; p++)
+    {
+        if(!(mask & (1 << p)))
+        {
+            continue;
+        }
+
+        float d[9], t[6];
+        for(int i = 0; i < n; i++)
+        {
+            gmRasterPlanes(r, v[i], t);
+            d[i] = t[p];
+        }
+
+        int m = 0;
+        for(int i = 0; i < n; i++)
+        {
+            int j = (i + 1 == n) ? 0 : i + 1;
+            if(d[i] >= 0.0f)
+            {
+                tmp[m++] = v[i];
+            }
+            if((d[i] >= 0.0f) != (d[j] >= 0.0f))
+            {
+                /* always from the inside vertex, so a shared edge clips to the same point */
+                int a = (d[i] >= 0.0f) ? i : j, b = (a == i) ? j : i;
+                float s = d[a] / (d[a] - d[b]);
+                tmp[m++] = gmVec4(v[a].x + s * (v[b].x - v[a].x), v[a].y + s * (v[b].y - v[a].y),
+                                  v[a].z + s * (v[b].z - v[a].z), v[a].w + s * (v[b].w - v[a].w));
+            }
+        }
+        for(int i = 0; i < m; i++)
+        {
+            v[i] = tmp[i];
+        }
+        n = m;
+    }
+    return n;
+}
+
+/* -------------------------------------------------------------------------- */
+/* triangle setup                                                              */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief edge functions, bounds and depth plane of a triangle inside the
+ * guard band
+ *
+ * @param flags CGM_RASTER_CULL_BACK, CGM_RASTER_CULL_FRONT
+ * @return 0 when the triangle is culled, degenerate or covers no pixel center
+ */
+CGMINLINE int gmRasterSetup(const gmRaster *r, vec4 v0, vec4 v1, vec4 v2, int flags, gmRasterTri *t)
+{
+    const vec4 *v[3] = {&v0, &v1, &v2};
+    int64_t X[3], Y[3];
+    float Z[3];
+    int down = (r->flags & CGM_RASTER_TOP_DOWN) != 0;
+
+    for(int i = 0; i < 3; i++)
+    {
+        if(!(v[i]->w > 0.0f))
+        {
+            return 0;
+        }
+        float iw = 1.0f / v[i]->w;
+        float x = (v[i]->x * iw * 0.5f + 0.5f) * (float)r->width;
+        float y = (down ? 0.5f - v[i]->y * iw * 0.5f : v[i]->y * iw * 0.5f + 0.5f) * (float)r->height;
+        float z = v[i]->z * iw;
+
+        X[i] = (int64_t)floorf(x * CGM_RASTER_SUBPIXEL + 0.5f);
+        Y[i] = (int64_t)floorf(y * CGM_RASTER_SUBPIXEL + 0.5f);
+        Z[i] = (r->flags & CGM_RASTER_ZERO_TO_ONE) ? z : z * 0.5f + 0.5f;
+    }
+
+    int64_t area = (X[1] - X[0]) * (Y[2] - Y[0]) - (X[2] - X[0]) * (Y[1] - Y[0]);
+    if(area == 0)
+    {
+        return 0;
+    }
+
+    /* counter-clockwise in NDC is clockwise on a top-down target */
+    int front = down ? area < 0 : area > 0;
+    if((front && (flags & CGM_RASTER_CULL_FRONT)) || (!front && (flags & CGM_RASTER_CULL_BACK)))
+    {
+        return 0;
+    }
+    if(area < 0)
+    {
+        int64_t x = X[1], y = Y[1];
+        float z = Z[1];
+        X[1] = X[2]; Y[1] = Y[2]; Z[1] = Z[2];
+        X[2] = x;    Y[2] = y;    Z[2] = z;
+        area = -area;
+    }
+
+    /* pixel x covers subpixel sample 16 x + 8, >> 4 floors the division by 16 */
+    const int64_t half = CGM_RASTER_SUBPIXEL / 2;
+    int64_t minX = GMMIN(X[0], GMMIN(X[1], X[2])), maxX = GMMAX(X[0], GMMAX(X[1], X[2]));
+    int64_t minY = GMMIN(Y[0], GMMIN(Y[1], Y[2])), maxY = GMMAX(Y[0], GMMAX(Y[1], Y[2]));
+    int64_t x0 = (minX - half + CGM_RASTER_SUBPIXEL - 1) >> 4, x1 = ((maxX - half) >> 4) + 1;
+    int64_t y0 = (minY - half + CGM_RASTER_SUBPIXEL - 1) >> 4, y1 = ((maxY - half) >> 4) + 1;
+
+    t->x0 = (int32_t)GMMAX(x0, (int64_t)0);
+    t->y0 = (int32_t)GMMAX(y0, (int64_t)0);
+    t->x1 = (int32_t)GMMIN(x1, (int64_t)r->width);
+    t->y1 = (int32_t)GMMIN(y1, (int64_t)r->height);
+    if(t->x0 >= t->x1 || t->y0 >= t->y1)
+    {
+        return 0;
+    }
+
+    for(int i = 0; i < 3; i++)
+    {
+        int j = (i == 2) ? 0 : i + 1;
+        int64_t a = Y[i] - Y[j], b = X[j] - X[i];
+        int64_t c = -(a * X[i] + b * Y[i]);
+
+        /* of the two directions of a shared edge exactly one keeps e == 0 */
+        int64_t bias = (a > 0 || (a == 0 && b < 0)) ? 0 : -1;
+        t->a[i] = (int32_t)(a * CGM_RASTER_SUBPIXEL);
+        t->b[i] = (int32_t)(b * CGM_RASTER_SUBPIXEL);
+        t->c[i] = (int32_t)(c + (a + b) * half + bias);
+    }
+
+    /* depth plane, slopes per pixel from exact subpixel deltas */
+    float dx1 = (float)(X[1] - X[0]), dy1 = (float)(Y[1] - Y[0]), dz1 = Z[1] - Z[0];
+    float dx2 = (float)(X[2] - X[0]), dy2 = (float)(Y[2] - Y[0]), dz2 = Z[2] - Z[0];
+    float inv = (float)CGM_RASTER_SUBPIXEL / (float)area;
+
+    t->zx = (dz1 * dy2 - dz2 * dy1) * inv;
+    t->zy = (dx1 * dz2 - dx2 * dz1) * inv;
+    t->z = Z[0] + (t->zx * (float)(t->x0 * CGM_RASTER_SUBPIXEL + half - X[0]) +
+                   t->zy * (float)(t->y0 * CGM_RASTER_SUBPIXEL + half - Y[0])) / CGM_RASTER_SUBPIXEL;
+    return 1;
+}
+
+typedef struct
+{
+    gmRaster       *r;
+    const vec4     *clip;
+    const uint32_t *index;
+    size_t          first; /* first triangle of the round */
+    uint32_t        id;
+    int             flags;
+} gmRasterJob;
+
+CGMINLINE void gmRasterVertices(const gmRasterJob *j, size_t tri, vec4 *v)
+{
+    for(int k = 0; k < 3; k++)
+    {
+        size_t i = 3 * tri + (size_t)k;
+        v[k] = j->clip[j->index ? j->index[i] : i];
+    }
+}
+
+CGMINLINE void gmRasterSetupTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmRasterJob *j = (gmRasterJob *)ctx;
+    const gmRaster *r = j->r;
+    (void)thread;
+
+    for(size_t i = b; i < e; i++)
+    {
+        gmRasterTri *t = &r->tris[i];
+        vec4 v[3];
+        gmRasterVertices(j, j->first + i, v);
+
+        int all = 0x3f, any = 0, guard;
+        for(int k = 0; k < 3; k++)
+        {
+            all &= gmRasterOutcode(r, v[k], &guard);
+            any |= guard;
+        }
+
+        if(all)
+        {
+            t->state = CGM_RASTER_EMPTY;
+        }
+        else if(any)
+        {
+            t->state = CGM_RASTER_CLIP;
+        }
+        else
+        {
+            t->state = gmRasterSetup(r, v[0], v[1], v[2], j->flags, t) ? CGM_RASTER_READY : CGM_RASTER_EMPTY;
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* binning                                                                     */
+/* -------------------------------------------------------------------------- */
+
+CGMINLINE size_t gmRasterTileCount(const gmRasterTri *t)
+{
+    size_t tx = (size_t)((t->x1 - 1) / CGM_RASTER_TILE - t->x0 / CGM_RASTER_TILE + 1);
+    size_t ty = (size_t)((t->y1 - 1) / CGM_RASTER_TILE - t->y0 / CGM_RASTER_TILE + 1);
+    return tx * ty;
+}
+
+/*
+ * @brief clips and bins the first n set up triangles of a round
+ * @return triangles binned; fewer than n when the clip slots or bin
+ * entries ran out, the rest goes to the next round
+ */
+CGMINLINE size_t gmRasterBin(gmRaster *r, const gmRasterJob *j, size_t n)
+{
+    size_t tiles = (size_t)r->tilesX * (size_t)r->tilesY;
+    size_t slot = r->batch, count = 0, used = 0, i;
+
+    memset(r->start, 0, (tiles + 1) * sizeof(uint32_t));
+    for(i = 0; i < n; i++)
+    {
+        gmRasterTri *t = &r->tris[i];
+        size_t first = count, need = 0;
+
+        if(t->state == CGM_RASTER_READY)
+        {
+            r->order[count++] = (uint32_t)i;
+            need = gmRasterTileCount(t);
+        }
+        else if(t->state == CGM_RASTER_CLIP)
+        {
+            if(slot + CGM_RASTER_CLIP_TRIS > 2 * r->batch)
+            {
+                break;
+            }
+
+            vec4 v[9];
+            int mask = 0, guard;
+            gmRasterVertices(j, j->first + i, v);
+            for(int k = 0; k < 3; k++)
+            {
+                gmRasterOutcode(r, v[k], &guard);
+                mask |= guard;
+            }
+
+            int m = gmRasterClipPolygon(r, v, 3, mask);
+            for(int k = 1; k + 1 < m; k++)
+            {
+                if(gmRasterSetup(r, v[0], v[k], v[k + 1], j->flags, &r->tris[slot]))
+                {
+                    need += gmRasterTileCount(&r->tris[slot]);
+                    r->order[count++] = (uint32_t)slot++;
+                }
+            }
+        }
+
+        if(used + need > r->refCount)
+        {
+            slot -= (t->state == CGM_RASTER_CLIP) ? count - first : 0;
+            count = first;
+            break;
+        }
+        used += need;
+
+        for(size_t k = first; k < count; k++)
+        {
+            const gmRasterTri *p = &r->tris[r->order[k]];
+            for(int ty = p->y0 / CGM_RASTER_TILE; ty <= (p->y1 - 1) / CGM_RASTER_TILE; ty++)
+            {
+                for(int tx = p->x0 / CGM_RASTER_TILE; tx <= (p->x1 - 1) / CGM_RASTER_TILE; tx++)
+                {
+                    r->start[(size_t)ty * (size_t)r->tilesX + (size_t)tx + 1]++;
+                }
+            }
+        }
+    }
+
+    for(size_t k = 0; k < tiles; k++)
+    {
+        r->start[k + 1] += r->start[k];
+        r->cursor[k] = r->start[k];
+    }
+    for(size_t k = 0; k < count; k++)
+    {
+        const gmRasterTri *p = &r->tris[r->order[k]];
+        for(int ty = p->y0 / CGM_RASTER_TILE; ty <= (p->y1 - 1) / CGM_RASTER_TILE; ty++)
+        {
+            for(int tx = p->x0 / CGM_RASTER_TILE; tx <= (p->x1 - 1) / CGM_RASTER_TILE; tx++)
+            {
+                r->refs[r->cursor[(size_t)ty * (size_t)r->tilesX + (size_t)tx]++] = r->order[k];
+            }
+        }
+    }
+    return i;
+}
+
+/* -------------------------------------------------------------------------- */
+/* raster                                                                      */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief rasterizes one triangle into the pixels [x0, x1) x [y0, y1) of a tile
+ *
+ * x0 must be a multiple of `CGM_SIMD_WIDTH`, x1 a multiple of it or the
+ * target width.
+ */
+CGMINLINE void gmRasterSpan(gmRaster *r, const gmRasterTri *t, uint32_t id, int x0, int y0, int x1, int y1)
+{
+    int bx0 = GMMAX(t->x0, x0) / CGM_SIMD_WIDTH * CGM_SIMD_WIDTH, bx1 = GMMIN(t->x1, x1);
+    int by0 = GMMAX(t->y0, y0), by1 = GMMIN(t->y1, y1);
+    int greater = (r->flags & CGM_RASTER_REVERSED_Z) != 0;
+    int32_t iota[CGM_SIMD_WIDTH];
+    float fiota[CGM_SIMD_WIDTH];
+
+    for(int l = 0; l < CGM_SIMD_WIDTH; l++)
+    {
+        iota[l] = l;
+        fiota[l] = (float)l;
+    }
+
+    simdi lane = gmSimdiload(iota);
+    simdi a0 = gmSimdisplat(t->a[0]), a1 = gmSimdisplat(t->a[1]), a2 = gmSimdisplat(t->a[2]);
+    simdi step0 = gmSimdisplat(t->a[0] * CGM_SIMD_WIDTH);
+    simdi step1 = gmSimdisplat(t->a[1] * CGM_SIMD_WIDTH);
+    simdi step2 = gmSimdisplat(t->a[2] * CGM_SIMD_WIDTH);
+    simdi x = gmSimdiadd(lane, gmSimdisplat(bx0));
+    simdi c0 = gmSimdiadd(gmSimdimul(a0, x), gmSimdisplat(t->c[0]));
+    simdi c1 = gmSimdiadd(gmSimdimul(a1, x), gmSimdisplat(t->c[1]));
+    simdi c2 = gmSimdiadd(gmSimdimul(a2, x), gmSimdisplat(t->c[2]));
+    simdi none = gmSimdisplat(-1), ids = gmSimdisplat((int32_t)id);
+    simdf zx = gmSimdsplat(t->zx), zstep = gmSimdsplat(t->zx * CGM_SIMD_WIDTH);
+    simdf zl = gmSimdfma(gmSimdadd(gmSimdload(fiota), gmSimdsplat((float)(bx0 - t->x0))), zx, gmSimdsplat(t->z));
+
+    for(int y = by0; y < by1; y++)
+    {
+        simdi e0 = gmSimdiadd(c0, gmSimdisplat(t->b[0] * y));
+        simdi e1 = gmSimdiadd(c1, gmSimdisplat(t->b[1] * y));
+        simdi e2 = gmSimdiadd(c2, gmSimdisplat(t->b[2] * y));
+        simdf z = gmSimdadd(zl, gmSimdsplat(t->zy * (float)(y - t->y0)));
+        float *depth = r->depth + (size_t)y * (size_t)r->width;
+        int32_t *cover = (int32_t *)r->coverage + (size_t)y * (size_t)r->width;
+
+        for(int bx = bx0; bx < bx1; bx += CGM_SIMD_WIDTH)
+        {
+            /* inside where no edge value is negative */
+            simdf in = gmSimdasf(gmSimdigt(gmSimdior(e0, gmSimdior(e1, e2)), none));
+
+            if(gmSimdmask(in))
+            {
+                int k = GMMIN(CGM_SIMD_WIDTH, r->width - bx);
+                float dt[CGM_SIMD_WIDTH];
+                int32_t ct[CGM_SIMD_WIDTH];
+                float *dp = depth + bx;
+                int32_t *cp = cover + bx;
+
+                /* the last block of a row may run past the target */
+                if(k < CGM_SIMD_WIDTH)
+                {
+                    for(int l = 0; l < CGM_SIMD_WIDTH; l++)
+                    {
+                        dt[l] = (l < k) ? dp[l] : 0.0f;
+                        ct[l] = (l < k) ? cp[l] : 0;
+                    }
+                    dp = dt;
+                    cp = ct;
+                }
+
+                simdf d = gmSimdload(dp);
+                simdf pass = gmSimdand(in, greater ? gmSimdlt(d, z) : gmSimdlt(z, d));
+                gmSimdstore(dp, gmSimdselect(pass, z, d));
+                gmSimdistore(cp, gmSimdasi(gmSimdselect(pass, gmSimdasf(ids), gmSimdasf(gmSimdiload(cp)))));
+
+                if(k < CGM_SIMD_WIDTH)
+                {
+                    memcpy(depth + bx, dt, (size_t)k * sizeof(float));
+                    memcpy(cover + bx, ct, (size_t)k * sizeof(int32_t));
+                }
+            }
+
+            e0 = gmSimdiadd(e0, step0);
+            e1 = gmSimdiadd(e1, step1);
+            e2 = gmSimdiadd(e2, step2);
+            z = gmSimdadd(z, zstep);
+        }
+    }
+}
+
+CGMINLINE void gmRasterTileTask(void *ctx, size_t b, size_t e, int thread)
+{
+    gmRasterJob *j = (gmRasterJob *)ctx;
+    gmRaster *r = j->r;
+    (void)thread;
+
+    for(size_t tile = b; tile < e; tile++)
+    {
+        int x0 = (int)(tile % (size_t)r->tilesX) * CGM_RASTER_TILE;
+        int y0 = (int)(tile / (size_t)r->tilesX) * CGM_RASTER_TILE;
+        int x1 = GMMIN(x0 + CGM_RASTER_TILE, r->width), y1 = GMMIN(y0 + CGM_RASTER_TILE, r->height);
+
+        for(uint32_t k = r->start[tile]; k < r->start[tile + 1]; k++)
+        {
+            gmRasterSpan(r, &r->tris[r->refs[k]], j->id, x0, y0, x1, y1);
+        }
+    }
+}
+
+/**
+ * @brief depth-tests and draws triangles into the target
+ *
+ * @param clip clip space vertices (`gmRasterTransform`)
+ * @param index 3 vertex indices per triangle, NULL for consecutive vertices
+ * @param count number of triangles
+ * @param id written to `coverage` where a triangle passes the depth test, not 0
+ * @param flags CGM_RASTER_CULL_BACK, CGM_RASTER_CULL_FRONT
+ */
+CGMINLINE void gmRasterTriangles(gmRaster *r, const vec4 *clip, const uint32_t *index, size_t count,
+                                 uint32_t id, int flags)
+{
+    gmRasterJob j = {r, clip, index, 0, id, flags};
+    size_t tiles = (size_t)r->tilesX * (size_t)r->tilesY;
+
+    while(j.first < count)
+    {
+        size_t n = GMMIN(r->batch, count - j.first);
+        gmParallelFor(n, CGM_RASTER_GRAIN, gmRasterSetupTask, &j);
+        n = gmRasterBin(r, &j, n);
+        gmParallelFor(tiles, 1, gmRasterTileTask, &j);
+        j.first += n;
+    }
+}
+
+/**
+ * @brief `gmRasterTransform` into `scratch` followed by `gmRasterTriangles`
+ *
+ * @param mvp projection * view * model
+ * @param scratch room for `vertices` clip space positions
+ */
+CGMINLINE void gmRasterMesh(gmRaster *r, mat4 mvp, const vec3 *p, size_t vertices, const uint32_t *index,
+                            size_t count, vec4 *scratch, uint32_t id, int flags)
+{
+    gmRasterTransformParallel(mvp, p, vertices, scratch);
+    gmRasterTriangles(r, scratch, index, count, id, flags);
+}
+
+#endif
@@ -1,20 +1,7 @@
 #include <stdio.h>
 #include <math.h>
 #include "../include/cgm/cgm.h"
-
-float gmHash(int x, int y) 
-{
-    int h = x * 374761393 + y * 668265263;
-    h = (h ^ (h >> 13)) * 1274126177;
-    return (h & 0x7fffffff) / 2147483647.0f;
-}
-
-float gmGrad(vec2 grid, vec2 offset) 
-{
-    float angle = gmHash((int)grid.x, (int)grid.y) * 6.2831853f;
-    vec2 g = gmVec2(cosf(angle), sinf(angle));
-    return gmVec2dot(g, offset);
-}
+#include "../include/cgm/ngm/noise.h"
 
 float perlin2d(vec2 coord) 
 {